@@ -0,0 +1,275 @@
+/* Stapelbetrieb
+ *
+ * Eingabe: Instanzen im ueblichen Format, getrennt durch Leerzeilen.
+ * Ausgabe: je Instanz "None" oder ihre Dominos, danach eine Leerzeile, in
+ * derselben Reihenfolge wie die Eingabe.
+ *
+ * Der aufrufende Thread liest die Instanzen in einen Ring von Plaetzen,
+ * die Worker loesen sie mit je einem eigenen Kontext (dessen Puffer ueber
+ * alle Instanzen erhalten bleiben) und schreiben das Ergebnis in den
+ * Ausgabepuffer des Platzes. Wer einen Platz fertigstellt, gibt alle
+ * fertigen Plaetze in Reihenfolge aus. Auch Punkt- und Ausgabepuffer der
+ * Plaetze werden wiederverwendet.
+ *
+ * Ein Fehler (Eingabe oder Loesen) beendet den Stapel; alle Instanzen davor
+ * werden noch ausgegeben.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "loesung.h"
+
+#define BATCH_SLOTS 4       // Plaetze je Worker
+
+typedef enum slotState_e{
+    SLOT_FREE,
+    SLOT_READY,
+    SLOT_BUSY,
+    SLOT_DONE
+} slotState_t;
+
+typedef struct slot_s{
+    point_t * points;
+    size_t amount;
+    size_t cap;
+
+    char * out;
+    size_t len;
+    size_t capOut;
+
+    slotState_t state;
+    tilingErr_t error;
+    union errData_u errData;
+} slot_t;
+
+typedef struct batch_s{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+
+    slot_t * slots;
+    size_t amountSlots;
+    size_t produced;        // Instanzen im Ring
+    size_t taken;           // naechste zu loesende Instanz
+    size_t printed;         // naechste auszugebende Instanz
+    int finished;           // keine weiteren Instanzen
+    int failed;
+    int printing;
+
+    tilingErr_t error;      // erster Fehler in Ausgabereihenfolge
+    union errData_u errData;
+    FILE * out;
+} batch_t;
+
+/* Instanz loesen und als Text in den Ausgabepuffer des Platzes schreiben
+ */
+static void solveSlot(tiling_t * ctx, slot_t * slot)
+{
+    slot->len = 0;
+    slot->error = TILING_OK;
+
+    int result = -1;
+    if (!tilingLoadPoints(ctx, slot->points, slot->amount)) { result = tilingSolve(ctx); }
+    if (result < 0
+        || formatResult(ctx, result, &slot->out, &slot->len, &slot->capOut)
+        || appendBytes(&slot->out, &slot->len, &slot->capOut, "\n", 1))
+    {
+        slot->error = result < 0 ? ctx->error : TILING_EXCEED_MEM;
+        slot->errData = ctx->errData;
+    }
+    return;
+}
+
+/* Fertige Plaetze in Reihenfolge ausgeben (mit gehaltener Sperre aufrufen)
+ *
+ * Nur ein Thread gibt gleichzeitig aus, geschrieben wird ohne Sperre.
+ */
+static void flush(batch_t * b)
+{
+    if (b->printing) { return; }
+    b->printing = 1;
+    while (!b->failed && b->printed < b->produced)
+    {
+        slot_t * slot = &b->slots[b->printed % b->amountSlots];
+        if (slot->state != SLOT_DONE) { break; }
+        if (slot->error)
+        {
+            b->failed = 1;
+            b->error = slot->error;
+            b->errData = slot->errData;
+            break;
+        }
+
+        pthread_mutex_unlock(&b->lock);
+        fwrite(slot->out, 1, slot->len, b->out);
+        pthread_mutex_lock(&b->lock);
+
+        slot->state = SLOT_FREE;
+        b->printed++;
+        pthread_cond_broadcast(&b->changed);
+    }
+    b->printing = 0;
+    pthread_cond_broadcast(&b->changed);
+}
+
+static void * worker(void * arg)
+{
+    batch_t * b = (batch_t *) arg;
+    tiling_t * ctx = tilingCreate();
+
+    pthread_mutex_lock(&b->lock);
+    while (1)
+    {
+        while (b->taken == b->produced && !b->finished && !b->failed)
+        {
+            pthread_cond_wait(&b->changed, &b->lock);
+        }
+        if (b->failed || b->taken == b->produced) { break; }
+
+        slot_t * slot = &b->slots[b->taken % b->amountSlots];
+        b->taken++;
+        slot->state = SLOT_BUSY;
+        pthread_mutex_unlock(&b->lock);
+
+        if (ctx)
+        {
+            solveSlot(ctx, slot);
+        } else {
+            slot->error = TILING_EXCEED_MEM;
+        }
+
+        pthread_mutex_lock(&b->lock);
+        slot->state = SLOT_DONE;
+        flush(b);
+    }
+    pthread_cond_broadcast(&b->changed);
+    pthread_mutex_unlock(&b->lock);
+
+    tilingFree(ctx);
+    return NULL;
+}
+
+/* Zeilen bis zur naechsten Leerzeile oder zum Ende lesen
+ *
+ * 1: Instanz gelesen, 0: Ende der Eingabe, -1: Fehler
+ */
+static int readInstance(tiling_t * ctx, input_t * input, slot_t * slot)
+{
+    slot->amount = 0;
+    int any = 0;
+    while (1)
+    {
+        int blank = readBlank(input);
+        if (blank == EOF) { return any; }
+        if (blank) { return 1; }
+
+        point_t p;
+        if (readLine(ctx, input, &p) < 0) { return -1; }
+        if (slot->amount == slot->cap)
+        {
+            size_t cap = slot->cap ? slot->cap * 2 : 64;
+            point_t * temp = (point_t *) realloc(slot->points, cap * sizeof(point_t));
+            if (!temp)
+            {
+                ctx->error = TILING_EXCEED_MEM;
+                return -1;
+            }
+            slot->points = temp;
+            slot->cap = cap;
+        }
+        slot->points[slot->amount++] = p;
+        any = 1;
+    }
+}
+
+void tilingBatch(tiling_t * ctx, FILE * in, unsigned int threads, int stats)
+{
+    if (!threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned int) online : 1;
+    }
+
+    batch_t b;
+    memset(&b, 0, sizeof(b));
+    b.out = stdout;
+    b.amountSlots = (size_t) threads * BATCH_SLOTS;
+    b.slots = (slot_t *) calloc(b.amountSlots, sizeof(slot_t));
+    pthread_t * ids = (pthread_t *) calloc(threads, sizeof(pthread_t));
+    if (!b.slots || !ids)
+    {
+        free(b.slots);
+        free(ids);
+        ctx->error = TILING_EXCEED_MEM;
+        return;
+    }
+    pthread_mutex_init(&b.lock, NULL);
+    pthread_cond_init(&b.changed, NULL);
+
+    unsigned int started = 0;
+    while (started < threads && !pthread_create(&ids[started], NULL, worker, &b)) { started++; }
+
+    input_t input;
+    input.in = in;
+    input.line = 0;
+    input.offset = 0;
+
+    if (!started)
+    {
+        ctx->error = TILING_EXCEED_MEM;
+    }
+    while (started)
+    {
+        pthread_mutex_lock(&b.lock);
+        slot_t * slot = &b.slots[b.produced % b.amountSlots];
+        while (slot->state != SLOT_FREE && !b.failed)
+        {
+            pthread_cond_wait(&b.changed, &b.lock);
+        }
+        int failed = b.failed;
+        pthread_mutex_unlock(&b.lock);
+        if (failed) { break; }
+
+        // der Platz ist frei und gehoert bis SLOT_READY dem Leser
+        int status = readInstance(ctx, &input, slot);
+        if (status <= 0) { break; }
+
+        pthread_mutex_lock(&b.lock);
+        slot->state = SLOT_READY;
+        b.produced++;
+        pthread_cond_broadcast(&b.changed);
+        pthread_mutex_unlock(&b.lock);
+    }
+
+    pthread_mutex_lock(&b.lock);
+    b.finished = 1;
+    pthread_cond_broadcast(&b.changed);
+    pthread_mutex_unlock(&b.lock);
+    for (unsigned int t = 0; t < started; t++) { pthread_join(ids[t], NULL); }
+
+    // Fehler beim Loesen kommt vor einem spaeteren Lesefehler
+    if (b.failed)
+    {
+        ctx->error = b.error;
+        ctx->errData = b.errData;
+    }
+    if (stats)
+    {
+        fprintf(stderr, "batch: %zu instances, %zu printed, %u workers\n", b.produced, b.printed, started);
+    }
+
+    for (size_t i = 0; i < b.amountSlots; i++)
+    {
+        free(b.slots[i].points);
+        free(b.slots[i].out);
+    }
+    free(b.slots);
+    free(ids);
+    pthread_cond_destroy(&b.changed);
+    pthread_mutex_destroy(&b.lock);
+    return;
+}
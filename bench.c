@@ -0,0 +1,246 @@
+/* bench: Zeiten der einzelnen Phasen auf festen Daten
+ *
+ *     bench [--input FILE | --family square|strip|holes --size N]
+ *           [--warmup W] [--repeat R] [--seed S] [--threads T]
+ *           [--compare FILE]
+ *
+ * Die Eingabe liegt vorher vollstaendig im Speicher, entweder aus FILE oder
+ * erzeugt aus den Familien in instances.c (Standard: Quadrat mit 2^20 Kacheln, gemischt
+ * mit Seed 1). Jeder Lauf geht durch tilingLoadBuffer(), sortTiles(),
+ * linkTiles(), findCoverage() und printResult() nach /dev/null, jede Phase
+ * wird einzeln gemessen. Die ersten W Laeufe (Standard 2) waermen Cache und
+ * Speicherverwaltung auf und zaehlen nicht, danach R Laeufe (Standard 15).
+ *
+ * Ausgabe auf stdout, je Phase eine Zeile mit Median, 10. und 90. Perzentil
+ * sowie Minimum in Sekunden; die Kopfzeile haelt Daten und Einstellungen
+ * fest. Mit --compare wird eine fruehere Ausgabe gelesen und je Phase die
+ * Aenderung des Medians angehaengt, etwa
+ *
+ *     ./bench > before.txt; (Aenderung); ./bench --compare before.txt
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "loesung.h"
+#include "instances.h"
+
+typedef enum stage_e{
+    STAGE_PARSE = 0,
+    STAGE_SORT,
+    STAGE_LINK,
+    STAGE_MATCH,
+    STAGE_PRINT,
+    STAGES
+} stage_t;
+
+static const char * const stageNames[STAGES] = { "parse", "sort", "link", "match", "print" };
+
+/* Familie nach Kachelzahl als Text
+ */
+static char * makeText(family_t family, size_t n, random_t * rng, size_t * len)
+{
+    point_t * points = (point_t *) malloc((n ? n : 1) * sizeof(point_t));
+    if (!points) { return NULL; }
+    size_t amount = makeFamily(points, family, n, rng);
+    char * text = pointsText(points, amount, len);
+    free(points);
+    return text;
+}
+
+static char * readFile(const char * path, size_t * len)
+{
+    FILE * in = fopen(path, "rb");
+    if (!in) { return NULL; }
+    size_t cap = 1 << 16;
+    size_t used = 0;
+    char * text = (char *) malloc(cap);
+    while (text)
+    {
+        used += fread(text + used, 1, cap - used, in);
+        if (used < cap) { break; }
+        char * bigger = (char *) realloc(text, cap * 2);
+        if (!bigger)
+        {
+            free(text);
+            text = NULL;
+            break;
+        }
+        text = bigger;
+        cap *= 2;
+    }
+    if (text && ferror(in))
+    {
+        free(text);
+        text = NULL;
+    }
+    fclose(in);
+    *len = used;
+    return text;
+}
+
+/* Ein Lauf durch alle Phasen, Rueckgabe wie findCoverage()
+ */
+static int runOnce(tiling_t * ctx, const char * text, size_t len, unsigned int threads, FILE * sink, double * seconds)
+{
+    double t0 = wallClock();
+    if (tilingLoadBuffer(ctx, text, len, threads)) { return -1; }
+    double t1 = wallClock();
+    if (sortTiles(ctx)) { return -1; }
+    double t2 = wallClock();
+    linkTiles(&ctx->allTiles);
+    double t3 = wallClock();
+    int result = findCoverage(ctx);
+    if (result < 0) { return -1; }
+    double t4 = wallClock();
+    ctx->tileable = !result;
+    tilingRewind(ctx);
+    printResult(ctx, sink);
+    fflush(sink);
+    double t5 = wallClock();
+    seconds[STAGE_PARSE] = t1 - t0;
+    seconds[STAGE_SORT] = t2 - t1;
+    seconds[STAGE_LINK] = t3 - t2;
+    seconds[STAGE_MATCH] = t4 - t3;
+    seconds[STAGE_PRINT] = t5 - t4;
+    return result;
+}
+
+static int compareDouble(const void * a, const void * b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/* Perzentil nach naechstem Rang, samples sortiert
+ */
+static double percentile(const double * samples, int amount, int p)
+{
+    int rank = (p * amount + 99) / 100;
+    if (rank < 1) { rank = 1; }
+    return samples[rank - 1];
+}
+
+/* Mediane einer frueheren Ausgabe, fehlende Phasen bleiben 0
+ */
+static int readBaseline(const char * path, double * median)
+{
+    FILE * in = fopen(path, "r");
+    if (!in) { return -1; }
+    char line[256];
+    while (fgets(line, sizeof(line), in))
+    {
+        char name[32];
+        double value;
+        if (sscanf(line, "%31s %lf", name, &value) != 2) { continue; }
+        for (int s = 0; s < STAGES; s++)
+        {
+            if (!strcmp(name, stageNames[s])) { median[s] = value; }
+        }
+    }
+    fclose(in);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char * input = NULL;
+    const char * baseline = NULL;
+    family_t family = FAMILY_SQUARE;
+    size_t size = (size_t) 1 << 20;
+    int warmup = 2;
+    int repeat = 15;
+    unsigned long long seed = 1;
+    unsigned int threads = 1;
+    for (int a = 1; a < argc; a++)
+    {
+        if (!strcmp(argv[a], "--input") && a+1 < argc) { input = argv[++a]; continue; }
+        if (!strcmp(argv[a], "--compare") && a+1 < argc) { baseline = argv[++a]; continue; }
+        if (!strcmp(argv[a], "--size") && a+1 < argc) { size = strtoull(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--warmup") && a+1 < argc) { warmup = atoi(argv[++a]); continue; }
+        if (!strcmp(argv[a], "--repeat") && a+1 < argc) { repeat = atoi(argv[++a]); continue; }
+        if (!strcmp(argv[a], "--seed") && a+1 < argc) { seed = strtoull(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--threads") && a+1 < argc) { threads = (unsigned int) strtoul(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--family") && a+1 < argc && !familyByName(argv[a+1], &family) && family < FAMILY_SCALING)
+        {
+            a++;
+            continue;
+        }
+        fprintf(stderr, "Unknown or incomplete option '%s'!\n", argv[a]);
+        return 2;
+    }
+    if (warmup < 0) { warmup = 0; }
+    if (repeat < 1) { repeat = 1; }
+    if (threads < 1) { threads = 1; }
+    random_t rng;
+    randomSeed(&rng, seed);
+
+    int status = 2;
+    double before[STAGES] = { 0.0 };
+    double * samples[STAGES] = { NULL };
+    tiling_t * ctx = NULL;
+    FILE * sink = NULL;
+    size_t len = 0;
+    char * text = input ? readFile(input, &len) : makeText(family, size, &rng, &len);
+    if (!text)
+    {
+        fprintf(stderr, input ? "Cannot open '%s'!\n" : "Not enough memory available!\n", input);
+        goto err0;
+    }
+    if (baseline && readBaseline(baseline, before))
+    {
+        fprintf(stderr, "Cannot open '%s'!\n", baseline);
+        goto err0;
+    }
+    ctx = tilingCreate();
+    sink = fopen("/dev/null", "w");
+    int missing = !ctx || !sink;
+    for (int s = 0; s < STAGES; s++)
+    {
+        samples[s] = (double *) malloc((size_t) repeat * sizeof(double));
+        missing |= !samples[s];
+    }
+    if (missing)
+    {
+        fprintf(stderr, "Not enough memory available!\n");
+        goto err0;
+    }
+
+    int result = 0;
+    for (int r = -warmup; r < repeat; r++)
+    {
+        double seconds[STAGES];
+        result = runOnce(ctx, text, len, threads, sink, seconds);
+        if (result < 0)
+        {
+            tilingPrintError(ctx, stderr);
+            goto err0;
+        }
+        if (r < 0) { continue; }
+        for (int s = 0; s < STAGES; s++) { samples[s][r] = seconds[s]; }
+    }
+
+    if (input) { printf("# bench input=%s", input); }
+    else { printf("# bench family=%s size=%zu seed=%llu", familyNames[family], size, seed); }
+    printf(" tiles=%zu result=%s warmup=%d repeat=%d threads=%u\n",
+           ctx->allTiles.amount, result ? "None" : "tiling", warmup, repeat, threads);
+    printf("%-6s %10s %10s %10s %10s%s\n", "stage", "median", "p10", "p90", "min", baseline ? "   change" : "");
+    for (int s = 0; s < STAGES; s++)
+    {
+        qsort(samples[s], (size_t) repeat, sizeof(double), compareDouble);
+        double median = repeat % 2 ? samples[s][repeat / 2] : (samples[s][repeat / 2 - 1] + samples[s][repeat / 2]) / 2.0;
+        printf("%-6s %10.6f %10.6f %10.6f %10.6f", stageNames[s], median,
+               percentile(samples[s], repeat, 10), percentile(samples[s], repeat, 90), samples[s][0]);
+        if (baseline && before[s] > 0.0) { printf(" %+7.1f %%", (median / before[s] - 1.0) * 100.0); }
+        printf("\n");
+    }
+    status = 0;
+
+err0:
+    for (int s = 0; s < STAGES; s++) { free(samples[s]); }
+    if (sink) { fclose(sink); }
+    tilingFree(ctx);
+    free(text);
+    return status;
+}
@@ -0,0 +1,190 @@
+/* Ergebnis-Cache auf der Platte (--cache VERZ)
+ *
+ * Schluessel ist ein 64-Bit-Hash ueber die sortierte Kachelliste (doppelte
+ * Kacheln hat sort() schon abgewiesen), berechnet direkt nach sort(). Die
+ * Datei VERZ/<hash>-<anzahl> enthaelt einen Kopf und danach je Kachel in
+ * sortierter Reihenfolge den Abstand zum Partner als uint32_t, falls der
+ * Partner weiter hinten liegt, sonst 0. "None" hat keinen Rumpf.
+ *
+ * Bei einem Treffer wird die Datei per mmap eingeblendet und die Zuordnung
+ * direkt gesetzt; linkTiles() und findCoverage() entfallen. Immer geprueft
+ * werden die billigen Invarianten: Laenge der Datei, Anzahl der Kacheln,
+ * jede Kachel genau einmal belegt und die Pruefsumme ueber den Rumpf im
+ * Kopf; eine abgeschnittene oder beschaedigte Datei ist ein Fehlschlag.
+ * Mit Pruefung (--cache-verify) muss zusaetzlich jedes Domino aus zwei
+ * benachbarten Kacheln bestehen, so faellt auch eine falsche Datei (etwa
+ * bei einer Hash-Kollision) auf. "None" laesst sich so nicht pruefen und
+ * wird mit Pruefung neu geloest.
+ *
+ * Der Cache ist nur eine Abkuerzung: kann eine Datei nicht gelesen oder
+ * geschrieben werden, wird normal geloest. Geschrieben wird ueber eine
+ * temporaere Datei und rename(), so dass parallele Prozesse nie halbe
+ * Eintraege sehen.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "loesung.h"
+
+#define CACHE_MAGIC 0x32434f44u     // "DOC2", mit Pruefsumme
+#define CACHE_PATH 4096
+
+typedef struct cacheHead_s{
+    uint32_t magic;
+    uint32_t none;          // 1: keine Parkettierung
+    uint64_t key;
+    uint64_t amount;
+    uint64_t check;         // Pruefsumme ueber den Rumpf (bodyCheck())
+} cacheHead_t;
+
+static uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t cacheKey(const allTiles_t * allTiles)
+{
+    uint64_t h = mix(allTiles->amount);
+    for (size_t i = 0; i < allTiles->amount; i++)
+    {
+        point_t p = allTiles->tiles[i].p;
+        h = mix(h ^ ((uint64_t) p.x << 32 | p.y)) + i;
+    }
+    return h;
+}
+
+static uint64_t bodyCheck(uint64_t h, uint32_t delta)
+{
+    return mix(h ^ delta);
+}
+
+static int cachePath(const tiling_t * ctx, char * path)
+{
+    int len = snprintf(path, CACHE_PATH, "%s/%016llx-%zu", ctx->cacheDir,
+                       (unsigned long long) ctx->cacheKey, ctx->allTiles.amount);
+    return len > 0 && len < CACHE_PATH ? 0 : -1;
+}
+
+/* Zuordnung aus dem Cache setzen
+ *
+ * 0: Parkettierung gesetzt, 1: "None", -1: kein (gueltiger) Eintrag
+ */
+int cacheLookup(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    ctx->cacheKey = (unsigned long long) cacheKey(allTiles);
+
+    char path[CACHE_PATH];
+    if (cachePath(ctx, path)) { return -1; }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { return -1; }
+
+    int result = -1;
+    struct stat st;
+    if (fstat(fd, &st) || (size_t) st.st_size < sizeof(cacheHead_t)) { goto err0; }
+    size_t bytes = (size_t) st.st_size;
+    void * map = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) { goto err0; }
+
+    const cacheHead_t * head = (const cacheHead_t *) map;
+    const uint32_t * delta = (const uint32_t *) (head + 1);
+    if (head->magic != CACHE_MAGIC || head->key != ctx->cacheKey || head->amount != allTiles->amount) { goto err1; }
+    if (head->none)
+    {
+        if (bytes == sizeof(cacheHead_t) && head->check == mix(0) && !ctx->cacheVerify) { result = 1; }
+        goto err1;
+    }
+    if (bytes != sizeof(cacheHead_t) + allTiles->amount * sizeof(uint32_t)) { goto err1; }
+
+    // Partner im Feld, keine Kachel doppelt, Pruefsumme; Nachbarn nur mit Pruefung
+    tile_t * tiles = allTiles->tiles;
+    uint64_t check = mix(0);
+    size_t dominoes = 0;
+    for (size_t i = 0; i < allTiles->amount; i++)
+    {
+        check = bodyCheck(check, delta[i]);
+        if (!delta[i]) { continue; }
+        if (delta[i] >= allTiles->amount - i) { goto undo; }
+        if (tiles[i].edge || tiles[i + delta[i]].edge) { goto undo; }
+        if (ctx->cacheVerify)
+        {
+            point_t a = tiles[i].p;
+            point_t b = tiles[i + delta[i]].p;
+            if (!((a.x == b.x && a.y + 1 == b.y) || (a.x + 1 == b.x && a.y == b.y))) { goto undo; }
+        }
+        tiles[i].edge = &tiles[i + delta[i]];
+        tiles[i + delta[i]].edge = &tiles[i];
+        dominoes++;
+    }
+    if (2 * dominoes != allTiles->amount || check != head->check) { goto undo; }
+    result = 0;
+    goto err1;
+
+undo:
+    for (size_t i = 0; i < allTiles->amount; i++) { tiles[i].edge = NULL; }
+err1:
+    munmap(map, bytes);
+err0:
+    close(fd);
+    return result;
+}
+
+/* Ergebnis von findCoverage() ablegen (Fehler werden ignoriert)
+ */
+void cacheStore(tiling_t * ctx, int result)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    char path[CACHE_PATH];
+    char temp[CACHE_PATH + 8];
+    if (cachePath(ctx, path)) { return; }
+    snprintf(temp, sizeof(temp), "%s.XXXXXX", path);
+    int fd = mkstemp(temp);
+    if (fd < 0) { return; }
+    FILE * f = fdopen(fd, "wb");
+    if (!f)
+    {
+        close(fd);
+        goto err0;
+    }
+
+    cacheHead_t head;
+    memset(&head, 0, sizeof(head));
+    head.magic = CACHE_MAGIC;
+    head.none = (uint32_t) (result != 0);
+    head.key = (uint64_t) ctx->cacheKey;
+    head.amount = allTiles->amount;
+    head.check = mix(0);
+    int failed = fwrite(&head, sizeof(head), 1, f) != 1;
+
+    tile_t * tiles = allTiles->tiles;
+    for (size_t i = 0; !result && !failed && i < allTiles->amount; i++)
+    {
+        size_t partner = (size_t) (tiles[i].edge - tiles);
+        uint32_t delta = partner > i ? (uint32_t) (partner - i) : 0;
+        if (partner > i && partner - i > UINT32_MAX) { failed = 1; }
+        failed |= fwrite(&delta, sizeof(delta), 1, f) != 1;
+        head.check = bodyCheck(head.check, delta);
+    }
+    // Pruefsumme erst nach dem Rumpf bekannt
+    failed |= fseek(f, 0, SEEK_SET) || fwrite(&head, sizeof(head), 1, f) != 1;
+    if (fclose(f) || failed) { goto err0; }
+    chmod(temp, 0644);
+    if (!rename(temp, path)) { return; }
+
+err0:
+    unlink(temp);
+    return;
+}
@@ -0,0 +1,674 @@
+/* check_result: Ausgabe von loesung pruefen
+ *
+ *     loesung < eingabe | check_result [--input EINGABE] [--threads N] [REFERENZ]
+ *
+ * Die Kachelmenge kommt aus der Eingabe (--input, gelesen mit dem Parser von
+ * libtiling, also auch gzip/zstd) oder aus einer Referenzausgabe wie
+ * test_cases/exampleNN.out, deren Dominos genau die Kacheln der Eingabe
+ * belegen. Geprueft wird die Ausgabe auf stdin: jede Zeile "x y;x y" mit
+ * benachbarten Kacheln, jede Kachel genau einmal, keine fremden Kacheln.
+ *
+ * Der schnelle Weg ist linear und parallel: beide Texte werden (per mmap,
+ * sonst ganz gelesen) in Stuecken an Zeilengrenzen zerlegt, die Kacheln als
+ * 64-Bit-Schluessel (x << 32 | y) mit LSD-Radixsort sortiert, wobei Bytes
+ * ohne Unterschied uebersprungen werden, und dann Platz fuer Platz
+ * verglichen. Erst wenn dabei etwas nicht stimmt, sucht ein sequentieller
+ * Durchlauf den ersten Fehler in Zeilenreihenfolge fuer die Meldung.
+ *
+ * "None" ist richtig, wenn auch die Referenz "None" ist; mit --input wird
+ * es ueber Paritaet bzw. den Loeser bestaetigt. Ist die Referenz weder
+ * Parkettierung noch "None" (etwa eine erwartete Fehlermeldung), muss die
+ * Ausgabe ihr Byte fuer Byte gleichen.
+ *
+ * Rueckgabe 0: richtig ("OK n dominoes" auf stdout), 1: falsch (erster
+ * Fehler auf stderr), 2: Aufruf, Eingabe oder Speicher.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "loesung.h"
+
+#define CHECK_MIN_SLICE (1 << 20)
+#define CHECK_THREADS 256
+#define CHECK_READ (1 << 20)
+
+typedef struct text_s{
+    const char * text;
+    size_t len;
+    void * map;             // eingeblendet, sonst gelesen
+    size_t mapBytes;
+} text_t;
+
+typedef struct job_s{
+    const char * begin;     // Textstueck, endet hinter '\n' oder am Ende
+    const char * end;
+    size_t lines;
+    size_t offset;          // erste Zeile des Stuecks
+
+    uint64_t * keys;        // Sortieren und Vergleich: [from, to)
+    uint64_t * temp;
+    const uint64_t * other;
+    size_t from;
+    size_t to;
+    unsigned int shift;
+    size_t count[256];
+    uint64_t diff;          // Bits, in denen sich Schluessel unterscheiden
+
+    int bad;
+} job_t;
+
+static uint64_t key(unsigned long x, unsigned long y)
+{
+    return (uint64_t) x << 32 | (uint64_t) y;
+}
+
+static void runJobs(job_t * jobs, unsigned int amount, void * (*work)(void *))
+{
+    pthread_t ids[CHECK_THREADS];
+    int started[CHECK_THREADS];
+    for (unsigned int t = 1; t < amount; t++)
+    {
+        started[t] = !pthread_create(&ids[t], NULL, work, &jobs[t]);
+        if (!started[t]) { work(&jobs[t]); }
+    }
+    work(&jobs[0]);
+    for (unsigned int t = 1; t < amount; t++)
+    {
+        if (started[t]) { pthread_join(ids[t], NULL); }
+    }
+}
+
+/* Datei einblenden oder (Pipe) ganz lesen
+ */
+static int readText(FILE * in, text_t * t)
+{
+    memset(t, 0, sizeof(*t));
+    struct stat st;
+    int fd = fileno(in);
+    if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void * map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            posix_madvise(map, (size_t) st.st_size, POSIX_MADV_SEQUENTIAL);
+            t->map = map;
+            t->mapBytes = (size_t) st.st_size;
+            t->text = (const char *) map;
+            t->len = t->mapBytes;
+            return 0;
+        }
+    }
+
+    char * text = NULL;
+    size_t cap = 0;
+    while (1)
+    {
+        if (cap - t->len < CHECK_READ)
+        {
+            size_t grow = cap ? cap * 2 : 4 * CHECK_READ;
+            char * temp = (char *) realloc(text, grow);
+            if (!temp)
+            {
+                free(text);
+                return -1;
+            }
+            text = temp;
+            cap = grow;
+        }
+        size_t got = fread(text + t->len, 1, cap - t->len, in);
+        t->len += got;
+        if (!got) { break; }
+    }
+    t->text = text;
+    return 0;
+}
+
+static void freeText(text_t * t)
+{
+    if (t->map)
+    {
+        munmap(t->map, t->mapBytes);
+    } else {
+        free((char *) t->text);
+    }
+}
+
+static int isNone(const text_t * t)
+{
+    return (t->len == 4 || (t->len == 5 && t->text[4] == '\n')) && !memcmp(t->text, "None", 4);
+}
+
+/* Zahl < 2^32 ab *p, danach steht *p dahinter
+ */
+static int number(const char ** p, const char * end, unsigned long * v)
+{
+    if (*p == end || **p < '0' || **p > '9') { return -1; }
+    *v = 0;
+    do
+    {
+        *v = *v * 10 + (unsigned long) (**p - '0');
+        if (*v >= 4294967296) { return -1; }
+        (*p)++;
+    } while (*p < end && **p >= '0' && **p <= '9');
+    return 0;
+}
+
+static int expect(const char ** p, const char * end, char c)
+{
+    if (*p == end || **p != c) { return -1; }
+    (*p)++;
+    return 0;
+}
+
+/* Eine Zeile "x y;x y" wie printResult()
+ *
+ * 1: gelesen, 0: Ende des Textes, -1: falsches Format (Rest der Zeile
+ * uebersprungen); adjacent sagt, ob die Kacheln benachbart sind
+ */
+static int dominoLine(const char ** p, const char * end, uint64_t * a, uint64_t * b, int * adjacent)
+{
+    if (*p == end) { return 0; }
+    unsigned long v[4];
+    if (number(p, end, &v[0]) || expect(p, end, ' ') || number(p, end, &v[1]) || expect(p, end, ';')
+        || number(p, end, &v[2]) || expect(p, end, ' ') || number(p, end, &v[3]))
+    {
+        goto err;
+    }
+    if (*p < end && **p == '\r') { (*p)++; }
+    if (*p < end && expect(p, end, '\n')) { goto err; }
+
+    *a = key(v[0], v[1]);
+    *b = key(v[2], v[3]);
+    unsigned long dx = v[0] > v[2] ? v[0] - v[2] : v[2] - v[0];
+    unsigned long dy = v[1] > v[3] ? v[1] - v[3] : v[3] - v[1];
+    *adjacent = dx + dy == 1;
+    return 1;
+
+err:
+    {
+        const char * newline = memchr(*p, '\n', (size_t) (end - *p));
+        *p = newline ? newline + 1 : end;
+    }
+    return -1;
+}
+
+static void * countLines(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    const char * p = job->begin;
+    job->lines = 0;
+    while (p < job->end)
+    {
+        const char * newline = memchr(p, '\n', (size_t) (job->end - p));
+        p = newline ? newline + 1 : job->end;
+        job->lines++;
+    }
+    return NULL;
+}
+
+static void * parseLines(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    const char * p = job->begin;
+    uint64_t * keys = job->keys + 2 * job->offset;
+    int adjacent;
+    int status;
+    while ((status = dominoLine(&p, job->end, &keys[0], &keys[1], &adjacent)))
+    {
+        if (status < 0 || !adjacent)
+        {
+            job->bad = 1;
+            return NULL;
+        }
+        keys += 2;
+    }
+    return NULL;
+}
+
+/* Text in Stuecken parallel in 2 Schluessel je Zeile zerlegen
+ *
+ * 0: alle Zeilen richtig, 1: Format- oder Nachbarschaftsfehler (wird
+ * sequentiell gesucht), -1: Speicher
+ */
+static int parseDominoes(const text_t * t, unsigned int threads, uint64_t ** keys, size_t * amount)
+{
+    *keys = NULL;
+    *amount = 0;
+    if (threads > t->len / CHECK_MIN_SLICE) { threads = (unsigned int) (t->len / CHECK_MIN_SLICE); }
+    if (threads < 1) { threads = 1; }
+
+    job_t * jobs = (job_t *) calloc(threads, sizeof(job_t));
+    if (!jobs) { return -1; }
+    const char * end = t->text + t->len;
+    const char * begin = t->text;
+    unsigned int used = 0;
+    for (unsigned int j = 0; j < threads && begin < end; j++)
+    {
+        const char * cut = j + 1 == threads ? end : t->text + t->len / threads * (j + 1);
+        if (cut < begin) { cut = begin; }
+        const char * newline = cut < end ? memchr(cut, '\n', (size_t) (end - cut)) : NULL;
+        jobs[used].begin = begin;
+        jobs[used].end = newline ? newline + 1 : end;
+        begin = jobs[used].end;
+        used++;
+    }
+    int status = 0;
+    if (used) { runJobs(jobs, used, countLines); }
+    size_t lines = 0;
+    for (unsigned int j = 0; j < used; j++)
+    {
+        jobs[j].offset = lines;
+        lines += jobs[j].lines;
+    }
+    *keys = (uint64_t *) malloc((lines ? 2 * lines : 1) * sizeof(uint64_t));   // leer: NULL waere Fehler
+    if (!*keys)
+    {
+        status = -1;
+        goto end;
+    }
+    for (unsigned int j = 0; j < used; j++) { jobs[j].keys = *keys; }
+    if (used) { runJobs(jobs, used, parseLines); }
+    *amount = 2 * lines;
+    for (unsigned int j = 0; j < used; j++) { status |= jobs[j].bad; }
+
+end:
+    free(jobs);
+    return status;
+}
+
+static void * diffKeys(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    uint64_t first = job->keys[0];
+    uint64_t diff = 0;
+    for (size_t i = job->from; i < job->to; i++) { diff |= job->keys[i] ^ first; }
+    job->diff = diff;
+    return NULL;
+}
+
+static void * countDigits(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    memset(job->count, 0, sizeof(job->count));
+    for (size_t i = job->from; i < job->to; i++) { job->count[(job->keys[i] >> job->shift) & 0xff]++; }
+    return NULL;
+}
+
+static void * scatterDigits(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    for (size_t i = job->from; i < job->to; i++)
+    {
+        uint64_t k = job->keys[i];
+        job->temp[job->count[(k >> job->shift) & 0xff]++] = k;
+    }
+    return NULL;
+}
+
+/* Bereiche [from, to) gleichmaessig auf die Jobs verteilen
+ */
+static unsigned int splitRange(job_t * jobs, unsigned int threads, size_t n)
+{
+    if (threads > n / CHECK_MIN_SLICE) { threads = (unsigned int) (n / CHECK_MIN_SLICE); }
+    if (threads < 1) { threads = 1; }
+    for (unsigned int j = 0; j < threads; j++)
+    {
+        jobs[j].from = n / threads * j;
+        jobs[j].to = j + 1 == threads ? n : n / threads * (j + 1);
+    }
+    return threads;
+}
+
+/* Paralleler LSD-Radixsort, Bytes ohne Unterschied werden uebersprungen
+ *
+ * Ergebnis liegt in keys oder temp, zurueckgegeben wird der Zeiger darauf.
+ */
+static uint64_t * sortKeys(uint64_t * keys, uint64_t * temp, size_t n, unsigned int threads)
+{
+    if (n < 2) { return keys; }
+    job_t * jobs = (job_t *) calloc(threads, sizeof(job_t));
+    if (!jobs) { return NULL; }
+    unsigned int used = splitRange(jobs, threads, n);
+
+    for (unsigned int j = 0; j < used; j++) { jobs[j].keys = keys; }
+    runJobs(jobs, used, diffKeys);
+    uint64_t diff = 0;
+    for (unsigned int j = 0; j < used; j++) { diff |= jobs[j].diff; }
+
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        if (!((diff >> shift) & 0xff)) { continue; }
+        for (unsigned int j = 0; j < used; j++)
+        {
+            jobs[j].keys = keys;
+            jobs[j].temp = temp;
+            jobs[j].shift = shift;
+        }
+        runJobs(jobs, used, countDigits);
+
+        // Platz je (Byte, Job): alle Jobs eines Bytes hintereinander, stabil
+        size_t sum = 0;
+        for (unsigned int b = 0; b < 256; b++)
+        {
+            for (unsigned int j = 0; j < used; j++)
+            {
+                size_t c = jobs[j].count[b];
+                jobs[j].count[b] = sum;
+                sum += c;
+            }
+        }
+        runJobs(jobs, used, scatterDigits);
+
+        uint64_t * swap = keys;
+        keys = temp;
+        temp = swap;
+    }
+    free(jobs);
+    return keys;
+}
+
+static void * compareKeys(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    job->bad = memcmp(job->keys + job->from, job->other + job->from, (job->to - job->from) * sizeof(uint64_t)) != 0;
+    return NULL;
+}
+
+/* Sortierte Schluessel gleich?
+ */
+static int sameKeys(const uint64_t * a, const uint64_t * b, size_t n, unsigned int threads)
+{
+    if (!n) { return 1; }
+    job_t * jobs = (job_t *) calloc(threads, sizeof(job_t));
+    if (!jobs) { return -1; }
+    unsigned int used = splitRange(jobs, threads, n);
+    for (unsigned int j = 0; j < used; j++)
+    {
+        jobs[j].keys = (uint64_t *) a;
+        jobs[j].other = b;
+    }
+    runJobs(jobs, used, compareKeys);
+    int same = 1;
+    for (unsigned int j = 0; j < used; j++) { same &= !jobs[j].bad; }
+    free(jobs);
+    return same;
+}
+
+/* Kacheln sortiert mit Position, -1 falls nicht enthalten
+ */
+static long long findTile(const uint64_t * tiles, size_t n, uint64_t k)
+{
+    size_t lo = 0;
+    size_t hi = n;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tiles[mid] < k) { lo = mid + 1; } else { hi = mid; }
+    }
+    return lo < n && tiles[lo] == k ? (long long) lo : -1;
+}
+
+/* Langsamer Weg: ersten Fehler in Zeilenreihenfolge melden
+ */
+static void reportFirst(const text_t * out, const uint64_t * tiles, size_t amount)
+{
+    unsigned char * seen = (unsigned char *) calloc(amount / 8 + 1, 1);
+    if (!seen)
+    {
+        fprintf(stderr, "Not enough memory available!\n");
+        return;
+    }
+    const char * p = out->text;
+    const char * end = out->text + out->len;
+    unsigned long line = 0;
+    uint64_t k[2];
+    int adjacent;
+    int status;
+    while ((status = dominoLine(&p, end, &k[0], &k[1], &adjacent)))
+    {
+        line++;
+        if (status < 0)
+        {
+            fprintf(stderr, "Line %lu: expected \"x y;x y\"!\n", line);
+            goto end;
+        }
+        if (!adjacent)
+        {
+            fprintf(stderr, "Line %lu: tiles %u %u and %u %u are not adjacent!\n", line,
+                    (unsigned int) (k[0] >> 32), (unsigned int) k[0], (unsigned int) (k[1] >> 32), (unsigned int) k[1]);
+            goto end;
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            long long at = findTile(tiles, amount, k[i]);
+            if (at < 0)
+            {
+                fprintf(stderr, "Line %lu: tile %u %u is not part of the input!\n", line,
+                        (unsigned int) (k[i] >> 32), (unsigned int) k[i]);
+                goto end;
+            }
+            if (seen[at / 8] & (1u << (at % 8)))
+            {
+                fprintf(stderr, "Line %lu: tile %u %u is covered twice!\n", line,
+                        (unsigned int) (k[i] >> 32), (unsigned int) k[i]);
+                goto end;
+            }
+            seen[at / 8] |= (unsigned char) (1u << (at % 8));
+        }
+    }
+
+    size_t missing = 0;
+    size_t first = 0;
+    for (size_t i = 0; i < amount; i++)
+    {
+        if (seen[i / 8] & (1u << (i % 8))) { continue; }
+        if (!missing) { first = i; }
+        missing++;
+    }
+    if (missing)
+    {
+        fprintf(stderr, "Tile %u %u is not covered (%zu tiles not covered)!\n",
+                (unsigned int) (tiles[first] >> 32), (unsigned int) tiles[first], missing);
+    }
+
+end:
+    free(seen);
+}
+
+/* Ausgabe muss der Referenz gleichen (erwartete Fehlermeldung o.ae.)
+ */
+static int compareLiteral(const text_t * out, const text_t * ref)
+{
+    size_t line = 1;
+    size_t i = 0;
+    while (i < out->len && i < ref->len && out->text[i] == ref->text[i])
+    {
+        if (out->text[i] == '\n') { line++; }
+        i++;
+    }
+    if (i == out->len && i == ref->len) { return 0; }
+    fprintf(stderr, "Line %zu: output differs from the reference!\n", line);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    const char * inputPath = NULL;
+    const char * refPath = NULL;
+    unsigned int threads = 0;
+    for (int a = 1; a < argc; a++)
+    {
+        if (!strcmp(argv[a], "--input") && a+1 < argc) { inputPath = argv[++a]; continue; }
+        if (!strcmp(argv[a], "--threads") && a+1 < argc)
+        {
+            threads = (unsigned int) strtoul(argv[++a], NULL, 10);
+            continue;
+        }
+        if (argv[a][0] != '-' && !refPath) { refPath = argv[a]; continue; }
+        fprintf(stderr, "Unknown or incomplete option '%s'!\n", argv[a]);
+        return 2;
+    }
+    if (!inputPath == !refPath)
+    {
+        fprintf(stderr, "Usage: %s [--input INPUT | REFERENCE] [--threads N] < output\n", argv[0]);
+        return 2;
+    }
+    if (!threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned int) online : 1;
+    }
+    if (threads > CHECK_THREADS) { threads = CHECK_THREADS; }
+
+    int status = 2;
+    tiling_t * ctx = NULL;
+    FILE * file = NULL;
+    text_t out;
+    text_t ref;
+    int haveRef = 0;
+    uint64_t * tiles = NULL;
+    size_t amount = 0;
+    uint64_t * keys = NULL;
+    size_t amountKeys = 0;
+    uint64_t * temp = NULL;
+
+    if (readText(stdin, &out)) { goto mem; }
+
+    /* Kachelmenge: Eingabe ueber libtiling oder Dominos der Referenz
+     */
+    file = fopen(inputPath ? inputPath : refPath, "r");
+    if (!file)
+    {
+        fprintf(stderr, "Cannot open '%s'!\n", inputPath ? inputPath : refPath);
+        goto err0;
+    }
+    if (inputPath)
+    {
+        if (!(ctx = tilingCreate())) { goto mem; }
+        if (tilingLoadParallel(ctx, file, threads))
+        {
+            fprintf(stderr, "%s: ", inputPath);
+            tilingPrintError(ctx, stderr);
+            goto err0;
+        }
+        amount = tilingAmount(ctx);
+        tiles = (uint64_t *) malloc((amount ? amount : 1) * sizeof(uint64_t));
+        if (!tiles) { goto mem; }
+        const tile_t * t = ctx->allTiles.tiles;
+        for (size_t i = 0; i < amount; i++) { tiles[i] = key(t[i].p.x, t[i].p.y); }
+    } else {
+        if (readText(file, &ref)) { goto mem; }
+        haveRef = 1;
+        if (isNone(&ref))
+        {
+            if (isNone(&out)) { goto ok; }
+            fprintf(stderr, "Expected None!\n");
+            status = 1;
+            goto err0;
+        }
+        int parsed = parseDominoes(&ref, threads, &tiles, &amount);
+        if (parsed < 0) { goto mem; }
+        if (parsed)
+        {
+            status = compareLiteral(&out, &ref);
+            if (!status) { printf("OK\n"); }
+            goto err0;
+        }
+    }
+
+    temp = (uint64_t *) malloc((amount ? amount : 1) * sizeof(uint64_t));
+    if (!temp) { goto mem; }
+    uint64_t * sorted = sortKeys(tiles, temp, amount, threads);
+    if (!sorted) { goto mem; }
+    if (sorted != tiles)
+    {
+        temp = tiles;
+        tiles = sorted;
+    }
+    for (size_t i = 1; i < amount; i++)
+    {
+        if (tiles[i] == tiles[i - 1])
+        {
+            fprintf(stderr, "%s: tile %u %u occurs twice!\n", inputPath ? inputPath : refPath,
+                    (unsigned int) (tiles[i] >> 32), (unsigned int) tiles[i]);
+            goto err0;
+        }
+    }
+
+    /* "None": Paritaet, sonst loesen
+     */
+    if (isNone(&out))
+    {
+        status = 1;
+        if (!inputPath)
+        {
+            fprintf(stderr, "Line 1: None, but the reference has a tiling!\n");
+            goto err0;
+        }
+        size_t black = 0;
+        for (size_t i = 0; i < amount; i++) { black += ((tiles[i] >> 32) + tiles[i]) & 1; }
+        if (2 * black == amount)
+        {
+            int result = tilingSolve(ctx);
+            if (result < 0)
+            {
+                tilingPrintError(ctx, stderr);
+                status = 2;
+                goto err0;
+            }
+            if (!result)
+            {
+                fprintf(stderr, "Line 1: None, but a tiling exists!\n");
+                goto err0;
+            }
+        }
+        goto ok;
+    }
+
+    /* Schneller Weg: parallel zerlegen, sortieren, vergleichen
+     */
+    int parsed = parseDominoes(&out, threads, &keys, &amountKeys);
+    if (parsed < 0) { goto mem; }
+    if (!parsed && amountKeys == amount)
+    {
+        uint64_t * done = sortKeys(keys, temp, amountKeys, threads);
+        if (!done) { goto mem; }
+        int same = sameKeys(done, tiles, amount, threads);
+        if (same < 0) { goto mem; }
+        if (same) { goto ok; }
+    }
+    reportFirst(&out, tiles, amount);
+    status = 1;
+    goto err0;
+
+ok:
+    if (isNone(&out))
+    {
+        printf("OK None\n");
+    } else {
+        printf("OK %zu dominoes\n", amountKeys / 2);
+    }
+    status = 0;
+    goto err0;
+
+mem:
+    fprintf(stderr, "Not enough memory available!\n");
+    status = 2;
+err0:
+    if (file) { fclose(file); }
+    if (haveRef) { freeText(&ref); }
+    freeText(&out);
+    tilingFree(ctx);
+    free(tiles);
+    free(temp);
+    free(keys);
+    return status;
+}
@@ -0,0 +1,225 @@
+/* loesung-client: Anfragen an loesung --serve
+ *
+ *     loesung-client PFAD [--binary] [--repeat N] [--stats] < eingabe
+ *
+ * Schickt die Eingabe N-mal (Standard 1, 0 = gar nicht) ueber eine
+ * Verbindung und gibt die letzte Antwort wie loesung aus: Dominos oder
+ * "None" auf stdout, Fehlermeldungen auf stderr mit Rueckgabewert 1.
+ * --binary wandelt die Eingabe vorher in Punkte um (nur Ziffern und
+ * Leerraum), --stats holt am Ende die Latenzstatistik auf stderr.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "tiling.h"
+
+static int writeAll(int fd, const char * src, size_t n)
+{
+    while (n)
+    {
+        ssize_t put = write(fd, src, n);
+        if (put < 0 && errno == EINTR) { continue; }
+        if (put <= 0) { return -1; }
+        n -= (size_t) put;
+        src += put;
+    }
+    return 0;
+}
+
+static int readExact(FILE * in, char * dst, size_t n)
+{
+    return fread(dst, 1, n, in) == n ? 0 : -1;
+}
+
+/* Anfrage schicken, Antwort lesen
+ *
+ * 0: OK, 1: ERR, -1: Verbindung gestoert; Rumpf in *body (mit malloc)
+ */
+static int request(int fd, FILE * in, char kind, size_t n, const char * data, size_t bytes,
+                   char ** body, size_t * len)
+{
+    char head[48];
+    int headLen = snprintf(head, sizeof(head), "%c %zu\n", kind, n);
+    if (writeAll(fd, head, (size_t) headLen) || writeAll(fd, data, bytes)) { return -1; }
+
+    char status[4];
+    size_t size;
+    if (fscanf(in, "%3s %zu", status, &size) != 2 || fgetc(in) != '\n') { return -1; }
+    free(*body);
+    *body = (char *) malloc(size ? size : 1);
+    if (!*body || readExact(in, *body, size)) { return -1; }
+    *len = size;
+    if (!strcmp(status, "OK")) { return 0; }
+    return strcmp(status, "ERR") ? -1 : 1;
+}
+
+static char * readAll(FILE * in, size_t * len)
+{
+    size_t cap = 4096;
+    char * data = (char *) malloc(cap);
+    *len = 0;
+    while (data)
+    {
+        *len += fread(data + *len, 1, cap - *len, in);
+        if (*len < cap) { break; }
+        cap *= 2;
+        char * temp = (char *) realloc(data, cap);
+        if (!temp) { free(data); }
+        data = temp;
+    }
+    return data;
+}
+
+/* Text in Punkte umwandeln, keine Pruefung ausser auf Ziffern und Paare
+ */
+static point_t * toPoints(const char * text, size_t len, size_t * amount)
+{
+    point_t * points = (point_t *) malloc((len / 4 + 1) * sizeof(point_t));
+    if (!points) { return NULL; }
+    unsigned long long v[2];
+    int have = 0;
+    int inNumber = 0;
+    *amount = 0;
+    for (size_t i = 0; i <= len; i++)
+    {
+        char c = i < len ? text[i] : '\n';
+        if (c >= '0' && c <= '9')
+        {
+            if (!inNumber)
+            {
+                if (have == 2) { goto err0; }
+                v[have] = 0;
+            }
+            v[have] = v[have] * 10 + (unsigned long long) (c - '0');
+            if (v[have] > 0xffffffffull) { goto err0; }
+            inNumber = 1;
+            continue;
+        }
+        if (inNumber) { have++; }
+        inNumber = 0;
+        if (c == '\n')
+        {
+            if (have == 2)
+            {
+                points[*amount].x = (unsigned int) v[0];
+                points[*amount].y = (unsigned int) v[1];
+                (*amount)++;
+            } else if (have) {
+                goto err0;
+            }
+            have = 0;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            goto err0;
+        }
+    }
+    return points;
+
+err0:
+    free(points);
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s SOCKET [--binary] [--repeat N] [--stats]\n", argv[0]);
+        return 1;
+    }
+    int binary = 0;
+    int stats = 0;
+    unsigned long repeat = 1;
+    for (int a = 2; a < argc; a++)
+    {
+        if (!strcmp(argv[a], "--binary")) { binary = 1; continue; }
+        if (!strcmp(argv[a], "--stats")) { stats = 1; continue; }
+        if (!strcmp(argv[a], "--repeat") && a+1 < argc)
+        {
+            repeat = strtoul(argv[++a], NULL, 10);
+            continue;
+        }
+        fprintf(stderr, "Unknown or incomplete option '%s'!\n", argv[a]);
+        return 1;
+    }
+
+    int status = 1;
+    char * text = NULL;
+    size_t textLen = 0;
+    point_t * points = NULL;
+    size_t amount = 0;
+    char * body = NULL;
+    size_t len = 0;
+    FILE * in = NULL;
+
+    if (repeat)
+    {
+        text = readAll(stdin, &textLen);
+        if (!text)
+        {
+            fprintf(stderr, "Not enough memory available!\n");
+            goto err0;
+        }
+        if (binary && !(points = toPoints(text, textLen, &amount)))
+        {
+            fprintf(stderr, "Input cannot be sent as points!\n");
+            goto err0;
+        }
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) || !(in = fdopen(fd, "r")))
+    {
+        fprintf(stderr, "Cannot connect to '%s'!\n", argv[1]);
+        if (fd >= 0) { close(fd); }
+        goto err0;
+    }
+
+    int answer = 0;
+    for (unsigned long r = 0; r < repeat; r++)
+    {
+        if (binary)
+        {
+            answer = request(fd, in, 'B', amount, (const char *) points, amount * sizeof(point_t), &body, &len);
+        } else {
+            answer = request(fd, in, 'T', textLen, text, textLen, &body, &len);
+        }
+        if (answer < 0) { break; }
+    }
+    if (answer < 0)
+    {
+        fprintf(stderr, "Connection to '%s' failed!\n", argv[1]);
+        goto err1;
+    }
+    if (repeat) { fwrite(body, 1, len, answer ? stderr : stdout); }
+    status = answer;
+
+    if (stats)
+    {
+        if (request(fd, in, 'S', 0, NULL, 0, &body, &len))
+        {
+            fprintf(stderr, "Connection to '%s' failed!\n", argv[1]);
+            status = 1;
+            goto err1;
+        }
+        fwrite(body, 1, len, stderr);
+    }
+
+err1:
+    fclose(in);
+err0:
+    free(text);
+    free(points);
+    free(body);
+    return status;
+}
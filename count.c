@@ -0,0 +1,683 @@
+/* Zaehlen der Parkettierungen ueber die Kasteleyn-Determinante
+ *
+ * Die Kacheln bilden einen bipartiten planaren Graphen (schwarz: x+y gerade).
+ * Mit Kasteleyn-Vorzeichen auf den Kanten gilt |det K| = Anzahl der
+ * Parkettierungen, wobei K die schwarz/weiss Biadjazenzmatrix ist.
+ *
+ * Vorzeichen:
+ *   north (x,y)-(x,y+1): (-1)^x
+ *   east  (x,y)-(x+1,y): (-1)^m, m = Anzahl fehlender Punkte (x,y') mit y' < y
+ *
+ * Die (-1)^x Kanten erfuellen die Bedingung fuer jedes Einheitsquadrat von Z^2.
+ * Jeder fehlende Gitterpunkt q kippt die Kanten, die ein Strahl von q nach
+ * oben kreuzt; damit stimmt die Bedingung auch fuer Kreise um Loecher.
+ *
+ * Die Spalten werden ueber die gefundene Ueberdeckung den schwarzen Kacheln
+ * zugeordnet (Diagonale strukturell != 0). Zeilen und Spalten werden per
+ * Nested Dissection sortiert und mit duennbesetzter LU eliminiert. Jeder
+ * Eintrag traegt die Werte fuer alle Primzahlen und einen double (ln der
+ * Anzahl), damit die Struktur nur einmal gemischt werden muss.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "loesung.h"
+
+#define COUNT_PRIMES 4
+#define FIELDS (COUNT_PRIMES + 1)
+#define REAL COUNT_PRIMES
+
+#define LEAF_SIZE 64
+#define PARALLEL_WORK (1u << 16)
+
+// p < 2^26, damit Produkte exakt in einen double passen
+static const uint32_t primes[COUNT_PRIMES] = { 67108859, 67108837, 67108819, 67108777 };
+static const double primeInv[COUNT_PRIMES] = { 1.0/67108859, 1.0/67108837, 1.0/67108819, 1.0/67108777 };
+
+typedef struct entry_s{
+    unsigned int col;
+    uint32_t mod[COUNT_PRIMES];
+    double real;
+} entry_t;
+
+typedef struct row_s{
+    entry_t * e;
+    unsigned int len;
+    unsigned int cap;
+} row_t;
+
+typedef struct index_s{
+    unsigned int * i;
+    unsigned int len;
+    unsigned int cap;
+} index_t;
+
+typedef struct matrix_s{
+    unsigned int n;
+    row_t * rows;
+    index_t * cols;     // Zeilen, die die Spalte enthalten (evtl. veraltet)
+    int diagSign;       // Vorzeichen des Produkts der Diagonale
+} matrix_t;
+
+typedef struct scratch_s{
+    entry_t * e;
+    unsigned int cap;
+    index_t fill;       // neue (Spalte, Zeile) Paare, paarweise abgelegt
+} scratch_t;
+
+typedef struct job_s{
+    row_t * rows;
+    const row_t * pivot;
+    const entry_t * inv;
+    unsigned int * todo;
+    unsigned int amount;
+    scratch_t * s;
+    int failed;
+} job_t;
+
+static int pushIndex(index_t * idx, unsigned int v)
+{
+    if (idx->len == idx->cap)
+    {
+        unsigned int cap = idx->cap ? idx->cap * 2 : 4;
+        unsigned int * temp = (unsigned int *) realloc(idx->i, cap * sizeof(unsigned int));
+        if (!temp) { return -1; }
+        idx->i = temp;
+        idx->cap = cap;
+    }
+    idx->i[idx->len++] = v;
+    return 0;
+}
+
+/* a*b mod p ueber den Kehrwert statt einer 64 bit Division
+ *
+ * Der Quotient ist hoechstens um 1 falsch, die Korrektur laeuft ohne Sprung,
+ * weil die Vorzeichen der Zwischenwerte nicht vorhersagbar sind.
+ */
+static uint32_t mulMod(uint32_t a, uint32_t b, unsigned int q)
+{
+    uint64_t x = (uint64_t) a * b;
+    uint64_t e = (uint64_t) ((double) x * primeInv[q]);
+    int64_t r = (int64_t) (x - e * primes[q]);
+    r += (int64_t) primes[q] & -(int64_t) (r < 0);
+    r -= (int64_t) primes[q] & -(int64_t) (r >= (int64_t) primes[q]);
+    return (uint32_t) r;
+}
+
+static uint32_t powMod(uint32_t b, uint32_t e, unsigned int q)
+{
+    uint32_t r = 1;
+    while (e)
+    {
+        if (e & 1) { r = mulMod(r, b, q); }
+        b = mulMod(b, b, q);
+        e >>= 1;
+    }
+    return r;
+}
+
+/* out = a - factor * b fuer alle Felder
+ */
+static void mulSub(entry_t * out, const entry_t * a, const entry_t * factor, const entry_t * b)
+{
+    for (unsigned int q = 0; q < COUNT_PRIMES; q++)
+    {
+        int64_t r = (int64_t) a->mod[q] - mulMod(factor->mod[q], b->mod[q], q);
+        r += (int64_t) primes[q] & -(int64_t) (r < 0);
+        out->mod[q] = (uint32_t) r;
+    }
+    out->real = a->real - factor->real * b->real;
+}
+
+static int isZero(const entry_t * v)
+{
+    uint32_t any = 0;
+    for (unsigned int q = 0; q < COUNT_PRIMES; q++) { any |= v->mod[q]; }
+    return !any && v->real == 0.0;
+}
+
+static int isNonZero(const entry_t * v, unsigned int q)
+{
+    return q == REAL ? v->real != 0.0 : v->mod[q] != 0;
+}
+
+/* Nested Dissection
+ *
+ * Zwei schwarze Kacheln teilen sich eine Matrixzeile/-spalte nur, wenn sie
+ * sich in keiner Koordinate um mehr als 2 unterscheiden. Ein Separator aus
+ * zwei benachbarten Gitterlinien trennt also beide Haelften vollstaendig.
+ */
+static int cmpX(const void * a, const void * b)
+{
+    const tile_t * ta = *(tile_t * const *) a;
+    const tile_t * tb = *(tile_t * const *) b;
+    return (ta->p.x > tb->p.x) - (ta->p.x < tb->p.x);
+}
+
+static int cmpY(const void * a, const void * b)
+{
+    const tile_t * ta = *(tile_t * const *) a;
+    const tile_t * tb = *(tile_t * const *) b;
+    return (ta->p.y > tb->p.y) - (ta->p.y < tb->p.y);
+}
+
+static void dissect(tile_t ** cells, unsigned int n, tile_t ** temp)
+{
+    if (n <= LEAF_SIZE) { return; }
+
+    unsigned int minX = cells[0]->p.x, maxX = minX;
+    unsigned int minY = cells[0]->p.y, maxY = minY;
+    for (unsigned int i = 1; i < n; i++)
+    {
+        if (cells[i]->p.x < minX) { minX = cells[i]->p.x; }
+        if (cells[i]->p.x > maxX) { maxX = cells[i]->p.x; }
+        if (cells[i]->p.y < minY) { minY = cells[i]->p.y; }
+        if (cells[i]->p.y > maxY) { maxY = cells[i]->p.y; }
+    }
+    int alongX = (maxX - minX) >= (maxY - minY);
+    qsort(cells, n, sizeof(tile_t*), alongX ? cmpX : cmpY);
+
+    unsigned int mid = alongX ? cells[n/2]->p.x : cells[n/2]->p.y;
+    unsigned int a = 0;
+    unsigned int b = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        unsigned int c = alongX ? cells[i]->p.x : cells[i]->p.y;
+        if (c < mid) { a = i+1; }
+        if (c <= mid + 1 && c >= mid) { b = i+1; }
+    }
+    if (b < a) { b = a; }
+
+    // [0,a) links, [a,b) Separator, [b,n) rechts -> links, rechts, Separator
+    unsigned int sep = b - a;
+    for (unsigned int i = 0; i < sep; i++) { temp[i] = cells[a+i]; }
+    for (unsigned int i = b; i < n; i++) { cells[i - sep] = cells[i]; }
+    for (unsigned int i = 0; i < sep; i++) { cells[n - sep + i] = temp[i]; }
+
+    dissect(cells, a, temp);
+    dissect(cells + a, n - b, temp);
+}
+
+/* Aufbau der Matrix
+ *
+ * Zeile i: i-te schwarze Kachel in ND-Reihenfolge
+ * Spalte j: weisse Kachel, die mit der j-ten schwarzen Kachel ueberdeckt ist
+ */
+static int buildMatrix(allTiles_t * allTiles, matrix_t * m)
+{
+    m->rows = NULL;
+    m->cols = NULL;
+    if (allTiles->amount > UINT_MAX) { return -1; }    // Matrixindizes sind 32 Bit
+    unsigned int amount = (unsigned int) allTiles->amount;
+    tile_t * tiles = allTiles->tiles;
+
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < amount; i++)
+    {
+        if (!((tiles[i].p.x + tiles[i].p.y) & 1)) { n++; }
+    }
+
+    char * eastSign = (char *) malloc(amount);
+    unsigned int * pos = (unsigned int *) malloc(amount * sizeof(unsigned int));
+    tile_t ** cells = (tile_t **) malloc((n ? n : 1) * sizeof(tile_t*));
+    tile_t ** temp = (tile_t **) malloc((n ? n : 1) * sizeof(tile_t*));
+    m->n = n;
+    m->rows = (row_t *) calloc(n ? n : 1, sizeof(row_t));
+    m->cols = (index_t *) calloc(n ? n : 1, sizeof(index_t));
+    m->diagSign = 1;
+    if (!eastSign || !pos || !cells || !temp || !m->rows || !m->cols) { goto fail; }
+
+    // fehlende Punkte unterhalb jeder Kachel in ihrer Spalte (nur Paritaet)
+    unsigned int low = 0;
+    unsigned int rank = 0;
+    for (unsigned int i = 0; i < amount; i++)
+    {
+        if (i == 0 || tiles[i].p.x != tiles[i-1].p.x)
+        {
+            low = tiles[i].p.y;
+            rank = 0;
+        }
+        eastSign[i] = (char) ((tiles[i].p.y - low - rank) & 1);
+        rank++;
+    }
+
+    unsigned int k = 0;
+    for (unsigned int i = 0; i < amount; i++)
+    {
+        if (!((tiles[i].p.x + tiles[i].p.y) & 1)) { cells[k++] = &tiles[i]; }
+    }
+    dissect(cells, n, temp);
+    for (unsigned int i = 0; i < n; i++) { pos[cells[i] - tiles] = i; }
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        tile_t * b = cells[i];
+        tile_t * neighbours[4] = { b->north, b->south, b->east, b->west };
+        row_t * row = &m->rows[i];
+        row->e = (entry_t *) malloc(4 * sizeof(entry_t));
+        if (!row->e) { goto fail; }
+        row->cap = 4;
+
+        for (unsigned int d = 0; d < 4; d++)
+        {
+            tile_t * w = neighbours[d];
+            if (!w) { continue; }
+
+            int negative;
+            if (d < 2)
+            {
+                negative = b->p.x & 1;
+            } else {
+                tile_t * left = d == 2 ? b : w;
+                negative = eastSign[left - tiles];
+            }
+            unsigned int col = pos[w->edge - tiles];
+            if (col == i && negative) { m->diagSign = -m->diagSign; }
+
+            // sortiert einfuegen
+            unsigned int j = row->len++;
+            while (j > 0 && row->e[j-1].col > col)
+            {
+                row->e[j] = row->e[j-1];
+                j--;
+            }
+            row->e[j].col = col;
+            for (unsigned int q = 0; q < COUNT_PRIMES; q++)
+            {
+                row->e[j].mod[q] = negative ? primes[q] - 1 : 1;
+            }
+            row->e[j].real = negative ? -1.0 : 1.0;
+            if (pushIndex(&m->cols[col], i)) { goto fail; }
+        }
+    }
+
+    free(temp);
+    free(cells);
+    free(pos);
+    free(eastSign);
+    return 0;
+
+fail:
+    free(temp);
+    free(cells);
+    free(pos);
+    free(eastSign);
+    return -1;
+}
+
+static void freeMatrix(matrix_t * m)
+{
+    if (m->rows)
+    {
+        for (unsigned int i = 0; i < m->n; i++) { free(m->rows[i].e); }
+    }
+    if (m->cols)
+    {
+        for (unsigned int i = 0; i < m->n; i++) { free(m->cols[i].i); }
+    }
+    free(m->rows);
+    free(m->cols);
+    m->rows = NULL;
+    m->cols = NULL;
+}
+
+/* row -= (row[0] * inv) * pivot, beide ohne die fuehrende Spalte
+ */
+static int eliminateRow(row_t * row, unsigned int index, const row_t * pivot, const entry_t * inv, scratch_t * s)
+{
+    static const entry_t zero;
+
+    unsigned int need = row->len + pivot->len;
+    if (need > s->cap)
+    {
+        entry_t * temp = (entry_t *) realloc(s->e, need * sizeof(entry_t));
+        if (!temp) { return -1; }
+        s->e = temp;
+        s->cap = need;
+    }
+
+    entry_t factor;
+    for (unsigned int q = 0; q < COUNT_PRIMES; q++)
+    {
+        factor.mod[q] = mulMod(row->e[0].mod[q], inv->mod[q], q);
+    }
+    factor.real = row->e[0].real * inv->real;
+
+    unsigned int i = 1;
+    unsigned int j = 1;
+    unsigned int k = 0;
+    while (i < row->len && j < pivot->len)
+    {
+        if (row->e[i].col < pivot->e[j].col)
+        {
+            s->e[k++] = row->e[i++];
+            continue;
+        }
+        unsigned int col = pivot->e[j].col;
+        if (row->e[i].col == col)
+        {
+            mulSub(&s->e[k], &row->e[i++], &factor, &pivot->e[j++]);
+        } else {
+            mulSub(&s->e[k], &zero, &factor, &pivot->e[j++]);
+            if (pushIndex(&s->fill, col) || pushIndex(&s->fill, index)) { return -1; }
+        }
+        s->e[k].col = col;
+        if (!isZero(&s->e[k])) { k++; }
+    }
+    while (i < row->len) { s->e[k++] = row->e[i++]; }
+    while (j < pivot->len)
+    {
+        unsigned int col = pivot->e[j].col;
+        mulSub(&s->e[k], &zero, &factor, &pivot->e[j++]);
+        if (pushIndex(&s->fill, col) || pushIndex(&s->fill, index)) { return -1; }
+        s->e[k].col = col;
+        if (!isZero(&s->e[k])) { k++; }
+    }
+
+    entry_t * old = row->e;
+    unsigned int oldCap = row->cap;
+    row->e = s->e;
+    row->cap = s->cap;
+    row->len = k;
+    s->e = old;
+    s->cap = oldCap;
+    return 0;
+}
+
+static void * eliminateJob(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    for (unsigned int t = 0; t < job->amount; t++)
+    {
+        unsigned int r = job->todo[t];
+        if (eliminateRow(&job->rows[r], r, job->pivot, job->inv, job->s))
+        {
+            job->failed = 1;
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* Pivotsuche fuer alle noch aktiven Felder
+ *
+ * Bevorzugt die Diagonale; im double Feld nur, solange sie nicht kleiner als
+ * ein Zehntel des groessten Kandidaten ist. Hat ein Feld keinen Kandidaten,
+ * ist die Matrix dort singulaer. Finden die Felder keine gemeinsame Zeile,
+ * wird ein Feld abgegeben und spaeter einzeln gerechnet.
+ */
+static unsigned int choosePivot(matrix_t * m, unsigned int * todo, unsigned int amount, unsigned int natural, unsigned int * alive, unsigned int * rerun, entry_t * det)
+{
+    while (*alive)
+    {
+        unsigned int best = m->n;
+        double bestAbs = -1.0;
+        int naturalOk = 0;
+        for (unsigned int t = 0; t < amount; t++)
+        {
+            const entry_t * v = &m->rows[todo[t]].e[0];
+            int ok = 1;
+            for (unsigned int q = 0; q < FIELDS && ok; q++)
+            {
+                if ((*alive >> q) & 1) { ok = isNonZero(v, q); }
+            }
+            if (!ok) { continue; }
+            double a = ((*alive >> REAL) & 1) ? fabs(v->real) : 0.0;
+            if (todo[t] == natural) { naturalOk = 1; }
+            if (a > bestAbs) { bestAbs = a; best = todo[t]; }
+        }
+        if (naturalOk)
+        {
+            double a = ((*alive >> REAL) & 1) ? fabs(m->rows[natural].e[0].real) : 0.0;
+            if (a >= 0.1 * bestAbs) { best = natural; }
+        }
+        if (best != m->n) { return best; }
+
+        unsigned int before = *alive;
+        for (unsigned int q = 0; q < FIELDS; q++)
+        {
+            if (!((*alive >> q) & 1)) { continue; }
+            int any = 0;
+            for (unsigned int t = 0; t < amount && !any; t++) { any = isNonZero(&m->rows[todo[t]].e[0], q); }
+            if (!any)
+            {
+                if (q == REAL) { det->real = -INFINITY; } else { det->mod[q] = 0; }
+                *alive &= ~(1u << q);
+            }
+        }
+        if (*alive == before)
+        {
+            unsigned int q = 0;
+            while (!((*alive >> q) & 1)) { q++; }
+            *alive &= ~(1u << q);
+            *rerun |= 1u << q;
+        }
+    }
+    return m->n;
+}
+
+/* Determinante fuer die Felder in alive
+ *
+ * mod p: det->mod[q] = det mod p (Vorzeichen schon eingerechnet)
+ * double: det->real = ln|det|, *sign = Vorzeichen
+ * Felder, die neu gerechnet werden muessen, landen in *rerun.
+ */
+static int determinant(matrix_t * m, unsigned int alive, unsigned int threads, entry_t * det, int * sign, unsigned int * rerun)
+{
+    unsigned int n = m->n;
+    int result = -1;
+    int swaps = 0;
+    int detSign = 1;
+    unsigned int finished = alive;
+
+    for (unsigned int q = 0; q < COUNT_PRIMES; q++)
+    {
+        if ((alive >> q) & 1) { det->mod[q] = 1; }
+    }
+    if ((alive >> REAL) & 1) { det->real = 0.0; }
+
+    unsigned int * rowAtPos = (unsigned int *) malloc((n ? n : 1) * sizeof(unsigned int));
+    unsigned int * posOfRow = (unsigned int *) malloc((n ? n : 1) * sizeof(unsigned int));
+    unsigned int * todo = (unsigned int *) malloc((n ? n : 1) * sizeof(unsigned int));
+    unsigned int * stamp = (unsigned int *) calloc(n ? n : 1, sizeof(unsigned int));
+    scratch_t * s = (scratch_t *) calloc(threads, sizeof(scratch_t));
+    job_t * jobs = (job_t *) calloc(threads, sizeof(job_t));
+    pthread_t * ids = (pthread_t *) calloc(threads, sizeof(pthread_t));
+    if (!rowAtPos || !posOfRow || !todo || !stamp || !s || !jobs || !ids) { goto done; }
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        rowAtPos[i] = i;
+        posOfRow[i] = i;
+    }
+
+    for (unsigned int k = 0; k < n && alive; k++)
+    {
+        // Kandidaten: noch nicht verwendete Zeilen mit Eintrag in Spalte k
+        index_t * col = &m->cols[k];
+        unsigned int amount = 0;
+        for (unsigned int c = 0; c < col->len; c++)
+        {
+            unsigned int r = col->i[c];
+            row_t * row = &m->rows[r];
+            if (posOfRow[r] < k || !row->len || row->e[0].col != k) { continue; }
+            if (stamp[r] == k+1) { continue; }
+            stamp[r] = k+1;
+            todo[amount++] = r;
+        }
+
+        unsigned int natural = rowAtPos[k];
+        unsigned int best = choosePivot(m, todo, amount, natural, &alive, rerun, det);
+        if (best == n) { break; }
+
+        // Zeilentausch
+        if (best != natural)
+        {
+            unsigned int q = posOfRow[best];
+            rowAtPos[q] = natural;
+            posOfRow[natural] = q;
+            rowAtPos[k] = best;
+            posOfRow[best] = k;
+            swaps++;
+        }
+
+        row_t * pivot = &m->rows[best];
+        const entry_t * pv = &pivot->e[0];
+        entry_t inv;
+        for (unsigned int q = 0; q < COUNT_PRIMES; q++)
+        {
+            inv.mod[q] = 0;
+            if (!((alive >> q) & 1)) { continue; }
+            det->mod[q] = mulMod(det->mod[q], pv->mod[q], q);
+            inv.mod[q] = powMod(pv->mod[q], primes[q] - 2, q);
+        }
+        inv.real = 0.0;
+        if ((alive >> REAL) & 1)
+        {
+            det->real += log(fabs(pv->real));
+            if (pv->real < 0) { detSign = -detSign; }
+            inv.real = 1.0 / pv->real;
+        }
+
+        // Pivotzeile entfernen
+        unsigned int w = 0;
+        for (unsigned int t = 0; t < amount; t++)
+        {
+            if (todo[t] != best) { todo[w++] = todo[t]; }
+        }
+        amount = w;
+
+        unsigned int used = amount ? 1 : 0;
+        if (threads > 1 && (uint64_t) amount * pivot->len >= PARALLEL_WORK)
+        {
+            used = threads < amount ? threads : amount;
+        }
+        unsigned int chunk = used ? (amount + used - 1) / used : 0;
+        for (unsigned int t = 0; t < used; t++)
+        {
+            unsigned int first = t * chunk;
+            jobs[t].rows = m->rows;
+            jobs[t].pivot = pivot;
+            jobs[t].inv = &inv;
+            jobs[t].todo = todo + first;
+            jobs[t].amount = first >= amount ? 0 : (amount - first < chunk ? amount - first : chunk);
+            jobs[t].s = &s[t];
+            jobs[t].failed = 0;
+            s[t].fill.len = 0;
+        }
+        if (used > 1)
+        {
+            unsigned int started = 1;
+            for (unsigned int t = 1; t < used; t++)
+            {
+                if (pthread_create(&ids[t], NULL, eliminateJob, &jobs[t])) { break; }
+                started++;
+            }
+            eliminateJob(&jobs[0]);
+            for (unsigned int t = 1; t < started; t++) { pthread_join(ids[t], NULL); }
+            for (unsigned int t = started; t < used; t++) { eliminateJob(&jobs[t]); }
+        } else if (used) {
+            eliminateJob(&jobs[0]);
+        }
+
+        for (unsigned int t = 0; t < used; t++)
+        {
+            if (jobs[t].failed) { goto done; }
+            for (unsigned int u = 0; u < s[t].fill.len; u += 2)
+            {
+                if (pushIndex(&m->cols[s[t].fill.i[u]], s[t].fill.i[u+1])) { goto done; }
+            }
+        }
+
+        // Pivotzeile und Spaltenliste werden nicht mehr gebraucht
+        free(pivot->e);
+        pivot->e = NULL;
+        pivot->len = pivot->cap = 0;
+        free(col->i);
+        col->i = NULL;
+        col->len = col->cap = 0;
+    }
+    result = 0;
+
+    // Vorzeichen: det(M) = (-1)^swaps * Produkt der Pivots, Anzahl = det(M) * diagSign
+    finished &= ~*rerun;
+    int negate = (swaps & 1) != (m->diagSign < 0);
+    for (unsigned int q = 0; q < COUNT_PRIMES; q++)
+    {
+        if (((finished >> q) & 1) && negate && det->mod[q]) { det->mod[q] = primes[q] - det->mod[q]; }
+    }
+    if ((finished >> REAL) & 1)
+    {
+        *sign = negate ? -detSign : detSign;
+    }
+
+done:
+    if (s)
+    {
+        for (unsigned int t = 0; t < threads; t++)
+        {
+            free(s[t].e);
+            free(s[t].fill.i);
+        }
+    }
+    free(ids);
+    free(jobs);
+    free(s);
+    free(stamp);
+    free(todo);
+    free(posOfRow);
+    free(rowAtPos);
+    return result;
+}
+
+void tilingCount(tiling_t * ctx, int hasTiling, unsigned int threads)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    entry_t det;
+    int sign = 1;
+    tilingPhase(ctx, PHASE_COUNT);
+
+    if (!threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned int) online : 1;
+    }
+
+    for (unsigned int q = 0; q < COUNT_PRIMES; q++) { det.mod[q] = allTiles->amount ? 0 : 1; }
+    det.real = allTiles->amount ? -INFINITY : 0.0;
+
+    // Felder, die wegen eines Pivots ohne gemeinsame Zeile einzeln laufen
+    unsigned int pending = hasTiling && allTiles->amount ? (1u << FIELDS) - 1 : 0;
+    while (pending)
+    {
+        unsigned int rerun = 0;
+        matrix_t m;
+        if (buildMatrix(allTiles, &m) || determinant(&m, pending, threads, &det, &sign, &rerun))
+        {
+            freeMatrix(&m);
+            ctx->error = TILING_EXCEED_MEM;
+            return;
+        }
+        freeMatrix(&m);
+        pending = rerun;
+    }
+
+    for (unsigned int q = 0; q < COUNT_PRIMES; q++)
+    {
+        fprintf(stdout, "mod %lu: %lu\n", (unsigned long) primes[q], (unsigned long) det.mod[q]);
+    }
+    if (sign < 0)
+    {
+        fprintf(stdout, "ln: nan\n");
+    } else {
+        fprintf(stdout, "ln: %.12g\n", det.real);
+    }
+    return;
+}
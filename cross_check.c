@@ -0,0 +1,147 @@
+/* cross_check: Zufallsinstanzen fuer tilingCrossCheck()
+ *
+ *     cross_check [--seed S] [--rounds N] [--size N]
+ *
+ * Erzeugt N Instanzen (Standard 1000) aus dem xorshift-Generator in instances.c,
+ * also fuer jeden Seed auf jedem Rechner dieselben: abwechselnd zufaellige
+ * Teilmengen eines Rechtecks bis size x size (Standard 16) und volle
+ * Rechtecke, aus denen zufaellige Dominos entfernt wurden (beide Farben
+ * bleiben gleich haeufig, die Paritaet entscheidet also nichts; die
+ * schwierigeren Faelle). Jede Instanz laeuft mit jedem Loeser (auto, also
+ * die Wahl des Planers, und alle festen) in jedem Layout gegen die Suche
+ * aus floesung.c, die Zeiten werden je Loeser summiert.
+ *
+ * Bei einem Widerspruch wird die Instanz verkleinert: Stuecke von erst der
+ * halben, dann immer kleinerer Laenge werden entfernt, solange der
+ * Widerspruch bleibt. Die kleinste Instanz geht im Eingabeformat auf stdout,
+ * der Bericht auf stderr, Rueckgabe 1.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "loesung.h"
+#include "instances.h"
+
+static const char * const layoutNames[] = { "sorted", "morton", "hilbert" };
+
+/* 1: Widerspruch, 0: einig, -1: Fehler
+ */
+static int check(tiling_t * ctx, const point_t * points, size_t amount, tilingCross_t * report)
+{
+    if (tilingLoadPoints(ctx, points, amount)) { return -1; }
+    return tilingCrossCheck(ctx, report);
+}
+
+/* Stuecke entfernen, solange der Widerspruch bleibt
+ */
+static size_t shrink(tiling_t * ctx, point_t * points, size_t amount, tilingCross_t * report)
+{
+    size_t chunk = amount / 2;
+    while (chunk >= 1)
+    {
+        int removed = 0;
+        size_t start = 0;
+        while (start < amount && amount > 1)
+        {
+            size_t cut = start + chunk < amount ? chunk : amount - start;
+            point_t * rest = (point_t *) malloc((amount - cut) * sizeof(point_t));
+            if (!rest) { return amount; }
+            memcpy(rest, points, start * sizeof(point_t));
+            memcpy(rest + start, points + start + cut, (amount - start - cut) * sizeof(point_t));
+            tilingCross_t smaller;
+            if (check(ctx, rest, amount - cut, &smaller) == 1)
+            {
+                memcpy(points, rest, (amount - cut) * sizeof(point_t));
+                amount -= cut;
+                *report = smaller;
+                removed = 1;
+            } else {
+                start += cut;
+            }
+            free(rest);
+        }
+        if (!removed) { chunk /= 2; }
+        if (chunk > amount / 2) { chunk = amount / 2; }
+    }
+    return amount;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long long seed = 1;
+    unsigned long rounds = 1000;
+    unsigned int size = 16;
+    for (int a = 1; a < argc; a++)
+    {
+        if (!strcmp(argv[a], "--seed") && a+1 < argc) { seed = strtoull(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--rounds") && a+1 < argc) { rounds = strtoul(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--size") && a+1 < argc)
+        {
+            size = (unsigned int) strtoul(argv[++a], NULL, 10);
+            if (size) { continue; }
+        }
+        fprintf(stderr, "Unknown or incomplete option '%s'!\n", argv[a]);
+        return 2;
+    }
+    random_t rng;
+    randomSeed(&rng, seed);
+
+    int status = 2;
+    tiling_t * ctx = tilingCreate();
+    point_t * points = (point_t *) malloc((size_t) size * size * sizeof(point_t));
+    if (!ctx || !points)
+    {
+        fprintf(stderr, "Not enough memory available!\n");
+        goto err0;
+    }
+
+    double seconds[TILING_ENGINES] = { 0.0 };  // je eingestelltem Loeser
+    double visited = 0.0;
+    unsigned long tileable = 0;
+    for (unsigned long r = 0; r < rounds; r++)
+    {
+        size_t amount = makeFamily(points, r & 1 ? FAMILY_DOMINOES : FAMILY_SUBSET, size, &rng);
+        for (int e = 0; e < TILING_ENGINES; e++)
+        {
+            if (e == TILING_ENGINE_PARITY) { continue; }
+            for (int l = TILING_LAYOUT_SORTED; l <= TILING_LAYOUT_HILBERT; l++)
+            {
+                tilingSetEngine(ctx, (tilingEngine_t) e, 1);
+                tilingSetLayout(ctx, (tilingLayout_t) l);
+                tilingCross_t report;
+                int cross = check(ctx, points, amount, &report);
+                if (cross < 0)
+                {
+                    tilingPrintError(ctx, stderr);
+                    goto err0;
+                }
+                seconds[e] += report.seconds[0];
+                visited += report.seconds[1];
+                if (!e && !l) { tileable += !report.result[1]; }
+                if (cross)
+                {
+                    fprintf(stderr, "cross_check: mismatch in instance %lu (seed %llu, %zu tiles, engine %s, layout %s), shrinking\n",
+                            r, seed, amount, tilingEngineName((tilingEngine_t) e), layoutNames[l]);
+                    amount = shrink(ctx, points, amount, &report);
+                    for (size_t i = 0; i < amount; i++) { printf("%u %u\n", points[i].x, points[i].y); }
+                    tilingPrintCross(&report, stderr);
+                    status = 1;
+                    goto err0;
+                }
+            }
+        }
+    }
+    printf("cross_check: %lu instances (seed %llu, up to %ux%u), %lu tileable, all layouts:", rounds, seed, size, size, tileable);
+    for (int e = 0; e < TILING_ENGINES; e++)
+    {
+        if (e != TILING_ENGINE_PARITY) { printf(" %s %.6f s,", tilingEngineName((tilingEngine_t) e), seconds[e]); }
+    }
+    printf(" visited %.6f s -> agree\n", visited);
+    status = 0;
+
+err0:
+    free(points);
+    tilingFree(ctx);
+    return status;
+}
@@ -0,0 +1,193 @@
+/* Gegenprobe zweier Loeser (--cross-check, cross_check)
+ *
+ * Zuerst laeuft auf dem sortierten und verbundenen Feld die Suche aus
+ * floesung.c: Breitensuche mit visited_by-Zeigern ab der ersten freien
+ * Kachel, Start mit leerer Zuordnung, "None" sobald eine freie Kachel keinen
+ * augmentierenden Weg hat. visited_by liegt hier in einem eigenen Feld,
+ * damit tile_t unveraendert bleibt. Danach loest tilingSolve() dasselbe Feld
+ * neu mit dem eingestellten Loeser und Layout (tilingSetEngine(),
+ * tilingSetLayout(); bei AUTO also mit der Wahl des Planers), ohne Cache.
+ *
+ * Verglichen werden das Urteil (Parkettierung oder "None") und die
+ * Zuordnung jedes Loesers: nur zwischen Nachbarn, symmetrisch und bei einer
+ * Parkettierung vollstaendig. Danach liegt die Zuordnung des eingestellten
+ * Loesers vor, tilingNext() gibt also dieselbe Ausgabe wie sonst.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "loesung.h"
+
+static double seconds(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/* Zuordnung nur zwischen Nachbarn und symmetrisch, bei complete ohne freie Kachel
+ */
+static int validMatching(const allTiles_t * allTiles, int complete)
+{
+    for (size_t i = 0; i < allTiles->amount; i++)
+    {
+        const tile_t * t = &allTiles->tiles[i];
+        const tile_t * e = t->edge;
+        if (!e)
+        {
+            if (complete) { return 0; }
+            continue;
+        }
+        if (e->edge != t) { return 0; }
+        unsigned int dx = t->p.x > e->p.x ? t->p.x - e->p.x : e->p.x - t->p.x;
+        unsigned int dy = t->p.y > e->p.y ? t->p.y - e->p.y : e->p.y - t->p.y;
+        if (dx + dy != 1) { return 0; }
+    }
+    return 1;
+}
+
+/* Loeser aus floesung.c auf dem verbundenen Feld, edge muss leer sein
+ *
+ * 0: Parkettierung, 1: keine, -1: Fehler
+ */
+static int visitedSolve(tiling_t * ctx)
+{
+    tile_t * tiles = ctx->allTiles.tiles;
+    size_t amount = ctx->allTiles.amount;
+    tile_t ** visited = (tile_t **) memCalloc(ctx, amount, sizeof(tile_t *));
+    tile_t ** queue = (tile_t **) memAlloc(ctx, amount * sizeof(tile_t *));
+    if (!visited || !queue)
+    {
+        ctx->error = TILING_EXCEED_MEM;
+        memFree(ctx, visited);
+        memFree(ctx, queue);
+        return -1;
+    }
+
+    int result = 0;
+    size_t next = 0;        // davor ist alles zugeordnet
+    while (1)
+    {
+        while (next < amount && tiles[next].edge) { next++; }
+        if (next == amount) { break; }
+        tile_t * start = &tiles[next];
+
+        queue[0] = start;
+        size_t pop = 0;
+        size_t push = 1;
+        tile_t * end = NULL;
+        while (pop < push && !end)
+        {
+            tile_t * current = queue[pop++];
+            tile_t * children[4] = { current->north, current->south, current->east, current->west };
+            for (int c = 0; c < 4; c++)
+            {
+                tile_t * child = children[c];
+                if (!child || visited[child - tiles]) { continue; }
+                visited[child - tiles] = current;
+                if (!child->edge)
+                {
+                    end = child;
+                    break;
+                }
+                visited[child->edge - tiles] = child;
+                queue[push++] = child->edge;
+            }
+        }
+        if (!end)
+        {
+            result = 1;     // start bleibt frei, keine Parkettierung
+            break;
+        }
+
+        // Markierungen der Suche loeschen, vorher den Weg umlegen
+        for (tile_t * b = end; b; )
+        {
+            tile_t * a = visited[b - tiles];
+            tile_t * after = a == start ? NULL : visited[a - tiles];
+            b->edge = a;
+            a->edge = b;
+            b = after;
+        }
+        visited[end - tiles] = NULL;
+        for (size_t q = 1; q < push; q++)
+        {
+            visited[visited[queue[q] - tiles] - tiles] = NULL;
+            visited[queue[q] - tiles] = NULL;
+        }
+    }
+
+    memFree(ctx, visited);
+    memFree(ctx, queue);
+    return result;
+}
+
+/* Zuordnung und Verbindungen loeschen, wie frisch geladen
+ */
+static void clearTiles(allTiles_t * allTiles)
+{
+    for (size_t i = 0; i < allTiles->amount; i++)
+    {
+        tile_t * tile = &allTiles->tiles[i];
+        tile->edge = NULL;
+        tile->parent = NULL;
+        tile->north = NULL;
+        tile->south = NULL;
+        tile->west = NULL;
+        tile->east = NULL;
+    }
+}
+
+int tilingCrossCheck(tiling_t * ctx, tilingCross_t * report)
+{
+    memset(report, 0, sizeof(*report));
+    if (ctx->error) { return -1; }
+    allTiles_t * allTiles = &ctx->allTiles;
+    report->valid[0] = report->valid[1] = 1;
+
+    // Suche aus floesung.c auf dem sortierten, verbundenen Feld ohne Startzuordnung
+    if (allTiles->amount)
+    {
+        tilingPhase(ctx, PHASE_SORT);
+        if (sortTiles(ctx)) { return -1; }
+        tilingPhase(ctx, PHASE_LINK);
+        clearTiles(allTiles);
+        linkTiles(allTiles);
+        for (size_t i = 0; i < allTiles->amount; i++) { allTiles->tiles[i].edge = NULL; }
+        tilingPhase(ctx, PHASE_MATCH);
+        double begin = seconds();
+        report->result[1] = visitedSolve(ctx);
+        report->seconds[1] = seconds() - begin;
+        if (report->result[1] < 0) { return -1; }
+        report->valid[1] = validMatching(allTiles, !report->result[1]);
+        clearTiles(allTiles);
+    }
+
+    // eingestellter Loeser ueber tilingSolve(), ein Cache-Treffer waere keine Probe
+    const char * cacheDir = ctx->cacheDir;
+    ctx->cacheDir = NULL;
+    double begin = seconds();
+    report->result[0] = tilingSolve(ctx);
+    report->seconds[0] = seconds() - begin;
+    ctx->cacheDir = cacheDir;
+    if (report->result[0] < 0) { return -1; }
+    report->engine = ctx->plan.engine;
+    report->valid[0] = validMatching(allTiles, !report->result[0]);
+    return report->result[0] != report->result[1] || !report->valid[0] || !report->valid[1];
+}
+
+void tilingPrintCross(const tilingCross_t * report, FILE * out)
+{
+    int agree = report->result[0] == report->result[1] && report->valid[0] && report->valid[1];
+    fprintf(out, "cross-check:");
+    for (int e = 0; e < 2; e++)
+    {
+        fprintf(out, "%s %s %s %.6f s%s", e ? "," : "", e ? "visited" : tilingEngineName(report->engine), report->result[e] ? "None" : "tiling",
+                report->seconds[e], report->valid[e] ? "" : " (invalid matching)");
+    }
+    fprintf(out, " -> %s\n", agree ? "agree" : "MISMATCH");
+}
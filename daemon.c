@@ -0,0 +1,570 @@
+/* Dienstbetrieb (--serve PFAD)
+ *
+ * Lauscht auf einem Unix-Domain-Socket. Jede Verbindung kann beliebig viele
+ * Anfragen schicken, jede mit einer Kopfzeile "<Art> <n>\n":
+ *
+ *     T n   n Bytes Eingabe im ueblichen Textformat
+ *     B n   n Punkte binaer, je zwei uint32_t (x, y) in Rechnerreihenfolge
+ *     S 0   Latenzstatistik
+ *
+ * Antwort ist "OK n\n" bzw. "ERR n\n" gefolgt von n Bytes: die Dominos oder
+ * "None\n" wie auf stdout, bei ERR die Fehlermeldung.
+ *
+ * Ein fester Pool von Workern mit je eigenem Kontext bedient Anfragen, nicht
+ * Verbindungen: ruhende Verbindungen haelt der Hauptthread und wartet mit
+ * poll() auf sie. Erst eine lesbare Verbindung kommt in die Schlange, ein
+ * Worker beantwortet genau eine Anfrage und gibt sie dann zurueck (liegt
+ * schon die naechste im Puffer, gleich wieder in die Schlange). Untaetige
+ * Clients belegen so keinen Worker. Bleibt eine angefangene Anfrage oder
+ * das Abholen der Antwort SERVE_TIMEOUT Sekunden haengen, wird die
+ * Verbindung getrennt. Hoechstens SERVE_CONNS Verbindungen je Worker sind
+ * offen, darueber nimmt der Hauptthread keine weiteren an.
+ *
+ * Die Bearbeitungszeit jeder Anfrage landet in einem Histogramm mit
+ * Zweierpotenz-Stufen in Mikrosekunden. SIGINT/SIGTERM beenden den Dienst:
+ * der Handler schreibt ein Byte in eine Selbst-Pipe, und der Hauptthread
+ * wartet mit poll() auf sie und die Sockets zugleich, statt in accept() zu
+ * blockieren. So geht kein Signal zwischen Pruefung und Warten verloren.
+ * Ueber eine zweite Pipe wecken die Worker den Hauptthread, wenn sie eine
+ * Verbindung zurueckgeben.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "loesung.h"
+
+#define SERVE_CONNS 64      // offene Verbindungen je Worker
+#define SERVE_TIMEOUT 10    // Sekunden fuer den Rest einer Anfrage und die Antwort
+#define SERVE_BUCKETS 32    // Latenzstufen: < 2^k us
+#define SERVE_MAX_BYTES ((size_t) 1 << 32)
+
+typedef struct conn_s{
+    int fd;
+    char buf[4096];
+    size_t pos;
+    size_t len;
+} conn_t;
+
+typedef struct serve_s{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+
+    conn_t ** queue;        // Verbindungen mit lesbarer Anfrage
+    size_t amountQueue;     // = hoechstens offene Verbindungen
+    size_t head;
+    size_t waiting;
+    conn_t ** returned;     // von Workern zurueckgegeben, holt der Hauptthread ab
+    size_t amountReturned;
+    size_t open;            // offene Verbindungen
+    int notify[2];          // Pipe: Worker wecken poll() im Hauptthread
+    int finished;
+
+    int * active;           // Verbindung je Worker, sonst -1
+
+    unsigned long long histogram[SERVE_BUCKETS];
+    unsigned long long requests;
+    unsigned long long errors;
+    unsigned long long totalUs;
+    unsigned long long maxUs;
+} serve_t;
+
+typedef struct worker_s{
+    serve_t * s;
+    unsigned int id;
+
+    char * in;              // Anfrage
+    size_t capIn;
+    char * out;             // Antwort
+    size_t capOut;
+} worker_t;
+
+static volatile sig_atomic_t stopServe = 0;
+static int wakePipe[2] = { -1, -1 };   // Selbst-Pipe: der Handler weckt poll()
+
+static void onSignal(int sig)
+{
+    (void) sig;
+    stopServe = 1;
+    int saved = errno;
+    ssize_t put = write(wakePipe[1], "", 1);      // nicht blockierend, volle Pipe weckt auch
+    (void) put;
+    errno = saved;
+}
+
+static int fillConn(conn_t * c)
+{
+    while (1)
+    {
+        ssize_t got = read(c->fd, c->buf, sizeof(c->buf));
+        if (got > 0)
+        {
+            c->pos = 0;
+            c->len = (size_t) got;
+            return 0;
+        }
+        if (got < 0 && errno == EINTR) { continue; }
+        return -1;
+    }
+}
+
+/* n Bytes lesen (erst den Puffer leeren, grosse Reste direkt)
+ */
+static int readExact(conn_t * c, char * dst, size_t n)
+{
+    size_t have = c->len - c->pos;
+    if (have > n) { have = n; }
+    memcpy(dst, c->buf + c->pos, have);
+    c->pos += have;
+    n -= have;
+    dst += have;
+    while (n)
+    {
+        ssize_t got = read(c->fd, dst, n);
+        if (got < 0 && errno == EINTR) { continue; }
+        if (got <= 0) { return -1; }
+        n -= (size_t) got;
+        dst += got;
+    }
+    return 0;
+}
+
+/* Kopfzeile "<Art> <n>\n" lesen
+ *
+ * 0: gelesen, 1: Verbindung sauber beendet, -1: Fehler
+ */
+static int readHeader(conn_t * c, char * kind, unsigned long long * n)
+{
+    char line[32];
+    size_t len = 0;
+    while (1)
+    {
+        if (c->pos == c->len && fillConn(c)) { return len ? -1 : 1; }
+        char ch = c->buf[c->pos++];
+        if (ch == '\n') { break; }
+        if (len + 1 == sizeof(line)) { return -1; }
+        line[len++] = ch;
+    }
+    line[len] = '\0';
+
+    char * end;
+    if (len < 3 || line[1] != ' ') { return -1; }
+    *kind = line[0];
+    errno = 0;
+    *n = strtoull(line + 2, &end, 10);
+    if (errno || *end) { return -1; }
+    return 0;
+}
+
+static int writeAll(int fd, const char * src, size_t n)
+{
+    while (n)
+    {
+        ssize_t put = write(fd, src, n);
+        if (put < 0 && errno == EINTR) { continue; }
+        if (put <= 0) { return -1; }
+        n -= (size_t) put;
+        src += put;
+    }
+    return 0;
+}
+
+static int reply(int fd, const char * status, const char * body, size_t len)
+{
+    char head[48];
+    int headLen = snprintf(head, sizeof(head), "%s %zu\n", status, len);
+    if (writeAll(fd, head, (size_t) headLen)) { return -1; }
+    return writeAll(fd, body, len);
+}
+
+static unsigned long long nowUs(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long) t.tv_sec * 1000000ull + (unsigned long long) t.tv_nsec / 1000;
+}
+
+static void record(serve_t * s, unsigned long long us, int failed)
+{
+    unsigned int k = 0;
+    while (k + 1 < SERVE_BUCKETS && (us >> k)) { k++; }
+    pthread_mutex_lock(&s->lock);
+    s->histogram[k]++;
+    s->requests++;
+    s->errors += failed != 0;
+    s->totalUs += us;
+    if (us > s->maxUs) { s->maxUs = us; }
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void printStats(serve_t * s, FILE * out)
+{
+    pthread_mutex_lock(&s->lock);
+    fprintf(out, "requests %llu, errors %llu, mean %.1f us, max %llu us\n", s->requests, s->errors,
+            s->requests ? (double) s->totalUs / (double) s->requests : 0.0, s->maxUs);
+    for (unsigned int k = 0; k < SERVE_BUCKETS; k++)
+    {
+        if (!s->histogram[k]) { continue; }
+        fprintf(out, "< %llu us: %llu\n", 1ull << k, s->histogram[k]);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+/* Genau eine Anfrage einer Verbindung beantworten
+ *
+ * Anfrage und Antwort haben je einen Puffer des Workers, der wie der
+ * Kontext ueber alle Anfragen erhalten bleibt.
+ *
+ * 0: Verbindung bleibt offen, -1: beendet oder Fehler, schliessen
+ */
+static int serveRequest(worker_t * w, tiling_t * ctx, conn_t * c)
+{
+    serve_t * s = w->s;
+    int fd = c->fd;
+    char kind;
+    unsigned long long n;
+    if (readHeader(c, &kind, &n)) { return -1; }
+    unsigned long long start = nowUs();
+
+    size_t bytes = kind == 'B' ? (size_t) n * sizeof(point_t) : (size_t) n;
+    if ((kind != 'T' && kind != 'B' && kind != 'S') || n >= SERVE_MAX_BYTES) { return -1; }
+    if (bytes > w->capIn)
+    {
+        char * temp = (char *) realloc(w->in, bytes);
+        if (!temp) { return -1; }
+        w->in = temp;
+        w->capIn = bytes;
+    }
+    if (bytes && readExact(c, w->in, bytes)) { return -1; }
+
+    if (kind == 'S')
+    {
+        char text[2048];
+        FILE * mem = fmemopen(text, sizeof(text), "w");
+        if (!mem) { return -1; }
+        printStats(s, mem);
+        long used = ftell(mem);
+        fclose(mem);
+        return reply(fd, "OK", text, (size_t) used);
+    }
+
+    int loaded;
+    if (kind == 'B')
+    {
+        loaded = tilingLoadPoints(ctx, (const point_t *) (void *) w->in, (size_t) n);
+    } else if (!bytes) {
+        loaded = tilingLoadPoints(ctx, NULL, 0);
+    } else {
+        loaded = tilingLoadBuffer(ctx, w->in, bytes, 1);
+    }
+    int result = loaded ? -1 : tilingSolve(ctx);
+    size_t len = 0;
+    if (result >= 0 && formatResult(ctx, result, &w->out, &len, &w->capOut))
+    {
+        ctx->error = TILING_EXCEED_MEM;
+        result = -1;
+    }
+
+    int sent;
+    if (result < 0)
+    {
+        char text[256];
+        FILE * mem = fmemopen(text, sizeof(text), "w");
+        if (!mem) { return -1; }
+        tilingPrintError(ctx, mem);
+        long used = ftell(mem);
+        fclose(mem);
+        tilingClearError(ctx);
+        sent = reply(fd, "ERR", text, (size_t) used);
+    } else {
+        sent = reply(fd, "OK", w->out, len);
+    }
+    record(s, nowUs() - start, result < 0);
+    return sent;
+}
+
+static void closeConn(conn_t * c)
+{
+    close(c->fd);
+    free(c);
+}
+
+static void enqueue(serve_t * s, conn_t * c)
+{
+    s->queue[(s->head + s->waiting) % s->amountQueue] = c;
+    s->waiting++;
+}
+
+static void * worker(void * arg)
+{
+    worker_t * w = (worker_t *) arg;
+    serve_t * s = w->s;
+    tiling_t * ctx = tilingCreate();
+
+    pthread_mutex_lock(&s->lock);
+    while (1)
+    {
+        while (!s->waiting && !s->finished) { pthread_cond_wait(&s->changed, &s->lock); }
+        if (!s->waiting || s->finished) { break; }
+
+        conn_t * c = s->queue[s->head];
+        s->head = (s->head + 1) % s->amountQueue;
+        s->waiting--;
+        s->active[w->id] = c->fd;
+        pthread_mutex_unlock(&s->lock);
+
+        int keep = ctx && !serveRequest(w, ctx, c);
+
+        pthread_mutex_lock(&s->lock);
+        s->active[w->id] = -1;
+        if (keep && !s->finished)
+        {
+            s->returned[s->amountReturned++] = c;
+            ssize_t put = write(s->notify[1], "", 1);     // nicht blockierend, volle Pipe weckt auch
+            (void) put;
+        } else {
+            closeConn(c);
+            s->open--;
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    tilingFree(ctx);
+    free(w->in);
+    free(w->out);
+    return NULL;
+}
+
+void tilingServe(tiling_t * ctx, const char * path, unsigned int threads, int stats)
+{
+    if (!threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned int) online : 1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        ctx->error = TILING_SOCKET;
+        ctx->errData.s = (char *) path;
+        return;
+    }
+    strcpy(addr.sun_path, path);
+
+    // ruhende Verbindungen, nur der Hauptthread
+    conn_t ** idle = NULL;
+    size_t amountIdle = 0;
+    struct pollfd * ready = NULL;
+
+    serve_t s;
+    memset(&s, 0, sizeof(s));
+    s.notify[0] = s.notify[1] = -1;
+    s.amountQueue = (size_t) threads * SERVE_CONNS;
+    s.queue = (conn_t **) calloc(s.amountQueue, sizeof(conn_t *));
+    s.returned = (conn_t **) calloc(s.amountQueue, sizeof(conn_t *));
+    s.active = (int *) calloc(threads, sizeof(int));
+    idle = (conn_t **) calloc(s.amountQueue, sizeof(conn_t *));
+    ready = (struct pollfd *) calloc(s.amountQueue + 3, sizeof(struct pollfd));
+    worker_t * workers = (worker_t *) calloc(threads, sizeof(worker_t));
+    pthread_t * ids = (pthread_t *) calloc(threads, sizeof(pthread_t));
+    if (!s.queue || !s.returned || !s.active || !idle || !ready || !workers || !ids)
+    {
+        ctx->error = TILING_EXCEED_MEM;
+        goto err0;
+    }
+    for (unsigned int t = 0; t < threads; t++) { s.active[t] = -1; }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        ctx->error = TILING_SOCKET;
+        ctx->errData.s = (char *) path;
+        goto err0;
+    }
+    unlink(path);
+    if (bind(listener, (struct sockaddr *) &addr, sizeof(addr)) || listen(listener, 64))
+    {
+        ctx->error = TILING_SOCKET;
+        ctx->errData.s = (char *) path;
+        goto err1;
+    }
+    // nach poll() darf accept() nicht blockieren, falls die Verbindung schon weg ist
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    sigemptyset(&act.sa_mask);
+    if (pipe(wakePipe) || fcntl(wakePipe[1], F_SETFL, O_NONBLOCK) || fcntl(listener, F_SETFL, O_NONBLOCK)
+        || pipe(s.notify) || fcntl(s.notify[0], F_SETFL, O_NONBLOCK) || fcntl(s.notify[1], F_SETFL, O_NONBLOCK))
+    {
+        ctx->error = TILING_SOCKET;
+        ctx->errData.s = (char *) path;
+        goto err2;
+    }
+
+    // ohne SA_RESTART, damit poll() beim Signal zurueckkehrt
+    act.sa_handler = onSignal;
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    act.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &act, NULL);
+
+    // Signale nur im Hauptthread, die Worker erben die Maske
+    sigset_t block;
+    sigset_t old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.changed, NULL);
+    unsigned int started = 0;
+    for (; started < threads; started++)
+    {
+        workers[started].s = &s;
+        workers[started].id = started;
+        if (pthread_create(&ids[started], NULL, worker, &workers[started])) { break; }
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (!started) { ctx->error = TILING_EXCEED_MEM; }
+
+    while (started && !stopServe)
+    {
+        // zurueckgegebene Verbindungen: mit gepufferter Anfrage gleich wieder in die Schlange
+        char drain[64];
+        while (read(s.notify[0], drain, sizeof(drain)) > 0) { }
+        pthread_mutex_lock(&s.lock);
+        for (size_t r = 0; r < s.amountReturned; r++)
+        {
+            conn_t * c = s.returned[r];
+            if (c->pos < c->len)
+            {
+                enqueue(&s, c);
+            } else {
+                idle[amountIdle++] = c;
+            }
+        }
+        if (s.amountReturned) { pthread_cond_broadcast(&s.changed); }
+        s.amountReturned = 0;
+        int accepting = s.open < s.amountQueue;
+        pthread_mutex_unlock(&s.lock);
+
+        ready[0].fd = wakePipe[0];
+        ready[1].fd = s.notify[0];
+        ready[2].fd = accepting ? listener : -1;       // negativ: poll() uebergeht den Eintrag
+        for (size_t i = 0; i < amountIdle; i++) { ready[3 + i].fd = idle[i]->fd; }
+        for (size_t i = 0; i < 3 + amountIdle; i++)
+        {
+            ready[i].events = POLLIN;
+            ready[i].revents = 0;
+        }
+        if (poll(ready, (nfds_t) (3 + amountIdle), -1) < 0 && errno != EINTR)
+        {
+            ctx->error = TILING_SOCKET;
+            ctx->errData.s = (char *) path;
+            break;
+        }
+        if (stopServe || ready[0].revents) { break; }
+
+        // lesbare (oder geschlossene) ruhende Verbindungen an die Worker
+        pthread_mutex_lock(&s.lock);
+        int handed = 0;
+        for (size_t i = amountIdle; i-- > 0; )
+        {
+            if (!ready[3 + i].revents) { continue; }
+            enqueue(&s, idle[i]);
+            idle[i] = idle[--amountIdle];
+            handed = 1;
+        }
+        if (handed) { pthread_cond_broadcast(&s.changed); }
+        pthread_mutex_unlock(&s.lock);
+
+        if (!(ready[2].revents & POLLIN)) { continue; }
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN || errno == EWOULDBLOCK) { continue; }
+            ctx->error = TILING_SOCKET;
+            ctx->errData.s = (char *) path;
+            break;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);     // Worker lesen blockierend
+        struct timeval timeout = { SERVE_TIMEOUT, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        conn_t * c = (conn_t *) malloc(sizeof(conn_t));
+        if (!c)
+        {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->pos = 0;
+        c->len = 0;
+        idle[amountIdle++] = c;
+        pthread_mutex_lock(&s.lock);
+        s.open++;
+        pthread_mutex_unlock(&s.lock);
+    }
+
+    // wartende und ruhende Verbindungen verwerfen, laufende beim naechsten Lesen beenden
+    pthread_mutex_lock(&s.lock);
+    s.finished = 1;
+    for (unsigned int t = 0; t < started; t++)
+    {
+        if (s.active[t] >= 0) { shutdown(s.active[t], SHUT_RDWR); }
+    }
+    pthread_cond_broadcast(&s.changed);
+    pthread_mutex_unlock(&s.lock);
+    for (unsigned int t = 0; t < started; t++) { pthread_join(ids[t], NULL); }
+    for (; s.waiting; s.waiting--)
+    {
+        closeConn(s.queue[s.head]);
+        s.head = (s.head + 1) % s.amountQueue;
+    }
+    for (size_t r = 0; r < s.amountReturned; r++) { closeConn(s.returned[r]); }
+    for (size_t i = 0; i < amountIdle; i++) { closeConn(idle[i]); }
+
+    if (stats) { printStats(&s, stderr); }
+    pthread_cond_destroy(&s.changed);
+    pthread_mutex_destroy(&s.lock);
+
+err2:
+    // erst den Handler entfernen, dann die Pipes schliessen
+    act.sa_handler = SIG_DFL;
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    for (int e = 0; e < 2; e++)
+    {
+        if (wakePipe[e] >= 0) { close(wakePipe[e]); }
+        if (s.notify[e] >= 0) { close(s.notify[e]); }
+        wakePipe[e] = -1;
+    }
+err1:
+    close(listener);
+    unlink(path);
+err0:
+    free(s.queue);
+    free(s.returned);
+    free(s.active);
+    free(idle);
+    free(ready);
+    free(workers);
+    free(ids);
+    return;
+}
@@ -0,0 +1,411 @@
+/* Entpacken komprimierter Eingaben (gzip, zstd)
+ *
+ * tilingLoadParallel() (parse.c) erkennt die Kennung am Anfang der Eingabe
+ * (gzip 1f 8b, zstd 28 b5 2f fd) und gibt hierher ab. Ein eigener Thread
+ * liest die Eingabe und entpackt sie in einen Ring von bis zu
+ * DECOMPRESS_SLOTS Bloecken; der aufrufende Thread zerlegt jeden vollen
+ * Block mit parseAppend(), waehrend schon der naechste entpackt wird. Der
+ * Entpacker wartet, solange alle Bloecke belegt sind.
+ *
+ * Ohne Budget hat der Ring 4 Bloecke zu 4 MiB. Mit Budget belegt er
+ * hoechstens ein DECOMPRESS_SHARE-tel des noch freien Budgets: erst werden
+ * die Bloecke bis DECOMPRESS_MIN_BLOCK kleiner, dann bleiben 2 Bloecke.
+ * Die Groesse steht in ctx->ringSlots und ctx->ringBlock, tilingPrintPlan()
+ * meldet sie.
+ *
+ * Geparst wird immer bis zum letzten '\n' eines Blocks, der Rest wandert
+ * in einen Uebertrag und wird mit dem Anfang des naechsten Blocks bis zu
+ * dessen erstem '\n' zusammengesetzt. So liegt keine Zeile in zwei
+ * Stuecken, Zeilennummern und Fehler sind die von tilingLoad(); am Ende
+ * der Eingabe wird der Uebertrag wie die letzte Zeile ohne '\n' gelesen.
+ *
+ * Mehrere gzip-Member bzw. zstd-Frames hintereinander werden wie von zcat
+ * aneinandergehaengt. Ein kaputter oder abgeschnittener Strom meldet
+ * TILING_CORRUPT, ausser die Zeilen davor enthalten schon einen Fehler.
+ * Welche Formate es gibt, entscheidet der Build (TILING_ZLIB, TILING_ZSTD
+ * im Makefile); fehlt eines, meldet die Eingabe TILING_NO_CODEC.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef TILING_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TILING_ZSTD
+#include <zstd.h>
+#endif
+
+#include "loesung.h"
+
+#define CODEC_MAGIC 4                   // laengste Kennung
+#define DECOMPRESS_SLOTS 4
+#define DECOMPRESS_MIN_SLOTS 2
+#define DECOMPRESS_BLOCK (4 << 20)      // entpackte Bytes je Block
+#define DECOMPRESS_MIN_BLOCK (1 << 16)
+#define DECOMPRESS_READ (1 << 18)       // komprimierte Bytes je fread(), hoechstens ein Block
+#define DECOMPRESS_SHARE 4
+
+typedef struct ring_s{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+
+    char * slots[DECOMPRESS_SLOTS];
+    size_t len[DECOMPRESS_SLOTS];
+    size_t amountSlots;     // benutzte Bloecke, aus dem Budget
+    size_t block;           // Bytes je Block
+    size_t read;            // Bytes je fread()
+    size_t produced;        // gefuellte Bloecke
+    size_t consumed;        // zerlegte Bloecke
+    int finished;           // Entpacker fertig
+    int stopped;            // Parser hat aufgegeben
+
+    FILE * in;
+    const char * head;      // schon gelesener Anfang der Eingabe
+    size_t headLen;
+    unsigned char * input;  // read Bytes
+    codec_t codec;
+    tilingErr_t error;      // TILING_CORRUPT oder TILING_EXCEED_MEM
+} ring_t;
+
+codec_t detectCodec(const unsigned char * head, size_t len)
+{
+    if (len >= 2 && head[0] == 0x1f && head[1] == 0x8b) { return CODEC_GZIP; }
+    if (len >= 4 && head[0] == 0x28 && head[1] == 0xb5 && head[2] == 0x2f && head[3] == 0xfd) { return CODEC_ZSTD; }
+    return CODEC_NONE;
+}
+
+/* Kennung einer Datei ab der aktuellen Position, ohne sie zu verschieben
+ */
+codec_t fileCodec(int fd)
+{
+    unsigned char magic[CODEC_MAGIC];
+    off_t at = lseek(fd, 0, SEEK_CUR);
+    ssize_t got = at >= 0 ? pread(fd, magic, sizeof(magic), at) : -1;
+    return detectCodec(magic, got > 0 ? (size_t) got : 0);
+}
+
+#if defined(TILING_ZLIB) || defined(TILING_ZSTD)
+/* Naechster leerer Block fuer den Entpacker, NULL falls der Parser aufgegeben hat
+ */
+static char * acquire(ring_t * ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    while (ring->produced - ring->consumed == ring->amountSlots && !ring->stopped)
+    {
+        pthread_cond_wait(&ring->changed, &ring->lock);
+    }
+    char * slot = ring->stopped ? NULL : ring->slots[ring->produced % ring->amountSlots];
+    pthread_mutex_unlock(&ring->lock);
+    return slot;
+}
+
+static void publish(ring_t * ring, size_t len)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->len[ring->produced % ring->amountSlots] = len;
+    ring->produced++;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/* Komprimierte Bytes: zuerst der schon gelesene Anfang, dann die Eingabe
+ */
+static size_t input(ring_t * ring, const unsigned char ** at)
+{
+    if (ring->headLen)
+    {
+        size_t len = ring->headLen;
+        *at = (const unsigned char *) ring->head;
+        ring->headLen = 0;
+        return len;
+    }
+    *at = ring->input;
+    return fread(ring->input, 1, ring->read, ring->in);
+}
+#endif
+
+/* Naechster volle Block fuer den Parser, NULL am Ende
+ */
+static const char * take(ring_t * ring, size_t * len)
+{
+    pthread_mutex_lock(&ring->lock);
+    while (ring->consumed == ring->produced && !ring->finished) { pthread_cond_wait(&ring->changed, &ring->lock); }
+    const char * slot = NULL;
+    if (ring->consumed != ring->produced)
+    {
+        slot = ring->slots[ring->consumed % ring->amountSlots];
+        *len = ring->len[ring->consumed % ring->amountSlots];
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return slot;
+}
+
+static void release(ring_t * ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->consumed++;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+#ifdef TILING_ZLIB
+static tilingErr_t inflateAll(ring_t * ring)
+{
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (inflateInit2(&z, 15 + 32) != Z_OK) { return TILING_EXCEED_MEM; }   // +32: gzip-Kopf
+
+    tilingErr_t error = TILING_OK;
+    char * out = acquire(ring);
+    size_t used = 0;
+    int ended = 0;          // letzter Member vollstaendig
+    int full = 0;           // letzter Aufruf hat den Block gefuellt, es kann noch Ausgabe anstehen
+    while (out)
+    {
+        if (!z.avail_in && !full)
+        {
+            const unsigned char * at;
+            size_t got = input(ring, &at);
+            if (!got) { break; }
+            z.next_in = (unsigned char *) at;
+            z.avail_in = (uInt) got;
+        }
+        if (z.avail_in) { ended = 0; }
+        z.next_out = (unsigned char *) out + used;
+        z.avail_out = (uInt) (ring->block - used);
+        int status = inflate(&z, Z_NO_FLUSH);
+        used = ring->block - z.avail_out;
+        full = !z.avail_out;
+        if (status == Z_STREAM_END)
+        {
+            ended = 1;
+            inflateReset(&z);       // weiterer Member wie bei zcat
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            error = status == Z_MEM_ERROR ? TILING_EXCEED_MEM : TILING_CORRUPT;
+            goto end;
+        }
+        if (full)
+        {
+            publish(ring, used);
+            out = acquire(ring);
+            used = 0;
+        }
+    }
+    if (!out) { goto end; }
+    if (!ended || ferror(ring->in)) { error = TILING_CORRUPT; goto end; }
+    if (used) { publish(ring, used); }
+
+end:
+    inflateEnd(&z);
+    return error;
+}
+#endif
+
+#ifdef TILING_ZSTD
+static tilingErr_t decompressAll(ring_t * ring)
+{
+    ZSTD_DStream * stream = ZSTD_createDStream();
+    if (!stream) { return TILING_EXCEED_MEM; }
+    ZSTD_initDStream(stream);
+
+    tilingErr_t error = TILING_OK;
+    ZSTD_inBuffer in = { NULL, 0, 0 };
+    char * out = acquire(ring);
+    size_t used = 0;
+    int ended = 0;          // letzter Frame vollstaendig und ausgegeben
+    int full = 0;
+    while (out)
+    {
+        if (in.pos == in.size && !full)
+        {
+            const unsigned char * at;
+            size_t got = input(ring, &at);
+            if (!got) { break; }
+            in.src = at;
+            in.size = got;
+            in.pos = 0;
+        }
+        ZSTD_outBuffer block = { out, ring->block, used };
+        size_t status = ZSTD_decompressStream(stream, &block, &in);
+        if (ZSTD_isError(status)) { error = TILING_CORRUPT; goto end; }
+        used = block.pos;
+        ended = !status;
+        full = used == ring->block;
+        if (full)
+        {
+            publish(ring, used);
+            out = acquire(ring);
+            used = 0;
+        }
+    }
+    if (!out) { goto end; }
+    if (!ended || ferror(ring->in)) { error = TILING_CORRUPT; goto end; }
+    if (used) { publish(ring, used); }
+
+end:
+    ZSTD_freeDStream(stream);
+    return error;
+}
+#endif
+
+static void * decompressThread(void * arg)
+{
+    ring_t * ring = (ring_t *) arg;
+    tilingErr_t error = TILING_CORRUPT;
+#ifdef TILING_ZLIB
+    if (ring->codec == CODEC_GZIP) { error = inflateAll(ring); }
+#endif
+#ifdef TILING_ZSTD
+    if (ring->codec == CODEC_ZSTD) { error = decompressAll(ring); }
+#endif
+    pthread_mutex_lock(&ring->lock);
+    ring->error = error;
+    ring->finished = 1;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+    return NULL;
+}
+
+static int supported(codec_t codec)
+{
+#ifdef TILING_ZLIB
+    if (codec == CODEC_GZIP) { return 1; }
+#endif
+#ifdef TILING_ZSTD
+    if (codec == CODEC_ZSTD) { return 1; }
+#endif
+    (void) codec;
+    return 0;
+}
+
+/* Bytes an den Uebertrag haengen
+ */
+static int carryAppend(tiling_t * ctx, char ** carry, size_t * len, size_t * cap, const char * text, size_t bytes)
+{
+    if (*cap - *len < bytes)
+    {
+        size_t grow = *cap ? *cap : 4096;
+        while (grow - *len < bytes) { grow *= 2; }
+        char * temp = (char *) memRealloc(ctx, *carry, grow);
+        if (!temp)
+        {
+            ctx->error = TILING_EXCEED_MEM;
+            return -1;
+        }
+        *carry = temp;
+        *cap = grow;
+    }
+    memcpy(*carry + *len, text, bytes);
+    *len += bytes;
+    return 0;
+}
+
+int loadCompressed(tiling_t * ctx, FILE * in, const char * head, size_t headLen, codec_t codec, unsigned int threads)
+{
+    tilingLoadPoints(ctx, NULL, 0);     // vorige Instanz verwerfen
+    if (!supported(codec))
+    {
+        ctx->error = TILING_NO_CODEC;
+        ctx->errData.s = (char *) (codec == CODEC_GZIP ? "gzip" : "zstd");
+        return -1;
+    }
+
+    ring_t ring;
+    memset(&ring, 0, sizeof(ring));
+    ring.in = in;
+    ring.head = head;
+    ring.headLen = headLen;
+    ring.codec = codec;
+
+    // Ring nach dem freien Budget: erst kleinere Bloecke, dann weniger
+    ring.amountSlots = DECOMPRESS_SLOTS;
+    ring.block = DECOMPRESS_BLOCK;
+    while (ring.block > DECOMPRESS_MIN_BLOCK && !memFits(ctx, DECOMPRESS_SHARE * ring.amountSlots * ring.block)) { ring.block /= 2; }
+    if (!memFits(ctx, DECOMPRESS_SHARE * ring.amountSlots * ring.block)) { ring.amountSlots = DECOMPRESS_MIN_SLOTS; }
+    ring.read = ring.block < DECOMPRESS_READ ? ring.block : DECOMPRESS_READ;
+    ctx->ringSlots = ring.amountSlots;
+    ctx->ringBlock = ring.block;
+
+    ring.input = (unsigned char *) memAlloc(ctx, ring.read);
+    if (!ring.input) { goto mem; }
+    for (size_t s = 0; s < ring.amountSlots; s++)
+    {
+        ring.slots[s] = (char *) memAlloc(ctx, ring.block);
+        if (!ring.slots[s]) { goto mem; }
+    }
+    pthread_mutex_init(&ring.lock, NULL);
+    pthread_cond_init(&ring.changed, NULL);
+    pthread_t id;
+    if (pthread_create(&id, NULL, decompressThread, &ring))
+    {
+        pthread_mutex_destroy(&ring.lock);
+        pthread_cond_destroy(&ring.changed);
+        goto mem;
+    }
+
+    char * carry = NULL;
+    size_t carryLen = 0;
+    size_t carryCap = 0;
+    size_t lines = 0;
+    int status = 0;
+    const char * text;
+    size_t len;
+    while (!status && (text = take(&ring, &len)))
+    {
+        const char * end = text + len;
+        const char * first = memchr(text, '\n', len);
+        const char * last = first;
+        if (first)
+        {
+            for (last = end - 1; *last != '\n'; last--) { }
+        }
+
+        if (!first)
+        {
+            status = carryAppend(ctx, &carry, &carryLen, &carryCap, text, len);
+        } else {
+            // Uebertrag bis zum ersten '\n', dann alle ganzen Zeilen im Block
+            if (carryLen)
+            {
+                status = carryAppend(ctx, &carry, &carryLen, &carryCap, text, (size_t) (first + 1 - text));
+                if (!status) { status = parseAppend(ctx, carry, carryLen, 1, &lines); }
+                carryLen = 0;
+                text = first + 1;
+            }
+            if (!status && text <= last) { status = parseAppend(ctx, text, (size_t) (last + 1 - text), threads, &lines); }
+            if (!status) { status = carryAppend(ctx, &carry, &carryLen, &carryCap, last + 1, (size_t) (end - last - 1)); }
+        }
+        release(&ring);
+    }
+
+    // bei einem Fehler im Text den Entpacker anhalten
+    pthread_mutex_lock(&ring.lock);
+    ring.stopped = 1;
+    pthread_cond_broadcast(&ring.changed);
+    pthread_mutex_unlock(&ring.lock);
+    pthread_join(id, NULL);
+    pthread_mutex_destroy(&ring.lock);
+    pthread_cond_destroy(&ring.changed);
+
+    if (!status && ring.error)
+    {
+        ctx->error = ring.error;
+        status = -1;
+    }
+    if (!status && carryLen) { status = parseAppend(ctx, carry, carryLen, 1, &lines); }    // letzte Zeile ohne '\n'
+    memFree(ctx, carry);
+    for (size_t s = 0; s < ring.amountSlots; s++) { memFree(ctx, ring.slots[s]); }
+    memFree(ctx, ring.input);
+    return status;
+
+mem:
+    for (size_t s = 0; s < ring.amountSlots; s++) { memFree(ctx, ring.slots[s]); }
+    memFree(ctx, ring.input);
+    ctx->error = TILING_EXCEED_MEM;
+    return -1;
+}
@@ -0,0 +1,458 @@
+/* Externes Einlesen fuer Eingaben, die nicht in den Hauptspeicher passen
+ *
+ * Phase 1: die Eingabe wird in Laeufe zu je runSize Kacheln geteilt. Jeder
+ * Lauf wird im Speicher nach dem Schluessel (x << 32 | y) radix-sortiert,
+ * auf doppelte Kacheln geprueft und hinten an eine gemeinsame temporaere
+ * Datei geschrieben. Der letzte Lauf bleibt im Speicher.
+ *
+ * Phase 2: k-Wege-Mischen ueber einen Heap, hoechstens EXTERNAL_FANIN Laeufe
+ * auf einmal. Gibt es mehr, werden je EXTERNAL_FANIN Laeufe in Durchgaengen
+ * zu laengeren Laeufen in einer neuen temporaeren Datei gemischt. Die Laeufe
+ * werden ueber ihren Offset per pread() gelesen, offen sind also nie mehr
+ * als drei Dateien, egal wie viele Laeufe es gibt. Der letzte Durchgang
+ * mischt direkt in eine temporaere Datei aus tile_t, die per mmap
+ * eingeblendet ist. Doppelte Kacheln zwischen den Laeufen fallen beim
+ * Mischen auf. Das Kachelfeld ist danach schon sortiert
+ * (sort() entfaellt) und liegt in einer Datei, so dass das Betriebssystem
+ * es waehrend linkTiles() und findCoverage() auslagern kann.
+ *
+ * Temporaere Dateien liegen in $TMPDIR (sonst /tmp) und werden gleich nach
+ * dem Anlegen wieder entfernt.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "loesung.h"
+
+#define EXTERNAL_BUFFER (1 << 16)   // Schluessel je Lesepuffer eines Laufs, hoechstens
+#define EXTERNAL_MIN_BUFFER (1 << 9)    // ... und mindestens
+#define EXTERNAL_FANIN 64           // Laeufe je Mischvorgang
+
+typedef struct run_s{
+    unsigned long long offset;  // naechster Schluessel in der Datei
+    size_t left;        // noch nicht gelesene Schluessel in der Datei
+    uint64_t * buf;
+    size_t len;
+    size_t pos;
+    int memory;         // 1: Lauf liegt ganz im Speicher (buf gehoert ihm)
+} run_t;
+
+/* Lese- und Schreibfehler mit Ursache (TILING_IO)
+ */
+static void ioError(tiling_t * ctx, int code)
+{
+    ctx->error = TILING_IO;
+    ctx->errData.s = strerror(code ? code : EIO);
+}
+
+static int openTemp(tiling_t * ctx)
+{
+    const char * dir = getenv("TMPDIR");
+    if (!dir || !*dir) { dir = "/tmp"; }
+
+    char * path = (char *) malloc(strlen(dir) + sizeof("/loesungXXXXXX"));
+    if (!path) { ctx->error = TILING_EXCEED_MEM; return -1; }
+    strcpy(path, dir);
+    strcat(path, "/loesungXXXXXX");
+
+    int fd = mkstemp(path);
+    if (fd >= 0)
+    {
+        unlink(path);
+    } else if (errno == EMFILE || errno == ENFILE) {
+        // zu viele offene Dateien liegt nicht am Verzeichnis
+        ioError(ctx, errno);
+    } else {
+        ctx->error = TILING_TEMP_FILE;
+        ctx->errData.s = (char *) dir;
+    }
+    free(path);
+    return fd;
+}
+
+/* temporaere Datei zum Schreiben der Laeufe, gelesen wird per pread()
+ */
+static FILE * openRuns(tiling_t * ctx)
+{
+    int fd = openTemp(ctx);
+    if (fd < 0) { return NULL; }
+    FILE * f = fdopen(fd, "w+b");
+    if (!f)
+    {
+        ioError(ctx, errno);
+        close(fd);
+    }
+    return f;
+}
+
+/* LSD Radixsort in Bytes, Stellen mit nur einem Wert werden uebersprungen
+ *
+ * gibt keys oder temp zurueck, je nachdem wo das Ergebnis liegt
+ */
+static uint64_t * radixSort(uint64_t * keys, uint64_t * temp, size_t n)
+{
+    size_t count[8][256];
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < n; i++)
+    {
+        for (unsigned int d = 0; d < 8; d++) { count[d][(keys[i] >> (8*d)) & 0xff]++; }
+    }
+
+    for (unsigned int d = 0; d < 8; d++)
+    {
+        if (count[d][(keys[0] >> (8*d)) & 0xff] == n) { continue; }
+
+        size_t sum = 0;
+        for (unsigned int b = 0; b < 256; b++)
+        {
+            size_t c = count[d][b];
+            count[d][b] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) { temp[count[d][(keys[i] >> (8*d)) & 0xff]++] = keys[i]; }
+
+        uint64_t * swap = keys;
+        keys = temp;
+        temp = swap;
+    }
+    return keys;
+}
+
+static int refill(tiling_t * ctx, int fd, run_t * run, size_t bufferKeys, unsigned long long * bytesRead)
+{
+    size_t want = run->left < bufferKeys ? run->left : bufferKeys;
+    char * to = (char *) run->buf;
+    size_t bytes = want * sizeof(uint64_t);
+    while (bytes)
+    {
+        ssize_t got = pread(fd, to, bytes, (off_t) run->offset);
+        if (got <= 0)
+        {
+            // 0: Datei kuerzer als geschrieben
+            ioError(ctx, got < 0 ? errno : EIO);
+            return -1;
+        }
+        to += got;
+        bytes -= (size_t) got;
+        run->offset += (unsigned long long) got;
+    }
+    *bytesRead += want * sizeof(uint64_t);
+    run->len = want;
+    run->pos = 0;
+    run->left -= want;
+    return 0;
+}
+
+static void siftDown(run_t ** heap, size_t len, size_t i)
+{
+    while (1)
+    {
+        size_t min = i;
+        size_t l = 2*i + 1;
+        size_t r = l + 1;
+        if (l < len && heap[l]->buf[heap[l]->pos] < heap[min]->buf[heap[min]->pos]) { min = l; }
+        if (r < len && heap[r]->buf[heap[r]->pos] < heap[min]->buf[heap[min]->pos]) { min = r; }
+        if (min == i) { return; }
+        run_t * swap = heap[i];
+        heap[i] = heap[min];
+        heap[min] = swap;
+        i = min;
+    }
+}
+
+/* Mischpuffer: ein Lesepuffer je Lauf eines Mischvorgangs, dazu der Heap
+ */
+typedef struct merge_s{
+    int fd;                     // Datei der Laeufe
+    uint64_t * buffers;         // je gleichzeitig gemischtem Lauf bufferKeys
+    size_t bufferKeys;
+    run_t * heap[EXTERNAL_FANIN];
+    unsigned long long bytesRead;
+    unsigned long long bytesWritten;
+} merge_t;
+
+/* amount (hoechstens EXTERNAL_FANIN) Laeufe mischen, entweder als Schluessel
+ * an out anhaengen oder als Kacheln nach tiles schreiben
+ *
+ * 0: gemischt, -1: Fehler (doppelte Kachel, Lesen, Schreiben)
+ */
+static int mergeRuns(tiling_t * ctx, merge_t * m, run_t * runs, size_t amount, FILE * out, tile_t * tiles)
+{
+    size_t heapLen = 0;
+    for (size_t r = 0; r < amount; r++)
+    {
+        if (!runs[r].memory)
+        {
+            runs[r].buf = m->buffers + r * m->bufferKeys;
+            if (refill(ctx, m->fd, &runs[r], m->bufferKeys, &m->bytesRead)) { return -1; }
+        }
+        if (runs[r].len) { m->heap[heapLen++] = &runs[r]; }
+    }
+    for (size_t r = heapLen / 2; r-- > 0; ) { siftDown(m->heap, heapLen, r); }
+
+    uint64_t last = 0;
+    size_t i = 0;
+    while (heapLen)
+    {
+        run_t * run = m->heap[0];
+        uint64_t key = run->buf[run->pos++];
+        if (i && last == key) { ctx->error = TILING_DOUBLE_LINE; return -1; }
+        last = key;
+
+        if (tiles)
+        {
+            tile_t * tile = &tiles[i];
+            tile->p.x = (unsigned int) (key >> 32);
+            tile->p.y = (unsigned int) key;
+            tile->parent = NULL;
+            tile->edge = NULL;
+            tile->north = NULL;
+            tile->west = NULL;
+            tile->south = NULL;
+            tile->east = NULL;
+            ctx->allTiles.amount = i + 1;
+        } else if (fwrite(&key, sizeof(uint64_t), 1, out) != 1) {
+            ioError(ctx, errno);
+            return -1;
+        }
+        i++;
+
+        if (run->pos == run->len)
+        {
+            if (run->left)
+            {
+                if (refill(ctx, m->fd, run, m->bufferKeys, &m->bytesRead)) { return -1; }
+            } else {
+                m->heap[0] = m->heap[--heapLen];
+            }
+        }
+        siftDown(m->heap, heapLen, 0);
+    }
+    if (!tiles) { m->bytesWritten += i * sizeof(uint64_t); }
+    return 0;
+}
+
+/* Schluessel je Lesepuffer beim Mischen von runs Laeufen; mit Budget teilen
+ * sich die Puffer der gleichzeitig gemischten Laeufe ein Viertel davon
+ */
+static size_t bufferKeys(const tiling_t * ctx, size_t runs)
+{
+    size_t fanin = runs < EXTERNAL_FANIN ? runs : EXTERNAL_FANIN;
+    if (!ctx->mem.budget || !fanin) { return EXTERNAL_BUFFER; }
+    size_t keys = ctx->mem.budget / 4 / fanin / sizeof(uint64_t);
+    if (keys > EXTERNAL_BUFFER) { return EXTERNAL_BUFFER; }
+    return keys < EXTERNAL_MIN_BUFFER ? EXTERNAL_MIN_BUFFER : keys;
+}
+
+size_t externalBytes(const tiling_t * ctx, size_t tiles, size_t runSize)
+{
+    if (runSize < 2) { runSize = 2; }
+    size_t runs = tiles / runSize + (tiles % runSize != 0);
+    size_t fanin = runs < EXTERNAL_FANIN ? runs : EXTERNAL_FANIN;
+    // Liste der Laeufe (verdoppelt beim Wachsen), Lesepuffer, letzter Lauf im Speicher
+    return 2 * runs * sizeof(run_t) + fanin * bufferKeys(ctx, runs) * sizeof(uint64_t)
+        + runSize * sizeof(uint64_t);
+}
+
+void tilingLoadExternal(tiling_t * ctx, FILE * in, size_t runSize, int stats)
+{
+    // das eingeblendete Feld ersetzt den Kachelpuffer des Kontexts
+    tilingPhase(ctx, PHASE_PARSE);
+    allTiles_t * allTiles = &ctx->allTiles;
+    if (ctx->mapFd >= 0)
+    {
+        releaseExternal(ctx);
+    } else {
+        memFree(ctx, allTiles->tiles);
+        allTiles->tiles = NULL;
+        ctx->capTiles = 0;
+    }
+    allTiles->amount = 0;
+    ctx->sorted = 0;
+    ctx->tileable = 0;
+    ctx->cursor = 0;
+    ctx->error = TILING_OK;
+    if (runSize < 2) { runSize = 2; }
+
+    merge_t m;
+    m.fd = -1;
+    m.buffers = NULL;
+    m.bufferKeys = 0;
+    m.bytesRead = 0;
+    m.bytesWritten = 0;
+
+    uint64_t * keys = (uint64_t *) memAlloc(ctx, runSize * sizeof(uint64_t));
+    uint64_t * temp = (uint64_t *) memAlloc(ctx, runSize * sizeof(uint64_t));
+    FILE * file = NULL;         // Laeufe des aktuellen Durchgangs
+    FILE * next = NULL;         // Laeufe des naechsten Durchgangs
+    run_t * runs = NULL;
+    size_t amountRuns = 0;
+    size_t capRuns = 0;
+    size_t total = 0;
+    unsigned int passes = 0;
+    if (!keys || !temp) { goto mem; }
+
+    // Phase 1: sortierte Laeufe
+    input_t input;
+    input.in = in;
+    input.line = 0;
+    input.offset = 0;
+    int status = 1;
+    while (status > 0)
+    {
+        size_t n = 0;
+        point_t p;
+        while (n < runSize && (status = readLine(ctx, &input, &p)) > 0)
+        {
+            keys[n++] = (uint64_t) p.x << 32 | p.y;
+        }
+        if (status < 0) { goto end; }
+        if (!n) { break; }
+
+        uint64_t * sorted = radixSort(keys, temp, n);
+        for (size_t i = 1; i < n; i++)
+        {
+            if (sorted[i-1] == sorted[i]) { ctx->error = TILING_DOUBLE_LINE; goto end; }
+        }
+
+        if (amountRuns == capRuns)
+        {
+            capRuns = capRuns ? capRuns * 2 : 8;
+            run_t * tempRuns = (run_t *) memRealloc(ctx, runs, capRuns * sizeof(run_t));
+            if (!tempRuns) { goto mem; }
+            runs = tempRuns;
+        }
+        run_t * run = &runs[amountRuns++];
+        run->offset = m.bytesWritten;
+        run->left = 0;
+        run->buf = NULL;
+        run->len = n;
+        run->pos = 0;
+        run->memory = 0;
+        total += n;
+
+        if (status == 0)
+        {
+            // letzter Lauf bleibt im Speicher
+            run->buf = sorted;
+            run->memory = 1;
+            if (sorted == temp) { temp = keys; }
+            keys = NULL;
+            break;
+        }
+
+        if (!file && !(file = openRuns(ctx))) { goto end; }
+        if (fwrite(sorted, sizeof(uint64_t), n, file) != n)
+        {
+            ioError(ctx, errno);
+            goto end;
+        }
+        m.bytesWritten += n * sizeof(uint64_t);
+        run->left = n;
+        run->len = 0;
+    }
+    memFree(ctx, temp);
+    temp = NULL;
+    memFree(ctx, keys);
+    keys = NULL;
+
+    if (!total) { goto end; }
+    size_t sortedRuns = amountRuns;
+    if (file && fflush(file)) { ioError(ctx, errno); goto end; }
+
+    // Phase 2: Durchgaenge mit hoechstens EXTERNAL_FANIN Laeufen je Mischvorgang
+    size_t fanin = amountRuns < EXTERNAL_FANIN ? amountRuns : EXTERNAL_FANIN;
+    m.bufferKeys = bufferKeys(ctx, amountRuns);
+    m.buffers = (uint64_t *) memAlloc(ctx, fanin * m.bufferKeys * sizeof(uint64_t));
+    if (!m.buffers) { goto mem; }
+    while (amountRuns > EXTERNAL_FANIN)
+    {
+        if (!(next = openRuns(ctx))) { goto end; }
+        m.fd = fileno(file);
+        size_t merged = 0;
+        unsigned long long offset = 0;
+        for (size_t r = 0; r < amountRuns; r += EXTERNAL_FANIN)
+        {
+            size_t amount = amountRuns - r < EXTERNAL_FANIN ? amountRuns - r : EXTERNAL_FANIN;
+            size_t length = 0;
+            for (size_t k = 0; k < amount; k++) { length += runs[r+k].left + runs[r+k].len; }
+            if (mergeRuns(ctx, &m, &runs[r], amount, next, NULL)) { goto end; }
+            if (runs[r + amount - 1].memory)
+            {
+                memFree(ctx, runs[r + amount - 1].buf);
+                runs[r + amount - 1].buf = NULL;
+            }
+
+            // gemischter Lauf ersetzt die Gruppe (merged <= r)
+            run_t * run = &runs[merged++];
+            run->offset = offset;
+            run->left = length;
+            run->buf = NULL;
+            run->len = 0;
+            run->pos = 0;
+            run->memory = 0;
+            offset += length * sizeof(uint64_t);
+        }
+        if (fflush(next)) { ioError(ctx, errno); goto end; }
+        fclose(file);
+        file = next;
+        next = NULL;
+        amountRuns = merged;
+        passes++;
+    }
+    m.fd = file ? fileno(file) : -1;
+
+    // letzter Mischvorgang in das eingeblendete Kachelfeld
+    ctx->mapFd = openTemp(ctx);
+    if (ctx->mapFd < 0) { goto end; }
+    ctx->mapBytes = total * sizeof(tile_t);
+    if (ftruncate(ctx->mapFd, (off_t) ctx->mapBytes)) { ioError(ctx, errno); goto end; }
+    void * map = mmap(NULL, ctx->mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, ctx->mapFd, 0);
+    if (map == MAP_FAILED) { ioError(ctx, errno); goto end; }
+    allTiles->tiles = (tile_t *) map;
+    if (mergeRuns(ctx, &m, runs, amountRuns, NULL, allTiles->tiles)) { goto end; }
+
+    if (stats)
+    {
+        fprintf(stderr, "external: %zu runs, %zu tiles, %u intermediate passes (fan-in %d)\n",
+            sortedRuns, total, passes, EXTERNAL_FANIN);
+        fprintf(stderr, "external: %llu bytes written, %llu bytes read, %zu bytes mapped\n",
+            m.bytesWritten, m.bytesRead, ctx->mapBytes);
+    }
+    ctx->sorted = 1;
+    goto end;
+
+mem:
+    ctx->error = TILING_EXCEED_MEM;
+end:
+    for (size_t r = 0; r < amountRuns; r++)
+    {
+        if (runs[r].memory) { memFree(ctx, runs[r].buf); }
+    }
+    if (next) { fclose(next); }
+    if (file) { fclose(file); }
+    memFree(ctx, m.buffers);
+    memFree(ctx, runs);
+    memFree(ctx, temp);
+    memFree(ctx, keys);
+    return;
+}
+
+void releaseExternal(tiling_t * ctx)
+{
+    if (ctx->allTiles.tiles) { munmap(ctx->allTiles.tiles, ctx->mapBytes); }
+    if (ctx->mapFd >= 0) { close(ctx->mapFd); }
+    ctx->allTiles.tiles = NULL;
+    ctx->allTiles.amount = 0;
+    ctx->capTiles = 0;
+    ctx->mapFd = -1;
+    ctx->mapBytes = 0;
+    return;
+}
@@ -1,10 +1,13 @@
 // Functions that allocate memory and that throw an error, release that memory themselves.
 
+#define _POSIX_C_SOURCE 200809L // getc_unlocked
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include <limits.h>
+#include <stdint.h>
 
 size_t max_path_size = 0;
 
@@ -12,63 +15,115 @@ size_t max_path_size = 0;
 
 typedef char * error_msg;
 
-typedef unsigned int coordinate; // changing this requires to change the print_tile function!
-
-typedef struct tile {
-    coordinate x;
-    coordinate y;
-
-    struct tile * top_tile;
-    struct tile * bot_tile;
-    struct tile * right_tile;
-    struct tile * left_tile;
-
-    struct tile * matched_with;
+typedef unsigned int coordinate; // width of the input; the solver works on narrower copies
 
-    struct tile * visited_by;
-} tile_t;
+#define MAX_DIMENSIONS 3
 
-typedef struct tile_array {
+typedef struct point_array {
     size_t size;
-    tile_t * tiles;
-} tile_array_t;
-
-typedef struct tile_ptr_array {
-    size_t size;
-    tile_t ** tiles;
-} tile_ptr_array_t;
+    size_t dims;                            // 2: dominoes, 3: 1x1x2 bricks
+    coordinate * coords;                    // dims coordinates per point
+    coordinate origin[MAX_DIMENSIONS];      // bounding box, set by sort_points
+    coordinate extent[MAX_DIMENSIONS];
+} point_array_t;
+
+// Lattices as neighbour offset tables: X(axis, step), each +step directly
+// followed by its -step. Axis 0 is the slowest in the sort order. The order
+// is the order of the BFS, LATTICE_2D keeps top, bot, right, left.
+#define LATTICE_2D(X) \
+    X(1, +1) X(1, -1) \
+    X(0, +1) X(0, -1)
+#define LATTICE_3D(X) \
+    X(2, +1) X(2, -1) \
+    X(1, +1) X(1, -1) \
+    X(0, +1) X(0, -1)
+
+// Solver variants, generated from floesung_variant.h:
+//   X(name, dimensions, coordinate width, index width, largest coordinate, largest index)
+// main picks the first one that matches the dimensions and holds the
+// bounding box and the number of tiles, so the common case of boxes below
+// 65536 works on 28 byte tiles instead of 56 byte pointer tiles without any
+// branching per access.
+#define FLOESUNG_VARIANTS(X) \
+    X(narrow,  2, uint16_t, uint32_t, UINT16_MAX, UINT32_MAX) \
+    X(medium,  2, uint32_t, uint32_t, UINT32_MAX, UINT32_MAX) \
+    X(wide,    2, uint32_t, size_t,   UINT32_MAX, SIZE_MAX) \
+    X(narrow3, 3, uint16_t, uint32_t, UINT16_MAX, UINT32_MAX) \
+    X(medium3, 3, uint32_t, uint32_t, UINT32_MAX, UINT32_MAX) \
+    X(wide3,   3, uint32_t, size_t,   UINT32_MAX, SIZE_MAX)
 
 // FUNCTION DECLARATIONS //////////////////////////////////////////////////////
  
 void printc(char c);
 
-void print_tile(tile_t * tile);
-
-void print_tile_array(tile_array_t * tiles);
+int comp_points(const void * void_point1, const void * void_point2);
 
-int comp_tiles(const void * void_tile1, const void * void_tile2);
-
-int comp_tiles_eq(tile_t * tile1, tile_t * tile2);
+int comp_points_eq(const coordinate * point1, const coordinate * point2, size_t dims);
 
 #define DEBUG_APPEND_DIGIT
 error_msg append_digit(coordinate * coord, char new_digit);
 
 #define DEBUG_READ_LINE
-error_msg read_line(tile_t * out_tile);
-
-// #define DEBUG_CREATE_TILES
-error_msg create_tiles(tile_array_t * out_tiles);
+error_msg read_line(coordinate * out_coords, size_t * out_dims);
 
-void link_tiles(tile_array_t * tiles);
+int box_fits(point_array_t * points, coordinate largest);
 
-tile_t * find_start_tile(tile_array_t * tiles);
+void sort_points(point_array_t * points);
 
-error_msg build_reverse_path(tile_t * start, tile_t * end, tile_ptr_array_t * out_path);
+// #define DEBUG_CREATE_TILES
+error_msg create_tiles(point_array_t * out_points);
 
 // #define DEBUG_FIND_AGUMENTING_PATH
-error_msg find_augmenting_path(tile_array_t * tiles, tile_ptr_array_t * out_path);
-    
-void assert_all_not_visited(tile_array_t * tiles);
+
+// SOLVER VARIANTS ////////////////////////////////////////////////////////////
+
+#define VARIANT narrow
+#define DIMENSIONS 2
+#define LATTICE LATTICE_2D
+#define coordinate_v uint16_t
+#define index_v uint32_t
+#define COORDINATE_V_MAX UINT16_MAX
+#include "floesung_variant.h"
+
+#define VARIANT medium
+#define DIMENSIONS 2
+#define LATTICE LATTICE_2D
+#define coordinate_v uint32_t
+#define index_v uint32_t
+#define COORDINATE_V_MAX UINT32_MAX
+#include "floesung_variant.h"
+
+#define VARIANT wide
+#define DIMENSIONS 2
+#define LATTICE LATTICE_2D
+#define coordinate_v uint32_t
+#define index_v size_t
+#define COORDINATE_V_MAX UINT32_MAX
+#include "floesung_variant.h"
+
+#define VARIANT narrow3
+#define DIMENSIONS 3
+#define LATTICE LATTICE_3D
+#define coordinate_v uint16_t
+#define index_v uint32_t
+#define COORDINATE_V_MAX UINT16_MAX
+#include "floesung_variant.h"
+
+#define VARIANT medium3
+#define DIMENSIONS 3
+#define LATTICE LATTICE_3D
+#define coordinate_v uint32_t
+#define index_v uint32_t
+#define COORDINATE_V_MAX UINT32_MAX
+#include "floesung_variant.h"
+
+#define VARIANT wide3
+#define DIMENSIONS 3
+#define LATTICE LATTICE_3D
+#define coordinate_v uint32_t
+#define index_v size_t
+#define COORDINATE_V_MAX UINT32_MAX
+#include "floesung_variant.h"
     
 // FUNCTION IMPLEMENTATIONS ///////////////////////////////////////////////////
 
@@ -85,54 +140,35 @@ void printc(char c) {
 }
 
 
-void print_tile(tile_t * tile){
-    fprintf(stderr, "tile at: %p  x=%u y=%u  t=%p   b=%p   r=%p   l=%p  m=%p   v=%p  \n",
-            (void*)tile, tile->x, tile->y,
-            (void*)tile->top_tile, (void*)tile->bot_tile,
-            (void*)tile->right_tile, (void*)tile->left_tile,
-            (void*)tile->matched_with, (void*)tile->visited_by
-            );
-    // fprintf(stderr, "tile at: %p  x=%u y=%u  
-// t=%p \tb=%p \tr=%p \tl=%p \t
-// m=%p \tv=%p\t\n",
-}
-
-
-void print_tile_array(tile_array_t * tiles) {
-    fprintf(stderr, "tile_array at: %p\n", (void*)tiles);
-    fprintf(stderr, "  size=%lu\n", tiles->size);
-    fprintf(stderr, "  tiles=\n");
-    for( size_t cur_idx=0; cur_idx < tiles->size; ++cur_idx ) {
-        fprintf(stderr, "    ");
-        print_tile(&(tiles->tiles[cur_idx]));
-    }
-}
-
+static size_t point_dims = 2; // for comp_points, qsort has no context
 
-int comp_tiles(const void * void_tile1, const void * void_tile2) {
-    // returns:  1, iff tile1 > tile2
-    //           0, iff tile1 == tile2
-    //          -1, iff tile1 < tile2
+int comp_points(const void * void_point1, const void * void_point2) {
+    // returns:  1, iff point1 > point2
+    //           0, iff point1 == point2
+    //          -1, iff point1 < point2
+    // lexicographic, first coordinate first
 
-    tile_t * tile1 = (tile_t*) void_tile1;
-    tile_t * tile2 = (tile_t*) void_tile2;
+    const coordinate * point1 = (const coordinate*) void_point1;
+    const coordinate * point2 = (const coordinate*) void_point2;
 
-    if( tile1->x > tile2->x || (tile1->x == tile2->x && tile1->y > tile2->y) ) {
-        return 1;
-    } else if(tile1->x == tile2->x && tile1->y == tile2->y ) {
-        return 0;
+    for( size_t dim = 0; dim < point_dims; dim++ ) {
+        if( point1[dim] != point2[dim] ) {
+            return point1[dim] > point2[dim] ? 1 : -1;
+        }
     }
-    return -1;
+    return 0;
 }
 
 
-int comp_tiles_eq(tile_t * tile1, tile_t * tile2) {
-    // returns:  1, iff tile1 == tile2
-    //           0, iff tile1 != tile2
-    if( tile1->x == tile2->x && tile1->y == tile2->y ) {
-        return 1;
+int comp_points_eq(const coordinate * point1, const coordinate * point2, size_t dims) {
+    // returns:  1, iff point1 == point2
+    //           0, iff point1 != point2
+    for( size_t dim = 0; dim < dims; dim++ ) {
+        if( point1[dim] != point2[dim] ) {
+            return 0;
+        }
     }
-    return 0;
+    return 1;
 }
 
 
@@ -164,494 +200,288 @@ error_msg append_digit(coordinate * coord, char new_digit) {
 }
 
 
-error_msg read_line(tile_t * out_tile) {
-    
+error_msg read_line(coordinate * out_coords, size_t * out_dims) {
+    // reads "x y" or "x y z"; *out_dims is 0 at the end of the input
+
     #ifdef DEBUG_READ_LINE
         static unsigned long line_count = 0;
         line_count ++;
     #endif
     
-    char c = fgetc(stdin);
-    if( feof(stdin) ){
+    static const error_msg non_digit[MAX_DIMENSIONS] = {
+        "Err: Found non-digit character in first coordinate of input line!\n",
+        "Err: Found non-digit character second coordinate of input line!\n",
+        "Err: Found non-digit character third coordinate of input line!\n",
+    };
+
+    *out_dims = 0;
+    int c = getc_unlocked(stdin);
+    if( c == EOF ){
         return NULL;
     }
 
     // skip leading <SPACE>s
     while( c == ' ' ) {
-        c = fgetc(stdin);
+        c = getc_unlocked(stdin);
     };
 
-    // c is the first non <SPACE> char now
-    // read x coordinate of tile number
-    coordinate x = 0;
+    size_t dims = 0;
     do {
-        if( isdigit(c) ) {
-            error_msg error = append_digit(&x, c);
-            if( error ){
-                #ifdef DEBUG_READ_LINE
-                    fprintf(stderr, "line %lu: ", line_count);
-                #endif
-                return error;
-            }
-        } else {
+        if( dims == MAX_DIMENSIONS ) {
             
             #ifdef DEBUG_READ_LINE
                 fprintf(stderr, "line %lu: ", line_count);printc(c);
             #endif
             
-            return "Err: Found non-digit character in first coordinate of input line!\n";
+            return "Err: Found too many words in input line!\n";
         }
-        c = fgetc(stdin);
-    } while( c != ' ' );
-
-
-    // c is a <SPACE> now
-    // skip other <SPACE>s between the numbers
-    while( c == ' ' ) {
-        c = fgetc(stdin);
-    };
 
-    // c is a non <SPACE> char now
-    coordinate y = 0;
-    do {
-        if( isdigit(c) ) {
-            error_msg error = append_digit(&y, c);
-            if( error ){
+        // c is the first non <SPACE> char of a coordinate now
+        coordinate value = 0;
+        do {
+            if( isdigit(c) ) {
+                error_msg error = append_digit(&value, c);
+                if( error ){
+                    #ifdef DEBUG_READ_LINE
+                        fprintf(stderr, "line %lu: ", line_count);
+                    #endif
+                    return error;
+                }
+            } else {
+                
                 #ifdef DEBUG_READ_LINE
-                    fprintf(stderr, "line %lu: ", line_count);
+                    fprintf(stderr, "line %lu: ", line_count);printc(c);
                 #endif
-                return error;
+                
+                return non_digit[dims];
             }
-        } else {
-            
-            #ifdef DEBUG_READ_LINE
-                fprintf(stderr, "line %lu: ", line_count);printc(c);
-            #endif
-            
-            return "Err: Found non-digit character second coordinate of input line!\n";
-        }
-        c = fgetc(stdin);
-    } while( c != ' '  && c != '\n' && c != EOF);
+            c = getc_unlocked(stdin);
+        } while( c != ' ' && (dims > 0 ? c != '\n' && c != EOF : 1) );
+        out_coords[dims++] = value;
 
-    while( c != '\n' && c != EOF ) {
-        if( c != ' ' ) {
-            
-            #ifdef DEBUG_READ_LINE
-                fprintf(stderr, "line %lu: ", line_count);printc(c);
-            #endif
-            
-            return "Err: Found too many words in input line!\n";
-        }
-        c = fgetc(stdin);
+        // skip other <SPACE>s after the number
+        while( c == ' ' ) {
+            c = getc_unlocked(stdin);
+        };
+    } while( c != '\n' && c != EOF );
+
+    if( dims < 2 ) {
+        
+        #ifdef DEBUG_READ_LINE
+            fprintf(stderr, "line %lu: ", line_count);printc(c);
+        #endif
+        
+        return non_digit[1];
     }
 
-    out_tile->x = x;
-    out_tile->y = y;
-    out_tile->top_tile = NULL;
-    out_tile->bot_tile = NULL;
-    out_tile->right_tile = NULL;
-    out_tile->left_tile = NULL;
-    out_tile->matched_with = NULL;
-    out_tile->visited_by = NULL;
+    *out_dims = dims;
     return NULL;
 }
 
 
-error_msg create_tiles(tile_array_t * out_tiles) {
+static uint64_t * radix_sort(uint64_t * keys, uint64_t * tmp, size_t size) {
+    // LSD radix sort by bytes, bytes without any difference are skipped;
+    // returns the buffer holding the result
 
-    size_t max_num_tiles = 1<<10;
-    size_t num_tiles = 0;
+    uint64_t varying = 0;
+    for( size_t cur_idx = 1; cur_idx < size; cur_idx++ ) {
+        varying |= keys[cur_idx] ^ keys[0];
+    }
 
-    tile_t * tiles = malloc(max_num_tiles*sizeof(tile_t));
-    if( !tiles ){ return "Err: Out of memory!\n"; }
+    for( unsigned shift = 0; shift < 64; shift += 8 ) {
+        if( !((varying >> shift) & 0xff) ) { continue; }
 
-    while( !feof(stdin) ) {
-        if( num_tiles == max_num_tiles ) {
-            max_num_tiles *= 2;
-            tiles = realloc(tiles, max_num_tiles*sizeof(tile_t));
-            if( !tiles ){
-                free(tiles);
-                return "Err: Out of memory\n!";
-            }
+        size_t count[256] = { 0 };
+        for( size_t cur_idx = 0; cur_idx < size; cur_idx++ ) {
+            count[(keys[cur_idx] >> shift) & 0xff]++;
         }
-
-        error_msg error = read_line(&tiles[num_tiles++]);
-        if( error ) {
-            free(tiles);
-            return error;
+        size_t sum = 0;
+        for( size_t digit = 0; digit < 256; digit++ ) {
+            size_t here = count[digit];
+            count[digit] = sum;
+            sum += here;
+        }
+        for( size_t cur_idx = 0; cur_idx < size; cur_idx++ ) {
+            tmp[count[(keys[cur_idx] >> shift) & 0xff]++] = keys[cur_idx];
         }
+        uint64_t * swap = keys;
+        keys = tmp;
+        tmp = swap;
     }
-    num_tiles--; // undo last increment
+    return keys;
+}
 
-    if( num_tiles == 0 ) {
-        out_tiles->tiles = tiles; // needs to be passed to get free correctly
-        out_tiles->size = num_tiles;
-        return NULL;
-    }
-    
-    qsort((void*)tiles, num_tiles, sizeof(tile_t), comp_tiles);
 
-    for( unsigned cur_tile = 0; cur_tile < num_tiles-1; cur_tile++  ) {
-        if( comp_tiles_eq(&tiles[cur_tile], &tiles[cur_tile+1]) ) {
-            
-            #ifdef DEBUG_CREATE_TILES
-                fprintf(stderr, "tile: "); print_tile(&tiles[cur_tile]);
-            #endif
-
-            free(tiles);
-            
-            return "Err: Found multiple given tile!\n";
+int box_fits(point_array_t * points, coordinate largest) {
+    // returns:  1, iff every extent of the bounding box is at most largest
+    for( size_t dim = 0; dim < points->dims; dim++ ) {
+        if( points->extent[dim] > largest ) {
+            return 0;
         }
     }
-
-    out_tiles->tiles = tiles;
-    out_tiles->size  = num_tiles;
-    return NULL;
+    return 1;
 }
 
 
-void link_tiles(tile_array_t * tiles) {
-    // precondition: tiles are sorted wrt. comp_tiles
- 
-    // size_t half_size = tiles->size/2;
-    size_t size = tiles->size;
-    
-    for( size_t cur_idx=0; cur_idx < size-1; ++cur_idx ) {
-        
-        tile_t * cur_tile = &tiles->tiles[cur_idx];
-        coordinate cur_x = cur_tile->x;
-        coordinate cur_y = cur_tile->y;
-        
-        // === set top and bot links ===
-        size_t nxt_idx = cur_idx + 1;
-        tile_t * nxt_tile = &tiles->tiles[nxt_idx];
-        
-        coordinate nxt_x = nxt_tile->x;
-        if( cur_x == nxt_x ) {
-            coordinate nxt_y = nxt_tile->y;
-            if( cur_y+1 == nxt_y ) {
-                cur_tile->top_tile = nxt_tile;
-                nxt_tile->bot_tile = cur_tile;
-            }
-        }
+void sort_points(point_array_t * points) {
+    // sorts lexicographically and sets the bounding box; relative
+    // coordinates packed into one 64 bit key (first axis in the high bits)
+    // go through radix_sort, boxes too wide for that through qsort
 
-        // === set left and right links ===
-        
-        // skip tiles, that cannot have right links
-        if( cur_x == UINT_MAX ) { continue; }
-         
-        // create a proxy tile to search for
-        tile_t right_tile_proxy; 
-        right_tile_proxy.x = cur_x + 1;
-        right_tile_proxy.y = cur_y;
-        
-        tile_t * right_ptr = (tile_t*) bsearch((void*)&right_tile_proxy, (void*)cur_tile, 
-                size - cur_idx , sizeof(tile_t), comp_tiles);
+    size_t size = points->size;
+    size_t dims = points->dims;
+    coordinate * coords = points->coords;
 
-        if( right_ptr ) {
-            cur_tile->right_tile = right_ptr;
-            right_ptr->left_tile = cur_tile;
-        }
-        
+    coordinate high[MAX_DIMENSIONS];
+    for( size_t dim = 0; dim < dims; dim++ ) {
+        points->origin[dim] = high[dim] = coords[dim];
     }
- 
-}
-
-
-tile_t * find_start_tile(tile_array_t * tiles) {
-    // find first start tile in tiles
-     
-    tile_t * start_tile = NULL;
-    
-    for( size_t cur_idx=0; cur_idx < tiles->size; ++cur_idx ) {
-        
-        tile_t * cur_tile = &tiles->tiles[cur_idx];
-        
-        if( !cur_tile->matched_with && !cur_tile->visited_by) {
-            start_tile = cur_tile;
-            break;
+    for( size_t cur_idx = 1; cur_idx < size; cur_idx++ ) {
+        for( size_t dim = 0; dim < dims; dim++ ) {
+            coordinate value = coords[cur_idx*dims + dim];
+            if( value < points->origin[dim] ) { points->origin[dim] = value; }
+            if( value > high[dim] ) { high[dim] = value; }
         }
     }
 
-    return start_tile;
-}
-
-
-error_msg build_reverse_path(tile_t * start, tile_t * end, tile_ptr_array_t * out_path)  {
-    // builds a path from end to start
+    unsigned shift[MAX_DIMENSIONS];
+    unsigned width[MAX_DIMENSIONS];
+    unsigned bits = 0;
+    for( size_t dim = dims; dim-- > 0; ) {
+        points->extent[dim] = high[dim] - points->origin[dim];
+        shift[dim] = bits;
+        width[dim] = 0;
+        for( coordinate rest = points->extent[dim]; rest; rest >>= 1 ) { width[dim]++; }
+        bits += width[dim];
+    }
 
-    size_t max_path_length = 1 << 5;
-    
-    tile_t ** path = malloc(max_path_length*sizeof(tile_t*));
-    if( !path ){ return "Err: Out of memory!\n"; }
-    
+    uint64_t * keys = bits <= 64 ? malloc(2*size*sizeof(uint64_t)) : NULL;
+    if( !keys ) { // too wide or no memory for the keys
+        point_dims = dims;
+        qsort((void*)coords, size, dims*sizeof(coordinate), comp_points);
+        return;
+    }
 
-    path[0] = end;
-    size_t path_length = 1;
-    tile_t * cur_tile = end;
-    do {
-        cur_tile = cur_tile->visited_by;
-        
-        if( path_length == max_path_length ) {
-            max_path_length *= 2;
-            path = realloc(path, max_path_length*sizeof(tile_t*));
-            if( !path ){
-                free(path);
-                return "Err: Out of memory!\n";
-            }
+    for( size_t cur_idx = 0; cur_idx < size; cur_idx++ ) {
+        uint64_t key = 0;
+        for( size_t dim = 0; dim < dims; dim++ ) {
+            key |= (uint64_t)(coords[cur_idx*dims + dim] - points->origin[dim]) << shift[dim];
         }
-        path[path_length++] = cur_tile;
-    } while( cur_tile != start ); 
-
-    out_path->tiles = path;
-    out_path->size = path_length;
+        keys[cur_idx] = key;
+    }
 
-    // if( path_length == 34  ){
-    //     for( size_t cur_idx = 0; cur_idx < path_length; cur_idx++ ) {
-    //         print_tile(path[cur_idx]);
-    //     }
-    // fprintf(stderr, "there");
-    // }
+    uint64_t * sorted = radix_sort(keys, keys + size, size);
 
-    return NULL;
+    for( size_t cur_idx = 0; cur_idx < size; cur_idx++ ) {
+        uint64_t key = sorted[cur_idx];
+        for( size_t dim = 0; dim < dims; dim++ ) {
+            uint64_t field = (key >> shift[dim]) & (((uint64_t)1 << width[dim]) - 1);
+            coords[cur_idx*dims + dim] = points->origin[dim] + (coordinate)field;
+        }
+    }
+    free(keys);
 }
 
 
-error_msg find_augmenting_path(tile_array_t * tiles, tile_ptr_array_t * out_path) {
-    // finds an augmenting path in tiles and stores it in out_path
-    // if no such path exists out_path->size = 0
-    
-    
-    out_path->size = 0;
-
-    // initialize the search queue used for BFS
-    size_t queue_capacity = 1 << 5;
-    tile_t ** queue = malloc(queue_capacity*sizeof(tile_t*));
-    if( !queue ){ return "Err: Out of memory!\n"; }
-
-    // starting point of path
-    tile_t * start = find_start_tile(tiles);
-    if( !start ){ 
-        free(queue);
-        return NULL; 
-    };
-    queue[0] = start;
-
-    #ifdef DEBUG_FIND_AGUMENTING_PATH
-        fprintf(stderr, "  start_tile: ");
-        print_tile(start);
-    #endif
-    
-    tile_t * end = NULL;
-    
-    size_t pop_idx = 0;
-    size_t push_idx = 1;
-    while( pop_idx < push_idx && !end) {
-
-        tile_t * cur_tile = queue[pop_idx++];
-        tile_t * cur_children[] = {cur_tile->top_tile, cur_tile->bot_tile, cur_tile->right_tile, cur_tile->left_tile};
+error_msg create_tiles(point_array_t * out_points) {
+    // reads all points, sorts them and rejects duplicates; the solver
+    // variants build their tiles from this array
 
-        for( size_t child_idx = 0; child_idx < 4; child_idx++ ) {
-            
-            tile_t * cur_child = cur_children[child_idx];
-            
-            if( cur_child && !cur_child->visited_by ) { // this child exists and has not been visited
-
-                cur_child->visited_by = cur_tile;
-                
-                tile_t * match = cur_child->matched_with;
-                if( match && !match->visited_by ) { // match exists and has not been visited
-
-                    match->visited_by = cur_child;
+    size_t max_num_tiles = 1<<10;
+    size_t num_tiles = 0;
+    size_t dims = 0;
 
-                    if( push_idx == queue_capacity ) { // expand queue_capacity if needed
-                        queue_capacity *= 2;
-                        if( !(queue = realloc(queue, queue_capacity*sizeof(tile_t))) ) {
-                            free(queue);
-                            return "Err: Out of memory!\n";
-                        }
-                    }
+    coordinate * coords = malloc(max_num_tiles*MAX_DIMENSIONS*sizeof(coordinate));
+    if( !coords ){ return "Err: Out of memory!\n"; }
 
-                    queue[push_idx++] = match;
+    while( 1 ) {
+        coordinate line[MAX_DIMENSIONS];
+        size_t line_dims;
+        error_msg error = read_line(line, &line_dims);
+        if( error ) {
+            free(coords);
+            return error;
+        }
+        if( !line_dims ) { break; }
+        if( !dims ) { dims = line_dims; }
+        if( line_dims != dims ) {
+            free(coords);
+            return "Err: Found lines with different numbers of coordinates!\n";
+        }
 
-                } else { // match does not exist, so chils is a free tile
-                    end = cur_child;
-                    break;
-                }
-                
+        if( num_tiles == max_num_tiles ) {
+            max_num_tiles *= 2;
+            coordinate * bigger = realloc(coords, max_num_tiles*dims*sizeof(coordinate));
+            if( !bigger ){
+                free(coords);
+                return "Err: Out of memory\n!";
             }
- 
+            coords = bigger;
         }
- 
+        memcpy(&coords[num_tiles*dims], line, dims*sizeof(coordinate));
+        num_tiles++;
     }
 
-    if( !end ) {
-        free(queue);
-        out_path->size = 1;
+    out_points->coords = coords; // needs to be passed to get free correctly
+    out_points->size = num_tiles;
+    out_points->dims = dims ? dims : 2;
+    if( num_tiles == 0 ) {
         return NULL;
     }
     
-    size_t queue_length = push_idx;
-
-    #ifdef DEBUG_FIND_AGUMENTING_PATH
-        fprintf(stderr, "done building queue:\n");
-        fprintf(stderr, "  queue_length: %lu\n", queue_length);
-        for( size_t cur_idx = 0; cur_idx < queue_length; cur_idx++ ) {
-            fprintf(stderr, "      ");
-            print_tile(queue[cur_idx]);
-        }
-        fprintf(stderr, "  end:  ");
-        print_tile(end);
-        fprintf(stderr, "\n");
-    #endif
-    
-    // build path -- traverse the visited_by from end start
-    tile_ptr_array_t path;
-    error_msg error = build_reverse_path(start, end, &path);
-    if( error ){ return error; }
-    
-    #ifdef DEBUG_FIND_AGUMENTING_PATH
-        fprintf(stderr, "done building path:\n");
-        fprintf(stderr, "  path.size: %lu\n", path.size);
-        for( size_t cur_idx = 0; cur_idx < path.size; cur_idx++ ) {
-            fprintf(stderr, "      ");
-            print_tile(path.tiles[cur_idx]);
-        }
-        fprintf(stderr, "\n");
-    #endif
-    
-    // reset visited_by for all in queue
-    for( size_t cur_idx = 0; cur_idx < queue_length; cur_idx++) {
-        queue[cur_idx]->visited_by = NULL;
-        if( queue[cur_idx]->matched_with ) {
-            queue[cur_idx]->matched_with->visited_by = NULL;
-        }
-    }
-    free(queue);
-    
-    #ifdef DEBUG_FIND_AGUMENTING_PATH
-        fprintf(stderr, "done resetting queue:\n");
-        fprintf(stderr, "  path.size: %lu\n", path.size);
-        for( size_t cur_idx = 0; cur_idx < path.size; cur_idx++ ) {
-            fprintf(stderr, "      ");
-            print_tile(path.tiles[cur_idx]);
-        }
-        fprintf(stderr, "\n");
-        print_tile_array(tiles);
-    #endif
-    
-    // rereset visited_by for all in path
-    for( size_t cur_idx = 0; cur_idx < path.size-1; cur_idx++) {
-        path.tiles[cur_idx]->visited_by = path.tiles[cur_idx + 1];
-    }
-    path.tiles[path.size-1]->visited_by = path.tiles[0];
-    
-    #ifdef DEBUG_FIND_AGUMENTING_PATH
-        fprintf(stderr, "  path.size: %lu\n", path.size);
-        for( size_t cur_idx = 0; cur_idx < path.size; cur_idx++ ) {
-            fprintf(stderr, "      ");
-            print_tile(path.tiles[cur_idx]);
-        }
-        fprintf(stderr, "\n");
-        print_tile_array(tiles);
-    #endif
-    
-    out_path->tiles = path.tiles;
-    out_path->size = path.size;
-    return NULL;
-}
+    sort_points(out_points);
 
-
-void update_matching(tile_ptr_array_t * path) {
-    for( size_t cur_idx = 0; cur_idx < path->size-1; cur_idx++ ) {
-        tile_t * cur_tile = path->tiles[cur_idx];
-        
-        if( cur_idx % 2 == 0 ) {
-            
-            cur_tile->matched_with = cur_tile->visited_by;
-            cur_tile->matched_with->matched_with = cur_tile;
-            cur_tile->visited_by = NULL;
+    for( size_t cur_tile = 0; cur_tile < num_tiles-1; cur_tile++  ) {
+        if( comp_points_eq(&coords[cur_tile*dims], &coords[(cur_tile+1)*dims], dims) ) {
             
-        }
-        
-        cur_tile->visited_by = NULL;
-        
-    }
-
-    // remove visited_by flag from start
-    path->tiles[path->size-1]->visited_by = NULL;
-}
-
+            #ifdef DEBUG_CREATE_TILES
+                fprintf(stderr, "tile %lu\n", (unsigned long)cur_tile);
+            #endif
 
-void print_matching(tile_array_t * tiles) {
-    for( size_t cur_idx = 0; cur_idx < tiles->size; cur_idx++ ) {
-        tile_t * cur_tile = &tiles->tiles[cur_idx];
-        if( cur_tile->matched_with ) {
-            tile_t * match = cur_tile->matched_with;
-            printf("%u %u;%u %u\n",
-                    cur_tile->x, cur_tile->y,
-                    match->x, match->y);
-            cur_tile->matched_with = NULL;
-            match->matched_with = NULL;
+            free(coords);
+            out_points->coords = NULL;
+            
+            return "Err: Found multiple given tile!\n";
         }
     }
-}
 
-
-void assert_all_not_visited(tile_array_t * tiles) {
-    for( size_t cur_idx = 0; cur_idx < tiles->size; cur_idx++ ) {
-        tile_t * cur_tile = &tiles->tiles[cur_idx];
-        if( cur_tile->visited_by ) {
-            fprintf(stderr, "THERE IS A VISITED TILE!!!\n");
-            print_tile(cur_tile);
-            exit(1);
-        }
-    }
+    return NULL;
 }
 
 // MAIN METHOD ////////////////////////////////////////////////////////////////
 int main() {
 
-    tile_array_t tiles;
+    point_array_t points;
     error_msg error;
 
-    error = create_tiles(&tiles);
+    error = create_tiles(&points);
     if( error ) {
         fprintf(stderr, "%s", error);
         exit(1);
-    } else if( tiles.size == 0 ) {
-        free(tiles.tiles);
+    } else if( points.size == 0 ) {
+        free(points.coords);
         return 0;
-    } else if( tiles.size % 2 == 1 ){
+    } else if( points.size % 2 == 1 ){
         printf("None\n");
-        free(tiles.tiles);
+        free(points.coords);
         return 0;
     }
 
-    
-    link_tiles(&tiles);
-
-    while( 1 ) {
-        
-        tile_ptr_array_t path;
-        error = find_augmenting_path(&tiles, &path);
+    // first variant for the lattice that holds box and indices, NO_TILE
+    // needs the largest index
+    #define SOLVE_VARIANT(name, dimensions, coordinate_w, index_w, coordinate_max, index_max) \
+        if( points.dims == dimensions && box_fits(&points, coordinate_max) && points.size < (size_t)index_max ) { \
+            error = solve_##name(&points); \
+        } else
+    FLOESUNG_VARIANTS(SOLVE_VARIANT)
+    {
+        error = "Err: Too many tiles!\n";
+    }
+    #undef SOLVE_VARIANT
 
-        if( error ) {
-            free(tiles.tiles);
-            exit(1);
-        }
-        
-        if( path.size == 0 ) {
-            print_matching(&tiles);
-            break;
-        } else if (path.size == 1) {
-            printf("None\n");
-            break;
-        }
-        
-        update_matching(&path);
-        free(path.tiles);
+    free(points.coords);
+    if( error ) {
+        fprintf(stderr, "%s", error);
+        exit(1);
     }
-    
-    free(tiles.tiles);
 }
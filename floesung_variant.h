@@ -0,0 +1,290 @@
+// Solver for one lattice and coordinate / index width, included by
+// floesung.c once per entry of FLOESUNG_VARIANTS. Expects VARIANT (name
+// suffix), DIMENSIONS, LATTICE (neighbour offset table), coordinate_v,
+// index_v and COORDINATE_V_MAX to be defined and undefines them at the end.
+//
+// Tiles refer to each other by index instead of by pointer, NO_TILE marks a
+// missing neighbour / match / visitor. Coordinates are relative to the origin
+// of the bounding box, so narrow coordinates fit whenever the box does. All
+// loops over dimensions and neighbours have constant trip counts, so the 2D
+// variants pay nothing for the 3D lattice.
+
+#define VARIANT_PASTE2(name, variant) name##_##variant
+#define VARIANT_PASTE(name, variant) VARIANT_PASTE2(name, variant)
+#define V(name) VARIANT_PASTE(name, VARIANT)
+#define NO_TILE ((index_v) -1)
+#define NEIGHBOURS (2 * DIMENSIONS)
+
+#define LATTICE_ENTRY(axis, step) { axis, step },
+static const struct { size_t axis; int step; } V(lattice)[NEIGHBOURS] = { LATTICE(LATTICE_ENTRY) };
+#undef LATTICE_ENTRY
+
+typedef struct V(tile) {
+    coordinate_v c[DIMENSIONS];
+
+    index_v neighbour[NEIGHBOURS];  // in the order of LATTICE
+
+    index_v matched_with;
+
+    index_v visited_by;
+} V(tile_t);
+
+
+#ifdef DEBUG_FIND_AGUMENTING_PATH
+static long V(shown)(index_v idx) {
+    return idx == NO_TILE ? -1 : (long)idx;
+}
+
+
+static void V(print_tile)(V(tile_t) * tiles, index_v idx) {
+    V(tile_t) * tile = &tiles[idx];
+    fprintf(stderr, "tile %ld:", V(shown)(idx));
+    for( size_t dim = 0; dim < DIMENSIONS; dim++ ) {
+        fprintf(stderr, " %lu", (unsigned long)tile->c[dim]);
+    }
+    fprintf(stderr, "  n=");
+    for( size_t dir = 0; dir < NEIGHBOURS; dir++ ) {
+        fprintf(stderr, " %ld", V(shown)(tile->neighbour[dir]));
+    }
+    fprintf(stderr, "  m=%ld   v=%ld  \n", V(shown)(tile->matched_with), V(shown)(tile->visited_by));
+}
+
+
+static void V(assert_all_not_visited)(V(tile_t) * tiles, size_t size) {
+    for( size_t cur_idx = 0; cur_idx < size; cur_idx++ ) {
+        if( tiles[cur_idx].visited_by != NO_TILE ) {
+            fprintf(stderr, "THERE IS A VISITED TILE!!!\n");
+            V(print_tile)(tiles, (index_v)cur_idx);
+            exit(1);
+        }
+    }
+}
+#endif
+
+
+static int V(comp_coords)(const coordinate_v * coords1, const coordinate_v * coords2) {
+    // like comp_points, on the narrow coordinates
+    for( size_t dim = 0; dim < DIMENSIONS; dim++ ) {
+        if( coords1[dim] != coords2[dim] ) {
+            return coords1[dim] > coords2[dim] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+
+static void V(link_tiles)(V(tile_t) * tiles, size_t size) {
+    // precondition: tiles are sorted wrt. comp_points
+    // the neighbour in a +step direction grows with the tile, so every such
+    // direction keeps its own cursor that is never reset and linking stays
+    // linear; the -step entry right after it gets the back link
+
+    size_t cursor[NEIGHBOURS] = { 0 };
+    for( size_t cur_idx=0; cur_idx < size; ++cur_idx ) {
+
+        V(tile_t) * cur_tile = &tiles[cur_idx];
+
+        for( size_t dir = 0; dir < NEIGHBOURS; dir += 2 ) {
+            size_t axis = V(lattice)[dir].axis;
+
+            // skip tiles, that cannot have a neighbour in this direction
+            if( cur_tile->c[axis] == COORDINATE_V_MAX ) { continue; }
+
+            coordinate_v target[DIMENSIONS];
+            memcpy(target, cur_tile->c, sizeof(target));
+            target[axis]++;
+
+            size_t nxt_idx = cursor[dir] > cur_idx ? cursor[dir] : cur_idx + 1;
+            while( nxt_idx < size && V(comp_coords)(tiles[nxt_idx].c, target) < 0 ) {
+                ++nxt_idx;
+            }
+            cursor[dir] = nxt_idx;
+
+            if( nxt_idx < size && V(comp_coords)(tiles[nxt_idx].c, target) == 0 ) {
+                cur_tile->neighbour[dir] = (index_v)nxt_idx;
+                tiles[nxt_idx].neighbour[dir + 1] = (index_v)cur_idx;
+            }
+        }
+    }
+}
+
+
+static index_v V(find_start_tile)(V(tile_t) * tiles, size_t size, size_t * from) {
+    // find first unmatched tile, starting at *from
+    // matched tiles stay matched, so the scan never has to restart at index 0
+
+    for( size_t cur_idx=*from; cur_idx < size; ++cur_idx ) {
+        if( tiles[cur_idx].matched_with == NO_TILE ) {
+            *from = cur_idx;
+            return (index_v)cur_idx;
+        }
+    }
+    *from = size;
+    return NO_TILE;
+}
+
+
+static error_msg V(find_augmenting_path)(V(tile_t) * tiles, index_v start, index_v ** queue,
+        size_t * queue_capacity, index_v * out_end) {
+    // BFS from start along unmatched / matched edges, visited_by points back
+    // towards start; out_end is the free tile ending the path or NO_TILE
+
+    (*queue)[0] = start;
+
+    index_v end = NO_TILE;
+
+    size_t pop_idx = 0;
+    size_t push_idx = 1;
+    while( pop_idx < push_idx && end == NO_TILE ) {
+
+        index_v cur_idx = (*queue)[pop_idx++];
+        V(tile_t) * cur_tile = &tiles[cur_idx];
+
+        for( size_t dir = 0; dir < NEIGHBOURS; dir++ ) {
+
+            index_v cur_child = cur_tile->neighbour[dir];
+
+            if( cur_child != NO_TILE && tiles[cur_child].visited_by == NO_TILE ) { // this child exists and has not been visited
+
+                tiles[cur_child].visited_by = cur_idx;
+
+                index_v match = tiles[cur_child].matched_with;
+                if( match != NO_TILE ) { // the match has not been visited, only its child leads there
+
+                    tiles[match].visited_by = cur_child;
+
+                    if( push_idx == *queue_capacity ) { // expand queue_capacity if needed
+                        index_v * bigger = realloc(*queue, 2 * *queue_capacity * sizeof(index_v));
+                        if( !bigger ) { return "Err: Out of memory!\n"; }
+                        *queue = bigger;
+                        *queue_capacity *= 2;
+                    }
+
+                    (*queue)[push_idx++] = match;
+
+                } else { // match does not exist, so child is a free tile
+                    end = cur_child;
+                    break;
+                }
+            }
+        }
+    }
+
+    #ifdef DEBUG_FIND_AGUMENTING_PATH
+        fprintf(stderr, "  start: ");
+        V(print_tile)(tiles, start);
+        fprintf(stderr, "  queue_length: %lu\n", (unsigned long)push_idx);
+    #endif
+
+    // flip the path while visited_by is still set
+    for( index_v b = end; b != NO_TILE; ) {
+        index_v a = tiles[b].visited_by;
+        index_v after = a == start ? NO_TILE : tiles[a].visited_by;
+        tiles[a].matched_with = b;
+        tiles[b].matched_with = a;
+        b = after;
+    }
+
+    // reset visited_by: every queued tile but start was reached from the
+    // child it is matched with before the flip
+    if( end != NO_TILE ) { tiles[end].visited_by = NO_TILE; }
+    for( size_t cur_idx = 1; cur_idx < push_idx; cur_idx++ ) {
+        index_v queued = (*queue)[cur_idx];
+        tiles[tiles[queued].visited_by].visited_by = NO_TILE;
+        tiles[queued].visited_by = NO_TILE;
+    }
+
+    *out_end = end;
+    return NULL;
+}
+
+
+static void V(print_matching)(V(tile_t) * tiles, size_t size, const coordinate * origin) {
+    for( size_t cur_idx = 0; cur_idx < size; cur_idx++ ) {
+        V(tile_t) * cur_tile = &tiles[cur_idx];
+        if( cur_tile->matched_with != NO_TILE ) {
+            V(tile_t) * match = &tiles[cur_tile->matched_with];
+            #if DIMENSIONS == 2
+                printf("%u %u;%u %u\n",
+                        (coordinate)(origin[0] + cur_tile->c[0]), (coordinate)(origin[1] + cur_tile->c[1]),
+                        (coordinate)(origin[0] + match->c[0]), (coordinate)(origin[1] + match->c[1]));
+            #else
+                printf("%u %u %u;%u %u %u\n",
+                        (coordinate)(origin[0] + cur_tile->c[0]), (coordinate)(origin[1] + cur_tile->c[1]),
+                        (coordinate)(origin[2] + cur_tile->c[2]),
+                        (coordinate)(origin[0] + match->c[0]), (coordinate)(origin[1] + match->c[1]),
+                        (coordinate)(origin[2] + match->c[2]));
+            #endif
+            match->matched_with = NO_TILE;
+            cur_tile->matched_with = NO_TILE;
+        }
+    }
+}
+
+
+static error_msg V(solve)(point_array_t * points) {
+    // consumes points (sorted, without duplicates, even count) and prints
+    // the matching or None
+
+    size_t size = points->size;
+    V(tile_t) * tiles = malloc(size * sizeof(V(tile_t)));
+    size_t queue_capacity = 1 << 5;
+    index_v * queue = malloc(queue_capacity * sizeof(index_v));
+    if( !tiles || !queue ) {
+        free(tiles);
+        free(queue);
+        return "Err: Out of memory!\n";
+    }
+
+    for( size_t cur_idx = 0; cur_idx < size; cur_idx++ ) {
+        V(tile_t) * tile = &tiles[cur_idx];
+        for( size_t dim = 0; dim < DIMENSIONS; dim++ ) {
+            tile->c[dim] = (coordinate_v)(points->coords[cur_idx*DIMENSIONS + dim] - points->origin[dim]);
+        }
+        for( size_t dir = 0; dir < NEIGHBOURS; dir++ ) {
+            tile->neighbour[dir] = NO_TILE;
+        }
+        tile->matched_with = tile->visited_by = NO_TILE;
+    }
+    free(points->coords);   // the narrow tiles are the only copy from here on
+    points->coords = NULL;
+
+    V(link_tiles)(tiles, size);
+
+    error_msg error = NULL;
+    size_t start_idx = 0; // all tiles before it are matched
+    while( 1 ) {
+        index_v start = V(find_start_tile)(tiles, size, &start_idx);
+        if( start == NO_TILE ) {
+            #ifdef DEBUG_FIND_AGUMENTING_PATH
+                V(assert_all_not_visited)(tiles, size);
+            #endif
+            V(print_matching)(tiles, size, points->origin);
+            break;
+        }
+
+        index_v end;
+        error = V(find_augmenting_path)(tiles, start, &queue, &queue_capacity, &end);
+        if( error ) { break; }
+        if( end == NO_TILE ) {
+            printf("None\n");
+            break;
+        }
+    }
+
+    free(queue);
+    free(tiles);
+    return error;
+}
+
+#undef NEIGHBOURS
+#undef NO_TILE
+#undef V
+#undef VARIANT_PASTE
+#undef VARIANT_PASTE2
+#undef VARIANT
+#undef DIMENSIONS
+#undef LATTICE
+#undef coordinate_v
+#undef index_v
+#undef COORDINATE_V_MAX
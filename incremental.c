@@ -0,0 +1,344 @@
+/* Inkrementeller Loeser
+ *
+ * Der Zustand haelt die Kacheln in Bloecken fester Adresse und findet
+ * Nachbarn ueber eine Hashtabelle, so dass Einfuegen und Entfernen nur die
+ * vier Nachbarverweise anfassen. Die Zuordnung (edge) bleibt maximal:
+ *
+ * Einfuegen von v: jeder augmentierende Weg muss bei v enden, also reicht
+ * eine Suche ab v.
+ * Entfernen von v mit Partner u: jeder augmentierende Weg muss bei u enden,
+ * also reicht eine Suche ab u. Ein freies v wird einfach entfernt.
+ *
+ * Die Suche selbst ist findAugmentedPath() aus tiling.c, Suchbaum und
+ * Fehler kommen aus dem Kontext.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "loesung.h"
+
+#define SOLVER_BLOCK 4096   // Kacheln je Block
+
+struct solver_s{
+    tiling_t * ctx;
+    tile_t ** blocks;
+    size_t amountBlocks;
+    size_t used;            // belegte Plaetze im letzten Block
+    tile_t * freeList;      // verkettet ueber parent
+
+    tile_t ** table;        // offene Adressierung, lineares Sondieren
+    size_t capTable;
+    size_t amount;          // lebende Kacheln
+    size_t unmatched;
+};
+
+static size_t hashPoint(unsigned int x, unsigned int y, size_t cap)
+{
+    uint64_t key = ((uint64_t) x << 32 | y) * 0x9E3779B97F4A7C15ull;
+    return (size_t) (key >> 32) & (cap - 1);
+}
+
+static tile_t ** findSlot(const solver_t * s, unsigned int x, unsigned int y)
+{
+    size_t i = hashPoint(x, y, s->capTable);
+    while (s->table[i] && (s->table[i]->p.x != x || s->table[i]->p.y != y))
+    {
+        i = (i + 1) & (s->capTable - 1);
+    }
+    return &s->table[i];
+}
+
+static tile_t * lookup(const solver_t * s, unsigned int x, unsigned int y)
+{
+    return *findSlot(s, x, y);
+}
+
+static int growTable(solver_t * s)
+{
+    size_t oldCap = s->capTable;
+    tile_t ** old = s->table;
+    s->capTable = oldCap * 2;
+    s->table = (tile_t **) calloc(s->capTable, sizeof(tile_t *));
+    if (!s->table)
+    {
+        s->table = old;
+        s->capTable = oldCap;
+        return -1;
+    }
+    for (size_t i = 0; i < oldCap; i++)
+    {
+        if (old[i]) { *findSlot(s, old[i]->p.x, old[i]->p.y) = old[i]; }
+    }
+    free(old);
+    return 0;
+}
+
+/* Entfernen mit Rueckverschiebung, damit keine Grabsteine noetig sind
+ */
+static void eraseSlot(solver_t * s, tile_t ** slot)
+{
+    size_t mask = s->capTable - 1;
+    size_t i = (size_t) (slot - s->table);
+    size_t j = i;
+    s->table[i] = NULL;
+    while (1)
+    {
+        j = (j + 1) & mask;
+        if (!s->table[j]) { return; }
+        size_t home = hashPoint(s->table[j]->p.x, s->table[j]->p.y, s->capTable);
+        // j bleibt, wenn home zyklisch in (i, j] liegt
+        if ((j > i && home > i && home <= j) || (j < i && (home > i || home <= j))) { continue; }
+        s->table[i] = s->table[j];
+        s->table[j] = NULL;
+        i = j;
+    }
+}
+
+static tile_t * allocTile(solver_t * s)
+{
+    if (s->freeList)
+    {
+        tile_t * tile = s->freeList;
+        s->freeList = tile->parent;
+        return tile;
+    }
+    if (!s->amountBlocks || s->used == SOLVER_BLOCK)
+    {
+        tile_t ** temp = (tile_t **) realloc(s->blocks, (s->amountBlocks + 1) * sizeof(tile_t *));
+        if (!temp) { return NULL; }
+        s->blocks = temp;
+        s->blocks[s->amountBlocks] = (tile_t *) malloc(SOLVER_BLOCK * sizeof(tile_t));
+        if (!s->blocks[s->amountBlocks]) { return NULL; }
+        s->amountBlocks++;
+        s->used = 0;
+    }
+    return &s->blocks[s->amountBlocks - 1][s->used++];
+}
+
+/* Eine augmentierende Suche ab begin, bei Erfolg wird der Weg umgeklappt
+ */
+static int augment(solver_t * s, tile_t * begin)
+{
+    if (s->unmatched < 2) { return 0; }     // kein zweites Wegende vorhanden
+
+    int result = findAugmentedPath(s->ctx, s->amount, begin);
+    if (result < 0) { return -1; }
+    if (!result)
+    {
+        flipPath(s->ctx->path);
+        s->unmatched -= 2;
+    }
+    resetTree(s->ctx->tree);
+    return 0;
+}
+
+solver_t * solverCreate(tiling_t * ctx)
+{
+    solver_t * s = (solver_t *) calloc(1, sizeof(solver_t));
+    if (!s) { return NULL; }
+    s->ctx = ctx;
+    s->capTable = 64;
+    s->table = (tile_t **) calloc(s->capTable, sizeof(tile_t *));
+    if (!s->table)
+    {
+        solverFree(s);
+        return NULL;
+    }
+    return s;
+}
+
+void solverFree(solver_t * s)
+{
+    if (!s) { return; }
+    for (size_t b = 0; b < s->amountBlocks; b++) { free(s->blocks[b]); }
+    free(s->blocks);
+    free(s->table);
+    free(s);
+    return;
+}
+
+int solverInsert(solver_t * s, point_t p)
+{
+    if (lookup(s, p.x, p.y))
+    {
+        s->ctx->error = TILING_DOUBLE_LINE;
+        return -1;
+    }
+    if ((s->amount + 1) * 2 > s->capTable && growTable(s)) { goto mem; }
+
+    tile_t * tile = allocTile(s);
+    if (!tile) { goto mem; }
+    tile->p = p;
+    tile->parent = NULL;
+    tile->edge = NULL;
+    tile->north = p.y < 0xffffffffu ? lookup(s, p.x, p.y + 1) : NULL;
+    tile->south = p.y > 0 ? lookup(s, p.x, p.y - 1) : NULL;
+    tile->east = p.x < 0xffffffffu ? lookup(s, p.x + 1, p.y) : NULL;
+    tile->west = p.x > 0 ? lookup(s, p.x - 1, p.y) : NULL;
+    if (tile->north) { tile->north->south = tile; }
+    if (tile->south) { tile->south->north = tile; }
+    if (tile->east) { tile->east->west = tile; }
+    if (tile->west) { tile->west->east = tile; }
+
+    *findSlot(s, p.x, p.y) = tile;
+    s->amount++;
+    s->unmatched++;
+    if (augment(s, tile)) { goto mem; }
+    return 0;
+
+mem:
+    s->ctx->error = TILING_EXCEED_MEM;
+    return -1;
+}
+
+int solverRemove(solver_t * s, point_t p)
+{
+    tile_t ** slot = findSlot(s, p.x, p.y);
+    tile_t * tile = *slot;
+    if (!tile)
+    {
+        s->ctx->error = TILING_NO_TILE;
+        return -1;
+    }
+
+    if (tile->north) { tile->north->south = NULL; }
+    if (tile->south) { tile->south->north = NULL; }
+    if (tile->east) { tile->east->west = NULL; }
+    if (tile->west) { tile->west->east = NULL; }
+    eraseSlot(s, slot);
+    s->amount--;
+
+    tile_t * partner = tile->edge;
+    tile->parent = s->freeList;
+    s->freeList = tile;
+
+    if (!partner)
+    {
+        s->unmatched--;
+        return 0;
+    }
+    partner->edge = NULL;
+    s->unmatched++;
+    if (augment(s, partner))
+    {
+        s->ctx->error = TILING_EXCEED_MEM;
+        return -1;
+    }
+    return 0;
+}
+
+int solverTileable(const solver_t * s)
+{
+    return s->unmatched == 0;
+}
+
+static int cmpTile(const void * a, const void * b)
+{
+    const tile_t * ta = *(tile_t * const *) a;
+    const tile_t * tb = *(tile_t * const *) b;
+    if (ta->p.x != tb->p.x) { return ta->p.x < tb->p.x ? -1 : 1; }
+    return (ta->p.y > tb->p.y) - (ta->p.y < tb->p.y);
+}
+
+/* Ausgabe wie printResult: "None" oder alle Dominos, sortiert nach der
+ * kleineren Kachel
+ */
+int solverPrint(const solver_t * s, FILE * out)
+{
+    if (!solverTileable(s))
+    {
+        fprintf(out, none);
+        return 0;
+    }
+    tile_t ** order = (tile_t **) malloc((s->amount ? s->amount : 1) * sizeof(tile_t *));
+    if (!order)
+    {
+        s->ctx->error = TILING_EXCEED_MEM;
+        return -1;
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < s->capTable; i++)
+    {
+        if (s->table[i]) { order[k++] = s->table[i]; }
+    }
+    qsort(order, k, sizeof(tile_t *), cmpTile);
+    for (size_t i = 0; i < k; i++)
+    {
+        tile_t * other = order[i]->edge;
+        if (cmpTile(&order[i], &other) < 0)
+        {
+            fprintf(out, "%u %u;%u %u\n", order[i]->p.x, order[i]->p.y, other->p.x, other->p.y);
+        }
+    }
+    free(order);
+    return 0;
+}
+
+/* Bearbeitungsskript
+ *
+ * "x y" oder "+ x y": Kachel einfuegen
+ * "- x y": Kachel entfernen
+ * Leerzeile: Ende eines Stapels, die aktuelle Loesung wird ausgegeben
+ *
+ * Nach jedem Stapel (und am Ende) folgt die Loesung und eine Leerzeile.
+ */
+void tilingEdit(tiling_t * ctx, FILE * in)
+{
+    solver_t * s = solverCreate(ctx);
+    if (!s)
+    {
+        ctx->error = TILING_EXCEED_MEM;
+        return;
+    }
+
+    input_t input;
+    input.in = in;
+    input.line = 0;
+    input.offset = 0;
+    int pending = 0;    // Aenderungen seit der letzten Ausgabe
+
+    while (1)
+    {
+        int blank = readBlank(&input);
+        if (blank == EOF) { break; }
+        if (blank)
+        {
+            if (solverPrint(s, stdout)) { goto end; }
+            fprintf(stdout, "\n");
+            pending = 0;
+            continue;
+        }
+
+        int c = getc(in);
+        int remove = c == '-';
+        if (c != '-' && c != '+') { ungetc(c, in); }
+
+        point_t p;
+        int status = readLine(ctx, &input, &p);
+        if (status <= 0)
+        {
+            if (!status)
+            {
+                ctx->error = TILING_WRONG_COOR;
+                ctx->errData.i = input.line + 1;
+            }
+            goto end;
+        }
+        if ((remove ? solverRemove(s, p) : solverInsert(s, p)))
+        {
+            if (ctx->error == TILING_NO_TILE) { ctx->errData.i = input.line; }
+            goto end;
+        }
+        pending = 1;
+    }
+    if (pending)
+    {
+        if (solverPrint(s, stdout)) { goto end; }
+        fprintf(stdout, "\n");
+    }
+
+end:
+    solverFree(s);
+    return;
+}
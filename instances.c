@@ -0,0 +1,162 @@
+/* Testinstanzen fuer die Werkzeuge, siehe instances.h
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "instances.h"
+
+const char * const familyNames[FAMILIES] = {
+    [FAMILY_SQUARE]   = "square",
+    [FAMILY_STRIP]    = "strip",
+    [FAMILY_HOLES]    = "holes",
+    [FAMILY_SUBSET]   = "subset",
+    [FAMILY_DOMINOES] = "dominoes",
+};
+
+void randomSeed(random_t * r, unsigned long long seed)
+{
+    r->state = seed * 0x9e3779b97f4a7c15ull + 1;
+    if (!r->state) { r->state = 1; }
+}
+
+uint64_t randomNext(random_t * r)
+{
+    r->state ^= r->state << 13;
+    r->state ^= r->state >> 7;
+    r->state ^= r->state << 17;
+    return r->state;
+}
+
+unsigned int randomBelow(random_t * r, unsigned int n)
+{
+    return (unsigned int) (randomNext(r) % n);
+}
+
+double wallClock(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+int familyByName(const char * name, family_t * family)
+{
+    for (int f = 0; f < FAMILIES; f++)
+    {
+        if (!strcmp(name, familyNames[f]))
+        {
+            *family = (family_t) f;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void shuffle(point_t * points, size_t amount, random_t * r)
+{
+    for (size_t i = amount; i > 1; i--)
+    {
+        size_t j = (size_t) (randomNext(r) % i);
+        point_t swap = points[i - 1];
+        points[i - 1] = points[j];
+        points[j] = swap;
+    }
+}
+
+/* Teilmenge eines w x h Rechtecks oder Rechteck ohne zufaellige Dominos,
+ * Seiten bis size
+ */
+static size_t makeRandom(point_t * points, unsigned int size, int dominoes, random_t * r)
+{
+    unsigned int w = 1 + randomBelow(r, size);
+    unsigned int h = 1 + randomBelow(r, size);
+    unsigned int x0 = randomBelow(r, 4);
+    unsigned int y0 = randomBelow(r, 4);
+    size_t amount = 0;
+    if (!dominoes)
+    {
+        unsigned int density = 50 + randomBelow(r, 51);     // Prozent
+        for (unsigned int x = 0; x < w; x++)
+        {
+            for (unsigned int y = 0; y < h; y++)
+            {
+                if (randomBelow(r, 100) >= density) { continue; }
+                points[amount].x = x0 + x;
+                points[amount].y = y0 + y;
+                amount++;
+            }
+        }
+        return amount;
+    }
+
+    unsigned char * gone = (unsigned char *) calloc((size_t) w * h, 1);
+    if (!gone) { return 0; }
+    unsigned int removals = randomBelow(r, w * h / 4 + 1);
+    for (unsigned int k = 0; k < removals; k++)
+    {
+        unsigned int x = randomBelow(r, w);
+        unsigned int y = randomBelow(r, h);
+        int vertical = (int) randomBelow(r, 2);
+        unsigned int x2 = vertical ? x : x + 1;
+        unsigned int y2 = vertical ? y + 1 : y;
+        if (x2 >= w || y2 >= h || gone[x * h + y] || gone[x2 * h + y2]) { continue; }
+        gone[x * h + y] = 1;
+        gone[x2 * h + y2] = 1;
+    }
+    for (unsigned int x = 0; x < w; x++)
+    {
+        for (unsigned int y = 0; y < h; y++)
+        {
+            if (gone[x * h + y]) { continue; }
+            points[amount].x = x0 + x;
+            points[amount].y = y0 + y;
+            amount++;
+        }
+    }
+    free(gone);
+    return amount;
+}
+
+size_t makeFamily(point_t * points, family_t family, size_t n, random_t * r)
+{
+    if (family == FAMILY_SUBSET || family == FAMILY_DOMINOES)
+    {
+        return makeRandom(points, (unsigned int) n, family == FAMILY_DOMINOES, r);
+    }
+    size_t amount = 0;
+    if (family == FAMILY_STRIP)
+    {
+        for (unsigned int y = 0; y < n / 2; y++)
+        {
+            for (unsigned int x = 0; x < 2; x++) { points[amount++] = (point_t) { x, y }; }
+        }
+    } else {
+        unsigned int side = (unsigned int) sqrt((double) n) & ~1u;
+        for (unsigned int x = 0; x < side; x++)
+        {
+            for (unsigned int y = 0; y < side; y++)
+            {
+                // ohne (2i, y)-(2i+1, y) fuer etwa jedes 64. Paar
+                if (family == FAMILY_HOLES && ((x / 2 * 2654435761u) ^ (y * 40503u)) % 64 == 0) { continue; }
+                points[amount++] = (point_t) { x, y };
+            }
+        }
+    }
+    shuffle(points, amount, r);
+    return amount;
+}
+
+char * pointsText(const point_t * points, size_t amount, size_t * len)
+{
+    char * text = (char *) malloc(amount * 22 + 1);
+    if (!text) { return NULL; }
+    char * p = text;
+    for (size_t i = 0; i < amount; i++) { p += sprintf(p, "%u %u\n", points[i].x, points[i].y); }
+    *len = (size_t) (p - text);
+    return text;
+}
@@ -0,0 +1,60 @@
+#ifndef INSTANCES_H
+#define INSTANCES_H
+
+/* Testinstanzen fuer die Werkzeuge (cross_check, scaling, bench)
+ *
+ * Ein eigener xorshift-Generator, damit jeder Seed auf jedem Rechner
+ * dieselben Instanzen liefert, dazu Uhr und die Formfamilien. Gehoert nicht
+ * zu libtiling, die Werkzeuge binden instances.o selbst ein.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tiling.h"
+
+typedef struct random_s{
+    uint64_t state;             // nie 0
+} random_t;
+
+void randomSeed(random_t * r, unsigned long long seed);
+uint64_t randomNext(random_t * r);
+unsigned int randomBelow(random_t * r, unsigned int n);
+
+double wallClock(void);         // Sekunden, monoton
+
+/* Formfamilien
+ *
+ * nach Kachelzahl (makeFamily): volles Quadrat, Streifen der Breite 2,
+ * Quadrat ohne etwa jedes 64. ausgerichtete waagrechte Domino
+ *
+ * nach Seitenlaenge (makeFamily mit n = hoechste Seite): zufaellige
+ * Teilmenge eines Rechtecks, Rechteck ohne zufaellige Dominos
+ */
+typedef enum family_e{
+    FAMILY_SQUARE = 0,
+    FAMILY_STRIP,
+    FAMILY_HOLES,
+    FAMILY_SUBSET,
+    FAMILY_DOMINOES,
+    FAMILIES
+} family_t;
+
+#define FAMILY_SCALING (FAMILY_HOLES + 1)   // Familien nach Kachelzahl
+
+extern const char * const familyNames[FAMILIES];
+
+/* 0: gefunden, -1: unbekannter Name
+ */
+int familyByName(const char * name, family_t * family);
+
+/* Instanz in points (Platz fuer n bzw. n*n Kacheln), Rueckgabe Anzahl;
+ * die Familien nach Kachelzahl werden gemischt
+ */
+size_t makeFamily(point_t * points, family_t family, size_t n, random_t * r);
+
+/* Kacheln als Eingabetext "x y\n", NULL ohne Speicher
+ */
+char * pointsText(const point_t * points, size_t amount, size_t * len);
+
+#endif
@@ -0,0 +1,204 @@
+/* Umordnen der Kacheln nach Morton- oder Hilbert-Kurve (--layout)
+ *
+ * sort() legt die Kacheln spaltenweise ab: Nord und Sued liegen direkt
+ * nebeneinander, Ost und West aber eine ganze Spalte entfernt. Die
+ * Breitensuche in findAugmentedPath() springt deshalb auf grossen Feldern
+ * quer durch den Speicher.
+ *
+ * Nach linkTiles() werden die Kacheln hier in die Reihenfolge einer
+ * raumfuellenden Kurve ueber die Bounding Box kopiert (Schluessel aus den
+ * um den kleinsten x- und y-Wert verschobenen Koordinaten, 64 Bit reichen
+ * fuer 32 Bit je Achse), alle Zeiger werden auf die neuen Plaetze
+ * umgeschrieben. Die Suchen laufen auf der Kopie, danach wird die Zuordnung
+ * in das sortierte Feld zurueckgeschrieben, so dass tilingNext() und die
+ * Ausgabe unveraendert bleiben.
+ *
+ * Morton verschraenkt nur die Bits, Hilbert vermeidet zusaetzlich die
+ * Spruenge zwischen den Quadranten. Kopie und Reihenfolge gehoeren dem
+ * Kontext und wachsen wie die anderen Puffer nur.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "loesung.h"
+
+typedef struct curveKey_s{
+    uint64_t key;
+    size_t index;
+} curveKey_t;
+
+static uint64_t spread(uint64_t v)
+{
+    v &= 0xffffffffull;
+    v = (v | v << 16) & 0x0000ffff0000ffffull;
+    v = (v | v << 8)  & 0x00ff00ff00ff00ffull;
+    v = (v | v << 4)  & 0x0f0f0f0f0f0f0f0full;
+    v = (v | v << 2)  & 0x3333333333333333ull;
+    v = (v | v << 1)  & 0x5555555555555555ull;
+    return v;
+}
+
+static uint64_t mortonKey(uint64_t x, uint64_t y)
+{
+    return spread(x) << 1 | spread(y);
+}
+
+/* Position auf der Hilbert-Kurve der Ordnung bits (Seitenlaenge 2^bits)
+ */
+static uint64_t hilbertKey(uint64_t x, uint64_t y, unsigned int bits)
+{
+    uint64_t d = 0;
+    for (uint64_t s = bits ? (uint64_t) 1 << (bits - 1) : 0; s; s >>= 1)
+    {
+        uint64_t rx = (x & s) != 0;
+        uint64_t ry = (y & s) != 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (!ry)
+        {
+            if (rx)
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            uint64_t t = x;
+            x = y;
+            y = t;
+        }
+    }
+    return d;
+}
+
+/* LSD-Radixsort ueber Bytes wie in extsort.c, gleiche Bytes werden uebersprungen
+ */
+static curveKey_t * sortKeys(curveKey_t * keys, curveKey_t * temp, size_t n)
+{
+    size_t count[8][256];
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < n; i++)
+    {
+        for (unsigned int d = 0; d < 8; d++) { count[d][(keys[i].key >> (8*d)) & 0xff]++; }
+    }
+
+    for (unsigned int d = 0; d < 8; d++)
+    {
+        if (count[d][(keys[0].key >> (8*d)) & 0xff] == n) { continue; }
+
+        size_t sum = 0;
+        for (unsigned int b = 0; b < 256; b++)
+        {
+            size_t c = count[d][b];
+            count[d][b] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) { temp[count[d][(keys[i].key >> (8*d)) & 0xff]++] = keys[i]; }
+
+        curveKey_t * swap = keys;
+        keys = temp;
+        temp = swap;
+    }
+    return keys;
+}
+
+static tile_t * moved(tile_t * old, const tile_t * home, tile_t * work, const size_t * place)
+{
+    return old ? &work[place[old - home]] : NULL;
+}
+
+int layoutTiles(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    tile_t * home = allTiles->tiles;
+    size_t amount = allTiles->amount;
+
+    if (ctx->capLayout < amount)
+    {
+        tile_t * tiles = (tile_t *) memRealloc(ctx, ctx->layoutTiles, amount * sizeof(tile_t));
+        if (!tiles) { goto mem; }
+        ctx->layoutTiles = tiles;
+        size_t * order = (size_t *) memRealloc(ctx, ctx->layoutOrder, amount * sizeof(size_t));
+        if (!order) { goto mem; }
+        ctx->layoutOrder = order;
+        ctx->capLayout = amount;
+    }
+    curveKey_t * keys = (curveKey_t *) memAlloc(ctx, amount * sizeof(curveKey_t));
+    curveKey_t * temp = (curveKey_t *) memAlloc(ctx, amount * sizeof(curveKey_t));
+    if (!keys || !temp)
+    {
+        memFree(ctx, keys);
+        memFree(ctx, temp);
+        goto mem;
+    }
+
+    unsigned int minX = home[0].p.x;        // sortiert: kleinstes x vorne
+    unsigned int minY = home[0].p.y;
+    unsigned int maxX = home[amount - 1].p.x;
+    unsigned int maxY = minY;
+    for (size_t i = 0; i < amount; i++)
+    {
+        if (home[i].p.y < minY) { minY = home[i].p.y; }
+        if (home[i].p.y > maxY) { maxY = home[i].p.y; }
+    }
+    unsigned int side = maxX - minX > maxY - minY ? maxX - minX : maxY - minY;
+    unsigned int bits = 0;
+    while (bits < 32 && side >> bits) { bits++; }
+
+    for (size_t i = 0; i < amount; i++)
+    {
+        uint64_t x = home[i].p.x - minX;
+        uint64_t y = home[i].p.y - minY;
+        keys[i].key = ctx->layout == TILING_LAYOUT_HILBERT ? hilbertKey(x, y, bits) : mortonKey(x, y);
+        keys[i].index = i;
+    }
+    curveKey_t * sorted = sortKeys(keys, temp, amount);
+
+    /* order: neuer Platz -> sortierter Platz, place umgekehrt (im freien
+     * Sortierpuffer)
+     */
+    size_t * order = ctx->layoutOrder;
+    size_t * place = (size_t *) (sorted == keys ? temp : keys);
+    for (size_t k = 0; k < amount; k++)
+    {
+        order[k] = sorted[k].index;
+        place[sorted[k].index] = k;
+    }
+    tile_t * work = ctx->layoutTiles;
+    for (size_t k = 0; k < amount; k++)
+    {
+        const tile_t * t = &home[order[k]];
+        tile_t * w = &work[k];
+        w->p = t->p;
+        w->parent = NULL;
+        w->depth = 0;
+        w->edge = moved(t->edge, home, work, place);
+        w->north = moved(t->north, home, work, place);
+        w->east = moved(t->east, home, work, place);
+        w->south = moved(t->south, home, work, place);
+        w->west = moved(t->west, home, work, place);
+    }
+    memFree(ctx, keys);
+    memFree(ctx, temp);
+
+    ctx->layoutHome = home;
+    allTiles->tiles = work;
+    return 0;
+
+mem:
+    ctx->error = TILING_EXCEED_MEM;
+    return -1;
+}
+
+void layoutRestore(tiling_t * ctx)
+{
+    tile_t * home = ctx->layoutHome;
+    if (!home) { return; }
+    tile_t * work = ctx->allTiles.tiles;
+    const size_t * order = ctx->layoutOrder;
+    for (size_t k = 0; k < ctx->allTiles.amount; k++)
+    {
+        tile_t * edge = work[k].edge;
+        home[order[k]].edge = edge ? &home[order[edge - work]] : NULL;
+    }
+    ctx->allTiles.tiles = home;
+    ctx->layoutHome = NULL;
+}
@@ -1,536 +1,363 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <errno.h>
 
-typedef char* err;
-union errData_u{
-    int i;
-    char c;
-} errData;
+#include "tiling.h"
 
-typedef struct point_s{
-    unsigned int x;
-    unsigned int y;
-} point_t;
+#define MAX_THREADS 1024        // --threads, darueber nur noch Speicher fuer Thread-Felder
 
-typedef struct tile_s{
-    struct tile_s * parent;
-    unsigned int depth;
-    struct tile_s * edge;
+const char wrongArg[]   = "Unknown or incomplete option '%s'!\n";
+const char wrongSize[]  = "Invalid size '%s' for option '%s'!\n";
+const char wrongMix[]   = "Option '%s' cannot be used with '%s'!\n";
 
-    struct tile_s * north;
-    struct tile_s * west;
-    struct tile_s * south;
-    struct tile_s * east;
-
-    point_t p;
-} tile_t;
-
-typedef struct allTiles_s{
-    unsigned int amount;
-   tile_t * tiles;
-} allTiles_t;
-
-err errMsg = NULL;
-
-const char wrongChar[]  = "'%c' is an unallowed character!\n";
-const char exceedMax[]  = "At least 1 coordinate is >2^32!\n";
-const char wrongCoor[]  = "Line %i does not contain exact 2 arguments!\n";
-const char doubleLine[] = "At least 2 lines containing the same tile!\n";
-const char exceedMem[]  = "Not enough memory available!\n";
-const char none[]       = "None\n";
-
-void readStdIn(allTiles_t* allTiles);
-void sort(tile_t * tiles, unsigned int begin, unsigned int end);
-void link(allTiles_t* allTiles);
-tile_t* search(allTiles_t * allTiles, unsigned int index, unsigned int findX, unsigned int findY);
-int findCoverage(allTiles_t * allTiles);
-int findAugmentedPath(allTiles_t * allTiles, tile_t* begin, tile_t*** p_tree, tile_t*** p_path);
-void addNeighbours(tile_t* middle, tile_t** tree, unsigned int* index);
-void resetTree(tile_t** tree);
-void flipPath(tile_t** path);
-void printResult(allTiles_t * allTiles);
-
-int main()
-{
-    allTiles_t allTiles;
-    allTiles.amount = 0;
-    allTiles.tiles = (tile_t *) malloc(sizeof(tile_t));
-    if (!allTiles.tiles)
-    {
-        errMsg = (err) exceedMem;
-        goto err0;
-    }
-
-    /* Parsing Input TODO: (ausser letzte Zeile)
-     * 
-     * Fehler Zahl > 2^32
-     * Fehler Char =/= ' ', '\t', 0123456789, '\n', '\r', "\r\n"
-     * Fehler 0, 1 oder >2 Eintraegen tritt auf
-     */
-    readStdIn(&allTiles);
-    if (errMsg) { goto err1; }
-    if (allTiles.amount == 0) { goto err2; }
-    
-    /* Sort input and build structure
-     *
-     * Fehler 2 Gleiche Zeilen
-     */
-    sort(allTiles.tiles, 0, allTiles.amount-1);
-    if (errMsg) { goto err1; }
-    link(&allTiles);
-    
-    /* Check for augmented paths
-     */
-    int result = findCoverage(&allTiles);    // returns 1 if there are unconnectable knotes
-    if (errMsg) { goto err1; }
-    
-    /* print result
-     *
-     * "None\n" falls nicht moeglich
-     * "" falls leere Eingabe
-     * "x_i y_i;x_j y_j" falls moeglich (2 benachbarte Kacheln)
-     */
-    if (result)
-    {
-        fprintf(stdout, none);
-    } else {
-        printResult(&allTiles);
-    }
-
-err2:
-err1:
-    free(allTiles.tiles);
-err0:
-    if (errMsg != NULL) { fprintf(stderr, errMsg, errData); }
-    
-    // */
-    return errMsg != NULL;
-}
-
-void printResult(allTiles_t * allTiles)
+/* Groesse einer Option lesen: nur Ziffern, mit suffix optional K, M oder G;
+ * Rueckgabe 0 bei Erfolg, -1 bei fremden Zeichen, Suffixen oder Ueberlauf
+ */
+static int parseSize(const char * text, int suffix, size_t * size)
 {
-    for (unsigned int i = 0; i < allTiles->amount; i++)
+    if (*text < '0' || *text > '9') { return -1; }
+    char * end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno == ERANGE || value > SIZE_MAX) { return -1; }
+    int shift = 0;
+    if (suffix && *end)
     {
-        tile_t * current = &allTiles->tiles[i];
-        if (!current->parent)
+        switch (*end)
         {
-            tile_t * other = current->edge;
-
-            fprintf(stdout, "%u %u;%u %u\n", current->p.x, current->p.y, other->p.x, other->p.y);
-
-            current->parent = current;
-            other->parent = other;
+            case 'K': shift = 10; break;
+            case 'M': shift = 20; break;
+            case 'G': shift = 30; break;
+            default: return -1;
         }
+        end++;
     }
-    return;
-}
-
-void flipPath(tile_t** path)
-{
-    for (unsigned int i =  0; path[i]; i = i + 2)
-    {
-        path[i]->edge = path[i+1];
-        path[i+1]->edge = path[i];
-    }
-    return;
-}
-
-void resetTree(tile_t** tree)
-{
-    for (unsigned int i = 0; tree[i]; i++)
-    {
-        tree[i]->parent = NULL;
-    }
-    return;
+    if (*end || value > (SIZE_MAX >> shift)) { return -1; }
+    *size = (size_t) value << shift;
+    return 0;
 }
 
-void addNeighbours(tile_t* middle, tile_t** tree, unsigned int* index)
+/* Kommandozeilenprogramm, die eigentliche Arbeit macht libtiling; nur
+ * ueber die oeffentliche Schnittstelle (tiling.h)
+ */
+int main(int argc, char** argv)
 {
-    if (middle->north)
-    {
-        if (!middle->north->parent)
-        {
-            tree[*index] = middle->north;
-            tree[*index]->depth = middle->depth +1;
-            tree[(*index)++]->parent = middle;
-        }
-    }
-    if (middle->west)
-    {
-        if (!middle->west->parent)
-        {
-            tree[*index] = middle->west;
-            tree[*index]->depth = middle->depth +1;
-            tree[(*index)++]->parent = middle;
-        }
-    }
-    if (middle->south)
+    /* Optionen
+     *
+     * --count       Anzahl der Parkettierungen (mod p und ln) statt einer Loesung
+     * --stream      nach x sortierte Eingabe spaltenweise loesen (Breite <= 32)
+     * --threads N   Anzahl der Threads fuer parallele Abschnitte (0 = alle Kerne, hoechstens 1024)
+     * --external    Eingabe ueber sortierte Laeufe in temporaeren Dateien, Kacheln per mmap
+     * --run-size N  Kacheln je Lauf fuer --external
+     * --stats       Statistiken auf stderr (auch Speicher je Phase)
+     * --memory-budget N  Heap hoechstens N Bytes (Suffix K, M, G); grosse Dateien werden extern gelesen
+     * --edit        Bearbeitungsskript (+/- Kacheln, Leerzeile = Stapel) inkrementell loesen
+     * --batch       viele Instanzen (durch Leerzeilen getrennt) auf --threads Workern loesen
+     * --cache VERZ  Ergebnisse im Verzeichnis zwischenspeichern (nicht mit --count)
+     * --cache-verify  Cache-Treffer vor der Ausgabe pruefen
+     * --engine NAME  Loeser festlegen: auto (Voreinstellung), general, tiny, shapes, init, mincost
+     * --layout NAME  Kacheln fuer die Suchen umordnen: sorted (Voreinstellung), morton, hilbert
+     * --init-match  wie --engine init: Startzuordnung parallel auf --threads Kernen
+     * --shapes      wie --engine shapes: Komponenten gleicher Form nur einmal loesen
+     * --cost H,V    wie --engine mincost: Parkettierung minimaler Kosten, horizontale Dominos kosten H, vertikale V
+     * --weights DATEI  Kosten einzelner Dominos, je Zeile "x1 y1;x2 y2 kosten" (schaltet auf --engine mincost)
+     * --progressive fertige Komponenten sofort ausgeben, letzte Zeile "OK" oder "None"
+     *               (nicht mit --engine, --layout, --cache und den Schaltern fuer Loeser)
+     * --sorted-output  mit --progressive in der ueblichen sortierten Reihenfolge
+     * --counters text|json  Zeit und Hardware-Zaehler je Phase auf stderr (nicht mit --stream, --edit, --batch, --serve)
+     * --cross-check  Loeser (--engine, --layout) und die Suche aus floesung.c vergleichen (Bericht auf stderr)
+     * --serve PFAD  Dienst auf einem Unix-Domain-Socket mit --threads Workern (Client: loesung-client)
+     */
+    int countMode = 0;
+    int streamMode = 0;
+    int editMode = 0;
+    int batchMode = 0;
+    int externalMode = 0;
+    tilingEngine_t engine = TILING_ENGINE_AUTO;
+    tilingLayout_t layout = TILING_LAYOUT_SORTED;
+    const char * engineOption = NULL;   // zuletzt gesetzter Loeser bzw. Reihenfolge, fuer --progressive
+    const char * layoutOption = NULL;
+    int progressive = 0;
+    int crossCheck = 0;
+    int mismatch = 0;
+    int sortedOutput = 0;
+    int costSet = 0;
+    int costHorizontal = 0;
+    int costVertical = 0;
+    const char * weightPath = NULL;
+    const char * servePath = NULL;
+    const char * cacheDir = NULL;
+    int cacheVerify = 0;
+    int stats = 0;
+    int counters = 0;               // 1: Text, 2: JSON
+    int solved = 0;                 // Speicher je Phase nur im normalen Ablauf
+    tilingStats_t report;
+    unsigned int threads = 0;
+    size_t runSize = (size_t) 1 << 23;
+    size_t budget = 0;
+    for (int a = 1; a < argc; a++)
     {
-        if (!middle->south->parent)
+        if (!strcmp(argv[a], "--count")) { countMode = 1; continue; }
+        if (!strcmp(argv[a], "--stream")) { streamMode = 1; continue; }
+        if (!strcmp(argv[a], "--edit")) { editMode = 1; continue; }
+        if (!strcmp(argv[a], "--batch")) { batchMode = 1; continue; }
+        if (!strcmp(argv[a], "--external")) { externalMode = 1; continue; }
+        if (!strcmp(argv[a], "--stats")) { stats = 1; continue; }
+        if (!strcmp(argv[a], "--shapes"))
         {
-            tree[*index] = middle->south;
-            tree[*index]->depth = middle->depth +1;
-            tree[(*index)++]->parent = middle;
+            engine = TILING_ENGINE_SHAPES;
+            engineOption = argv[a];
+            continue;
         }
-    }
-    if (middle->east)
-    {
-        if (!middle->east->parent)
+        if (!strcmp(argv[a], "--init-match"))
         {
-            tree[*index] = middle->east;
-            tree[*index]->depth = middle->depth +1;
-            tree[(*index)++]->parent = middle;
+            engine = TILING_ENGINE_INIT;
+            engineOption = argv[a];
+            continue;
         }
-    }
-    return;
-}
-
-int findAugmentedPath(allTiles_t * allTiles, tile_t* begin, tile_t*** p_tree, tile_t*** p_path)
-{   
-    tile_t** path = *p_path;
-    // -1 Error
-    // 0 Found Path
-    // 1 No Path
-    unsigned int length = 8;
-    tile_t ** tree = (tile_t**) realloc(*p_tree, length * sizeof(tile_t*));
-    if (!tree) { errMsg = (err) exceedMem; *p_tree[0] = NULL; return -1; }
-    *p_tree = tree;
-
-    unsigned int i = 0;
-    unsigned int j = 1;
-    int error = 1;
-    tree[0] = begin;
-    tree[0]->depth = 0;
-    addNeighbours(tree[0], tree, &j);
-    i++;
-    do
-    {
-        if ( i >= j ) { error = 1; break; }
-        if ( j >= length -4 )
+        if (!strcmp(argv[a], "--engine") && a+1 < argc && !tilingEngineByName(argv[a+1], &engine))
         {
-            length = length *2;
-            if (length > allTiles->amount) { length = allTiles->amount; }
-            tile_t ** temp1 = realloc(tree, length * sizeof(tile_t*));
-            if (!temp1) { error = -1; break; }
-            *p_tree = tree = temp1;
+            engineOption = argv[a++];
+            continue;
         }
-        if (!tree[i]->edge)
+        if (!strcmp(argv[a], "--cost") && a+1 < argc)
         {
-            error = 0;
-            break;
-        } else {
-            if ( tree[i]->parent != tree[i]->edge )
+            char * mid;
+            char * end = NULL;
+            long h = strtol(argv[a+1], &mid, 10);
+            long v = *mid == ',' ? strtol(mid + 1, &end, 10) : 0;
+            if (mid != argv[a+1] && *mid == ',' && end != mid + 1 && !*end
+                && h >= INT_MIN && h <= INT_MAX && v >= INT_MIN && v <= INT_MAX)
             {
-                tree[j] = tree[i]->edge;
-                tree[j]->depth = tree[i]->depth +1;
-                tree[j++]->parent = tree[i];
-                i++;
+                costSet = 1;
+                costHorizontal = (int) h;
+                costVertical = (int) v;
+                engine = TILING_ENGINE_MINCOST;
+                engineOption = argv[a++];
                 continue;
             }
         }
-        addNeighbours(tree[i], tree, &j);
-        i++;
-    } while ( i < allTiles->amount );
-    
-    if (!error)
-    {
-        path[0] = tree[i];
-        tile_t** temp2 = (tile_t**) realloc(path, (tree[i]->depth+2) * sizeof(tile_t*));
-        if ( !temp2 )
-        { 
-            error = -1;
-            errMsg = (err) exceedMem;
-        } else{
-    
-            *p_path = path = temp2;
-            unsigned int copyindex = 0;
-            do
-            {
-                path[copyindex+1] = path[copyindex]->parent;
-            } while (path[++copyindex]->parent);
-            path[copyindex+1] = NULL;
-            tree[j] = NULL;
+        if (!strcmp(argv[a], "--weights") && a+1 < argc)
+        {
+            engineOption = argv[a];
+            weightPath = argv[++a];
+            engine = TILING_ENGINE_MINCOST;
+            continue;
         }
-    } else {
-        if (error == -1) { errMsg = (err) exceedMem; }
-    }
-    return error;
-}
-
-int findCoverage(allTiles_t * allTiles)
-{
-    int result = 0;
-    for (unsigned int i = 0; i < allTiles->amount; i++)
-    {
-        if(allTiles->tiles[i].edge) { continue; }
-        tile_t** tree = (tile_t**) malloc(sizeof(tile_t*));
-        tile_t** path = (tile_t**) malloc(sizeof(tile_t*));
-
-        if (!tree) { errMsg = (err) exceedMem; return -1; }
-        if (!path) { errMsg = (err) exceedMem; free(tree); return -1; }
-
-        result = findAugmentedPath(allTiles, &allTiles->tiles[i], &tree, &path);
-        if( !result )
+        if (!strcmp(argv[a], "--progressive")) { progressive = 1; continue; }
+        if (!strcmp(argv[a], "--cross-check")) { crossCheck = 1; continue; }
+        if (!strcmp(argv[a], "--sorted-output")) { sortedOutput = 1; continue; }
+        if (!strcmp(argv[a], "--layout") && a+1 < argc)
         {
-            flipPath(path); 
-            resetTree(tree);
+            layoutOption = argv[a];
+            const char * name = argv[++a];
+            if (!strcmp(name, "sorted")) { layout = TILING_LAYOUT_SORTED; continue; }
+            if (!strcmp(name, "morton")) { layout = TILING_LAYOUT_MORTON; continue; }
+            if (!strcmp(name, "hilbert")) { layout = TILING_LAYOUT_HILBERT; continue; }
+            layoutOption = NULL;
+            a--;
         }
-
-        free(path);
-        free(tree);
-
-        if (result < 0) { break; }
-    }
-
-    return result;
-}
-
-tile_t* search(allTiles_t * allTiles, unsigned int index, unsigned int findX, unsigned int findY)
-{
-    while (index < allTiles->amount)
-    {
-        if (allTiles->tiles[index].p.x < findX) { index++; continue; }
-        if (allTiles->tiles[index].p.x == findX)
+        if (!strcmp(argv[a], "--counters") && a+1 < argc)
         {
-            if (allTiles->tiles[index].p.y < findY) { index++; continue; }
-            if (allTiles->tiles[index].p.y == findY)
-            {
-                return &allTiles->tiles[index];
-            }
+            const char * format = argv[++a];
+            if (!strcmp(format, "text")) { counters = 1; continue; }
+            if (!strcmp(format, "json")) { counters = 2; continue; }
+            a--;
         }
-        break;
-    }
-
-    return NULL;
-}
-
-void link(allTiles_t* allTiles)
-{
-    unsigned int i = 0;
-    while ( i < allTiles->amount-1 )
-    {
-        tile_t * current = &allTiles->tiles[i];
-        unsigned int cx = current->p.x;
-        unsigned int cy = current->p.y;
-
-        tile_t * north = search(allTiles, i, cx, cy + 1);
-        if (north)
+        if (!strcmp(argv[a], "--memory-budget") && a+1 < argc)
         {
-            current->north = north;
-            north->south = current;
-            if (!current->edge && !north->edge)
+            if (parseSize(argv[a+1], 1, &budget))
             {
-                current->edge = north;
-                north->edge = current;
+                fprintf(stderr, wrongSize, argv[a+1], argv[a]);
+                return 1;
             }
+            a++;
+            continue;
         }
-        tile_t * east = search(allTiles, i, cx + 1, cy);
-        if (east)
+        if (!strcmp(argv[a], "--run-size") && a+1 < argc)
         {
-            current->east = east;
-            east->west = current;
-            if (!current->edge && !east->edge)
+            if (parseSize(argv[a+1], 0, &runSize) || !runSize)
             {
-                current->edge = east;
-                east->edge = current;
+                fprintf(stderr, wrongSize, argv[a+1], argv[a]);
+                return 1;
             }
-        }
-        i++;
-    }
-    return; 
-}
-
-void sort(tile_t * tiles, unsigned int begin, unsigned int end)
-{
-    if ( (end - begin) == 0) { return; }
-
-    unsigned int mid = (begin + end)/2;
-    sort(tiles, begin, mid);
-    if (errMsg) { return; }
-    sort(tiles, mid+1, end);
-    if (errMsg) { return; }
-
-    point_t holder[end-begin +1];
-    unsigned int i = begin;
-    unsigned int j = mid +1;
-    unsigned int k = 0;
-
-    while (i <= mid && j <= end)
-    {
-        if (tiles[i].p.x < tiles[j].p.x)
-        {
-            holder[k].x = tiles[i].p.x;
-            holder[k].y = tiles[i].p.y;
-            k++;
-            i++;
+            a++;
             continue;
         }
-        if (tiles[i].p.x > tiles[j].p.x)
+        if (!strcmp(argv[a], "--cache-verify")) { cacheVerify = 1; continue; }
+        if (!strcmp(argv[a], "--cache") && a+1 < argc)
         {
-            holder[k].x = tiles[j].p.x;
-            holder[k].y = tiles[j].p.y;
-            k++;
-            j++;
+            cacheDir = argv[++a];
             continue;
         }
-        if (tiles[i].p.y < tiles[j].p.y)
+        if (!strcmp(argv[a], "--serve") && a+1 < argc)
         {
-            holder[k].x = tiles[i].p.x;
-            holder[k].y = tiles[i].p.y;
-            k++;
-            i++;
+            servePath = argv[++a];
             continue;
-        } else 
-        if (tiles[i].p.y > tiles[j].p.y)
+        }
+        if (!strcmp(argv[a], "--threads") && a+1 < argc)
         {
-            holder[k].x = tiles[j].p.x;
-            holder[k].y = tiles[j].p.y;
-            k++;
-            j++;
+            size_t value;
+            if (parseSize(argv[a+1], 0, &value) || value > MAX_THREADS)
+            {
+                fprintf(stderr, wrongArg, argv[a]);
+                return 1;
+            }
+            threads = (unsigned int) value;
+            a++;
             continue;
         }
-        errMsg = (err) doubleLine;
-        return;
+        fprintf(stderr, wrongArg, argv[a]);
+        return 1;
     }
-    while ( i <= mid )
+
+    // --progressive loest selbst je Komponente, Loeser, Reihenfolge und Cache gaebe es dort nicht
+    if (progressive && !countMode)
     {
-        holder[k].x = tiles[i].p.x;
-        holder[k].y = tiles[i].p.y;
-        k++;
-        i++;
+        const char * ignored = engineOption ? engineOption : layoutOption ? layoutOption
+                             : cacheDir ? "--cache" : cacheVerify ? "--cache-verify" : NULL;
+        if (ignored)
+        {
+            fprintf(stderr, wrongMix, ignored, "--progressive");
+            return 1;
+        }
     }
-    
-    i = begin;
-    k = 0;
-    while ( i < j )
+
+    tiling_t * ctx = tilingCreate();
+    if (!ctx)
     {
-        tiles[i].p.x = holder[k].x;
-        tiles[i].p.y = holder[k].y;
-        i++;
-        k++;
+        fprintf(stderr, "Not enough memory available!\n");
+        return 1;
     }
-    return;
-}
 
-void readStdIn(allTiles_t* allTiles)
-{
-    char c;
-    int i = 0;
-    // File
-    while ( (c = getchar()) != EOF)
+    if (streamMode)
+    {
+        tilingStream(ctx, stdin);
+        goto err0;
+    }
+    if (editMode)
+    {
+        tilingEdit(ctx, stdin);
+        goto err0;
+    }
+    if (servePath)
+    {
+        tilingServe(ctx, servePath, threads, stats);
+        goto err0;
+    }
+    if (batchMode)
     {
-        i++;
-        // Line
-        unsigned long a = 0;
-        unsigned long b = 0;
+        tilingBatch(ctx, stdin, threads, stats);
+        goto err0;
+    }
 
-        // ' '*
-        while ( c == ' ' || c == '\t' ) { c = getchar(); }
-        
-        if (c == '\n' || c == '\r')
-        {
-            printf("HERE!");
-            errMsg = (err) wrongCoor;
-            errData.i = i;
-            return;
-        }
-        // 0-9+
-        if (c >= '0' && c <= '9')
-        {
-            do
-            {
-                a = a*10 + (unsigned long) c -48; 
-                if ( a >= 4294967296 )
-                {
-                    errMsg = (err) exceedMax;
-                    return;
-                }
-            } while ( (c = getchar()) >= '0' && c <= '9');
-        }
-        else
-        {
-            errMsg = (err) wrongChar;
-            errData.c = c;
-            return;
-        }
+    if (counters && tilingSetCounters(ctx)) { goto err0; }
+    solved = 1;
 
-        // ' '+
-        if (c == '\n' || c == '\r')
-        {
-            errMsg = (err) wrongCoor;
-            errData.i = i;
-            return;
-        }
-        if ( c == ' ' || c == '\t')
-        {
-            do { c = getchar(); } while( c == ' ' || c == '\t' );
-        }
-        else
-        {
-            errMsg = (err) wrongChar;
-            errData.c = c;
-            return;
-        }
+    /* Budget: passt die Eingabe (als Datei) nicht, wird extern eingelesen;
+     * komprimierte Dateien nicht, die kann nur tilingLoadParallel()
+     */
+    tilingSetMemoryBudget(ctx, budget);
+    int planned = budget ? tilingPlanInput(ctx, stdin, &runSize) : 0;
+    if (planned < 0) { goto err0; }
+    if (planned && !externalMode)
+    {
+        if (stats) { fprintf(stderr, "plan: input exceeds the memory budget -> external\n"); }
+        externalMode = 1;
+    }
 
-        if (c == '\n' || c == '\r')
-        {
-            errMsg = (err) wrongCoor;
-            errData.i = i;
-            return;
-        }
-        // 0-9+
-        if (c >= '0' && c <= '9')
-        {
-            do
-            {
-                b = b*10 + (unsigned long) c -48; 
-                if ( b >= 4294967296 )
-                {
-                    errMsg = (err) exceedMax;
-                    return;
-                }
-            } while ( (c = getchar()) >= '0' && c <= '9');
-        }
-        else
-        {
-            errMsg = (err) wrongChar;
-            errData.c = c;
-            return;
-        }
+    /* Parsing Input TODO: (ausser letzte Zeile)
+     *
+     * Fehler Zahl > 2^32
+     * Fehler Char =/= ' ', '\t', 0123456789, '\n', '\r', "\r\n"
+     * Fehler 0, 1 oder >2 Eintraegen tritt auf
+     */
+    if (externalMode)
+    {
+        tilingLoadExternal(ctx, stdin, runSize, stats);    // liefert schon sortiert
+    } else {
+        tilingLoadParallel(ctx, stdin, threads);    // Stuecke auf --threads Kernen, gzip/zstd entpackt
+    }
+    if (tilingError(ctx)) { goto err0; }
+    if (progressive && !countMode)
+    {
+        tilingProgressive(ctx, stdout, sortedOutput);
+        goto err0;
+    }
 
-        // ' '*
-        while (c == ' ' || c == '\t') { c = getchar(); }
+    /* Sortieren, Verbinden, augmentierende Wege
+     *
+     * der Zaehlmodus braucht die verbundenen Kacheln, also kein Cache
+     */
+    if (!countMode) { tilingSetCache(ctx, cacheDir, cacheVerify); }
+    tilingSetEngine(ctx, engine, threads);
+    tilingSetLayout(ctx, layout);
+    if (costSet) { tilingSetCost(ctx, costHorizontal, costVertical); }
+    if (weightPath && tilingLoadWeights(ctx, weightPath)) { goto err0; }
+    int result;
+    if (crossCheck)
+    {
+        // --engine (sonst Planer) gegen die Suche aus floesung.c, ohne Cache; bei Widerspruch keine Ausgabe
+        tilingCross_t report;
+        mismatch = tilingCrossCheck(ctx, &report);
+        if (mismatch < 0) { goto err0; }
+        tilingPrintCross(&report, stderr);
+        if (mismatch) { goto err0; }
+        result = report.result[0];
+    } else {
+        result = tilingSolve(ctx);
+    }
+    if (result < 0) { goto err0; }
+    if (stats)
+    {
+        tilingPrintPlan(ctx, stderr);
+        tilingStats(ctx, &report);
+    }
+    if (stats && tilingEngine(ctx) == TILING_ENGINE_INIT)
+    {
+        fprintf(stderr, "init: %zu free after greedy, %zu free after %u parallel rounds on %u threads\n",
+                report.initGreedyFree, report.initFree, report.initRounds, report.initThreads);
+    }
+    if (stats && tilingEngine(ctx) == TILING_ENGINE_SHAPES)
+    {
+        fprintf(stderr, "shapes: %zu components, %zu distinct\n", report.components, report.shapes);
+    }
+    if (stats && tilingEngine(ctx) == TILING_ENGINE_MINCOST)
+    {
+        fprintf(stderr, "mincost: total cost %lld, %zu searches after the tight greedy matching, %zu tiles visited\n",
+                tilingCost(ctx), report.costPaths, report.costVisited);
+    }
 
-        allTiles->amount++;
-        tile_t* temp = (tile_t*) realloc(allTiles->tiles, allTiles->amount*sizeof(tile_t));
-        if (!temp)
-        {
-            errMsg = (err) exceedMem;
-            return;
-        }
+    /* Zaehlmodus
+     *
+     * die gefundene Ueberdeckung dient als Referenz fuer das Vorzeichen der Determinante
+     */
+    if (countMode)
+    {
+        tilingCount(ctx, !result, threads);
+        goto err0;
+    }
 
-        temp[allTiles->amount-1].p.x = (unsigned int) a;
-        temp[allTiles->amount-1].p.y = (unsigned int) b;
-        temp[allTiles->amount-1].edge= NULL;
-        temp[allTiles->amount-1].parent = NULL;
-        temp[allTiles->amount-1].north = NULL;
-        temp[allTiles->amount-1].south = NULL;
-        temp[allTiles->amount-1].west = NULL;
-        temp[allTiles->amount-1].east = NULL;
+    /* print result
+     *
+     * "None\n" falls nicht moeglich
+     * "" falls leere Eingabe
+     * "x_i y_i;x_j y_j" falls moeglich (2 benachbarte Kacheln)
+     */
+    tilingPrint(ctx, result, stdout);
 
-        allTiles->tiles = temp;
-        
-        if ( c == EOF) {
-            printf("TEST!\n");
-            break;
-        }
-        if ( c != '\n' && c != '\r')
-        {
-            errMsg = (err) wrongCoor;
-            errData.i = i;
-            return;
-        }
+err0:
+    if (stats && solved) { tilingPrintMemory(ctx, stderr); }
+    if (counters && solved)
+    {
+        fflush(stdout);     // gepufferte Ausgabe gehoert noch zur letzten Phase
+        tilingPrintCounters(ctx, stderr, counters == 2);
     }
-    return;
+    tilingPrintError(ctx, stderr);
+    int status = tilingError(ctx) != TILING_OK || mismatch > 0;
+    tilingFree(ctx);
+    return status;
 }
-
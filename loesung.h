@@ -0,0 +1,322 @@
+#ifndef LOESUNG_H
+#define LOESUNG_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+#include "tiling.h"
+
+union errData_u{
+    size_t i;                   // Zeilennummer
+    char c;
+    char* s;
+};
+
+typedef struct tile_s{
+    struct tile_s * parent;
+    size_t depth;
+    struct tile_s * edge;
+
+    struct tile_s * north;
+    struct tile_s * west;
+    struct tile_s * south;
+    struct tile_s * east;
+
+    point_t p;
+} tile_t;
+
+typedef struct input_s{
+    FILE * in;
+    size_t line;
+    unsigned long long offset;  // gelesene Bytes
+} input_t;
+
+typedef struct allTiles_s{
+    size_t amount;
+   tile_t * tiles;
+} allTiles_t;
+
+typedef struct tinyMemo_s tinyMemo_t;
+typedef struct probe_s probe_t;
+
+/* Phasen fuer Zaehler (probe.c) und Speicher (memory.c)
+ */
+typedef enum phase_e{
+    PHASE_PARSE = 0,
+    PHASE_SORT,
+    PHASE_LINK,
+    PHASE_MATCH,
+    PHASE_COUNT,
+    PHASE_PRINT,
+    PHASES
+} phase_t;
+
+/* Heap-Bytes des Kontexts (memory.c), budget 0 = unbegrenzt
+ */
+typedef struct memory_s{
+    atomic_size_t current;
+    atomic_size_t peak;
+    atomic_size_t phasePeak[PHASES];
+    size_t budget;
+    phase_t phase;
+    int used[PHASES];
+} memory_t;
+
+/* Kennzahlen des Planers (planner.c), components nur falls gezaehlt
+ */
+typedef struct plan_s{
+    size_t amount;
+    double density;             // Kacheln je Feld der Bounding Box
+    size_t oddRuns;             // ungerade Laeufe in den Spalten
+    unsigned int width;         // Ausdehnung in y
+    long long balance;          // schwarze minus weisse Kacheln
+    size_t components;
+    tilingEngine_t engine;      // benutzter Loeser
+    int budgetBound;            // wegen --memory-budget sparsamer geplant
+} plan_t;
+
+/* ein Domino aus der Gewichtsdatei (mincost.c), a vor b sortiert
+ */
+typedef struct weight_s{
+    point_t a;
+    point_t b;
+    int cost;
+} weight_t;
+
+/* Kontext (tiling.h)
+ *
+ * Alle Puffer gehoeren dem Kontext und werden ueber Instanzen hinweg
+ * wiederverwendet; cap* ist jeweils die allokierte Anzahl.
+ */
+struct tiling_s{
+    allTiles_t allTiles;
+    size_t capTiles;
+    int sorted;                 // Kacheln liegen schon sortiert vor (--external)
+    int tileable;               // letzte Loesung ist eine Parkettierung
+
+    point_t * holder;           // Puffer fuer sort()
+    size_t capHolder;
+    tile_t ** tree;             // Suchbaum von findAugmentedPath()
+    size_t capTree;
+    tile_t ** path;
+    size_t capPath;
+
+    size_t cursor;              // tilingNext()
+
+    int mapFd;                  // Dateiabbildung von tilingLoadExternal(), sonst -1
+    size_t mapBytes;
+
+    size_t ringSlots;           // Ring von loadCompressed(), 0 = nicht komprimiert
+    size_t ringBlock;
+
+    tinyMemo_t * tinyMemo;      // Bitboard-Loeser (tiny.c)
+
+    const char * cacheDir;      // Ergebnis-Cache (cache.c), NULL = aus
+    int cacheVerify;
+    unsigned long long cacheKey;
+
+    tilingEngine_t engine;      // gewaehlter Loeser, AUTO = Planer
+    plan_t plan;
+
+    tilingLayout_t layout;      // Reihenfolge fuer die Suchen (layout.c)
+    tile_t * layoutTiles;       // umgeordnete Kopie
+    size_t * layoutOrder;       // Platz in der Kopie -> sortierter Platz
+    size_t capLayout;
+    tile_t * layoutHome;        // sortiertes Feld, solange die Kopie aktiv ist
+
+    unsigned int threads;       // 0 = alle Kerne
+    size_t initGreedyFree;      // freie Kacheln, haette linkTiles() gierig zugeordnet
+    size_t initFree;            // freie Kacheln nach initMatching()
+    unsigned int initRounds;
+    unsigned int initThreads;   // tatsaechlich benutzt
+
+    size_t amountComponents;    // shapes.c
+    size_t amountShapes;
+    int shapesOff;              // tilingSetShapes(ctx, 0): der Planer waehlt nie SHAPES
+    size_t * compRank;          // Komponenten aus planLinked(), uebernimmt shapeSolve()
+    size_t * compMember;
+    struct component_s * comps;
+    size_t amountComps;
+
+    int costHorizontal;         // mincost.c
+    int costVertical;
+    weight_t * weights;
+    size_t amountWeights;
+    size_t capWeights;
+    long long costTotal;        // Summe der letzten Loesung
+    size_t costPaths;           // Suchen nach der gierigen Zuordnung
+    size_t costVisited;         // fertige Kacheln aller Suchen
+
+    probe_t * probe;            // Zaehler je Phase (probe.c), NULL = aus
+    memory_t mem;
+
+    tilingErr_t error;
+    union errData_u errData;
+};
+
+extern const char none[];
+
+void printError(FILE * out, tilingErr_t error, union errData_u errData);
+
+int readLine(tiling_t * ctx, input_t * input, point_t * p);
+int readBlank(input_t * input);
+void sort(tiling_t * ctx, size_t begin, size_t end);
+int sortTiles(tiling_t * ctx);
+void linkTiles(allTiles_t* allTiles);
+void linkNeighbours(allTiles_t* allTiles);     // wie linkTiles(), ohne gierige Zuordnung
+tile_t* search(allTiles_t * allTiles, size_t index, unsigned int findX, unsigned int findY);
+int findCoverage(tiling_t * ctx);
+int findAugmentedPath(tiling_t * ctx, size_t amount, tile_t* begin);
+void addNeighbours(tile_t* middle, tile_t** tree, size_t* index);
+void resetTree(tile_t** tree);
+void flipPath(tile_t** path);
+void printResult(tiling_t * ctx, FILE * out);
+
+/* Ergebnis als Text an einen wachsenden Puffer anhaengen (Stapel, Dienst)
+ *
+ * 0: angehaengt, -1: kein Speicher
+ */
+int appendBytes(char ** out, size_t * len, size_t * cap, const char * bytes, size_t amount);
+int formatDomino(point_t a, point_t b, char ** out, size_t * len, size_t * cap);
+int formatResult(tiling_t * ctx, int result, char ** out, size_t * len, size_t * cap);
+
+/* extsort.c
+ *
+ * Kachelfeld von tilingLoadExternal() wieder freigeben; externalBytes()
+ * schaetzt den Heap beim Mischen von tiles Kacheln in Laeufen zu runSize
+ */
+void releaseExternal(tiling_t * ctx);
+size_t externalBytes(const tiling_t * ctx, size_t tiles, size_t runSize);
+
+/* incremental.c
+ *
+ * Loeserzustand mit Einfuegen und Entfernen einzelner Kacheln; nach jeder
+ * Aenderung hoechstens eine augmentierende Suche. Fehler und Suchpuffer
+ * kommen aus dem Kontext.
+ */
+typedef struct solver_s solver_t;
+
+solver_t * solverCreate(tiling_t * ctx);
+void solverFree(solver_t * s);
+int solverInsert(solver_t * s, point_t p);
+int solverRemove(solver_t * s, point_t p);
+int solverTileable(const solver_t * s);
+int solverPrint(const solver_t * s, FILE * out);
+
+/* tiny.c
+ *
+ * Bitboard-Loeser fuer Instanzen mit Bounding Box bis 8x8
+ */
+int tinyFits(const tiling_t * ctx);
+int tinySolve(tiling_t * ctx);
+
+/* cache.c
+ *
+ * Ergebnis-Cache auf der Platte, Schluessel ist ein Hash der sortierten
+ * Kacheln; ein Treffer ersetzt linkTiles() und findCoverage()
+ */
+int cacheLookup(tiling_t * ctx);
+void cacheStore(tiling_t * ctx, int result);
+
+/* shapes.c
+ *
+ * Zusammenhangskomponenten nach linkTiles(): member listet die Kacheln
+ * gruppiert nach Komponente (in sortierter Reihenfolge), rank ist der Platz
+ * einer Kachel in ihrer Komponente. Komponenten sind nach ihrer ersten
+ * Kachel geordnet.
+ *
+ * shapeSolve() fasst Komponenten nach Form zusammen und augmentiert je Form
+ * einmal; Rueckgabe wie findCoverage(). Hat planLinked() die Komponenten
+ * schon bestimmt (ctx->comps), werden sie uebernommen statt neu gesucht.
+ */
+typedef struct component_s{
+    size_t begin;           // erste Kachel in member
+    size_t amount;
+    unsigned int minX;
+    unsigned int minY;
+    unsigned long long hash;
+    size_t shape;           // Komponente mit gleicher Form, die geloest wird
+} component_t;
+
+int findComponents(tiling_t * ctx, size_t * rank, size_t * member, component_t ** comps, size_t * amountComps);
+int shapeSolve(tiling_t * ctx);
+
+/* mincost.c
+ *
+ * nach linkTiles() die Parkettierung minimaler Kosten ueber kuerzeste
+ * augmentierende Wege (Dijkstra mit Potentialen); Rueckgabe wie findCoverage()
+ */
+int mincostSolve(tiling_t * ctx);
+
+/* matchinit.c
+ *
+ * Startzuordnung nach linkNeighbours() parallel in Runden bilden
+ * (Vorschlaege an den Nachbarn mit kleinstem Grad) statt gierig
+ */
+int initMatching(tiling_t * ctx);
+
+/* layout.c
+ *
+ * verbundene Kacheln in Morton- oder Hilbert-Reihenfolge kopieren und die
+ * Zuordnung danach in das sortierte Feld zurueckschreiben
+ */
+int layoutTiles(tiling_t * ctx);
+void layoutRestore(tiling_t * ctx);
+
+/* planner.c
+ *
+ * Loeser nach sort() aus billigen Kennzahlen waehlen; planSorted() liefert
+ * AUTO, wenn erst planLinked() ueber die Komponenten entscheidet
+ */
+tilingEngine_t planSorted(tiling_t * ctx);
+tilingEngine_t planLinked(tiling_t * ctx);
+int planLayout(tiling_t * ctx);
+
+/* memory.c
+ *
+ * alle Puffer des Kontexts mit Kopf fuer die Groesse, abgerechnet gegen
+ * das Budget; tilingPhase() schaltet Speicher- und Zaehlerphase weiter
+ */
+void * memAlloc(tiling_t * ctx, size_t bytes);
+void * memCalloc(tiling_t * ctx, size_t amount, size_t size);
+void * memRealloc(tiling_t * ctx, void * p, size_t bytes);
+void memFree(tiling_t * ctx, void * p);
+int memFits(const tiling_t * ctx, size_t bytes);
+void tilingPhase(tiling_t * ctx, phase_t phase);
+
+/* probe.c
+ *
+ * Zeit und perf_event-Zaehler je Phase, fehlende Zaehler werden ausgelassen;
+ * alle Funktionen nehmen auch NULL (aus)
+ */
+
+extern const char * const phaseNames[PHASES];
+
+probe_t * probeCreate(void);
+void probeFree(probe_t * probe);
+void probePhase(probe_t * probe, phase_t phase);
+void probePrint(const probe_t * probe, FILE * out, int json);
+
+/* parse.c
+ *
+ * Text an die schon geladenen Kacheln anhaengen (Zeilennummern ab *lines)
+ */
+int parseAppend(tiling_t * ctx, const char * text, size_t len, unsigned int threads, size_t * lines);
+
+/* decompress.c
+ *
+ * gzip/zstd an der Kennung erkennen und auf einem eigenen Thread in einen
+ * Ring von Bloecken entpacken, die parseAppend() verarbeitet; head ist der
+ * schon gelesene Anfang der Eingabe
+ */
+typedef enum codec_e{
+    CODEC_NONE = 0,
+    CODEC_GZIP,
+    CODEC_ZSTD
+} codec_t;
+
+codec_t detectCodec(const unsigned char * head, size_t len);
+codec_t fileCodec(int fd);
+int loadCompressed(tiling_t * ctx, FILE * in, const char * head, size_t headLen, codec_t codec, unsigned int threads);
+
+#endif
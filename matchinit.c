@@ -0,0 +1,339 @@
+/* Parallele Startzuordnung (--init-match)
+ *
+ * linkTiles() ordnet nebenbei gierig zu (erst Nord, dann Ost). Mit
+ * --init-match verbindet tilingSolve() nur (linkNeighbours()), und die
+ * Startzuordnung entsteht hier auf bis zu INIT_MAX_THREADS Kernen in drei
+ * Stufen, jeder Thread auf einem gleich grossen Bereich des Feldes:
+ *
+ * Erzwungene Paare: eine freie Kachel mit genau einem freien Nachbarn
+ * schlaegt diesen vor, der Nachbar nimmt den kleinsten Vorschlag an (wer
+ * selbst vorschlaegt, nur den eigenen Partner). Das wiederholt sich, bis
+ * keine neuen Paare entstehen.
+ *
+ * Gierig: wie linkTiles(), aber nur mit Partnern im eigenen Bereich.
+ *
+ * Was an den Bereichsgrenzen frei bleibt, wird in Runden zugeordnet:
+ *
+ *   1. jede freie Kachel zaehlt ihre freien Nachbarn (Grad)
+ *   2. jede freie Kachel schlaegt den freien Nachbarn mit kleinstem Grad
+ *      vor, Gleichstand entscheidet ein Hash aus Kachel und Runde
+ *   3. gegenseitige Vorschlaege werden zugeordnet
+ *
+ * Die freie Kachel mit dem global kleinsten Schluessel (Grad, Hash) wird
+ * von ihrem bevorzugten Nachbarn gewaehlt und umgekehrt, jede Runde ordnet
+ * also mindestens ein Paar zu. Kacheln mit nur einem freien Nachbarn
+ * werden bevorzugt (wie bei Karp-Sipser). Ohne neue Paare oder nach
+ * INIT_ROUNDS Runden ist Schluss, den Rest erledigt findCoverage().
+ *
+ * Die Threads treffen sich nach jedem Schritt an einer Barriere; ein Paar
+ * schreibt immer nur ein Thread, also ohne Konflikt.
+ *
+ * Je mehr Bereiche, desto mehr bleibt an den Grenzen fuer die Runden
+ * uebrig: auf 700x700 mit 10% Loechern laesst die gierige Zuordnung 5598
+ * Kacheln frei, ein Thread 5368, 4 Threads 5522, 16 Threads 6156. Ohne
+ * --threads (alle Kerne) werden daher hoechstens INIT_MAX_THREADS Threads
+ * benutzt; eine ausdrueckliche Anzahl gilt wie angegeben.
+ *
+ * Zum Vergleich zaehlt ein Probelauf der gierigen Zuordnung aus linkTiles()
+ * (erst Nord, dann Ost) auf Markierungen, ohne edge anzufassen, die freien
+ * Kacheln. Mit --stats werden beide Zahlen, die Runden der letzten Stufe
+ * und die Threads gemeldet.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "loesung.h"
+
+#define INIT_ROUNDS 64
+#define INIT_MIN_TILES 4096     // darunter ein Thread
+#define INIT_MAX_THREADS 4      // ohne --threads, darueber mehr freie Kacheln als gierig
+#define INIT_NONE SIZE_MAX
+
+typedef struct init_s{
+    tile_t * tiles;
+    size_t amount;
+    size_t * proposal;
+    unsigned char * degree;
+
+    unsigned int threads;
+    pthread_mutex_t lock;       // Tor bis alle Threads gestartet sind
+    pthread_cond_t open;
+    int started;
+    pthread_barrier_t barrier;
+    size_t * matched;           // neue Paare je Thread in dieser Runde
+    unsigned int rounds;
+    int forcedDone;
+    int done;
+} init_t;
+
+typedef struct initJob_s{
+    init_t * init;
+    unsigned int id;
+} initJob_t;
+
+static uint32_t priority(size_t i, unsigned int round)
+{
+    uint64_t h = (uint64_t) i * 0x9e3779b97f4a7c15ull ^ (uint64_t) round * 0xc2b2ae3d27d4eb4full;
+    h ^= h >> 31;
+    h *= 0xff51afd7ed558ccdull;
+    return (uint32_t) (h >> 32);
+}
+
+static void * initWorker(void * arg)
+{
+    initJob_t * job = (initJob_t *) arg;
+    init_t * in = job->init;
+    tile_t * tiles = in->tiles;
+
+    pthread_mutex_lock(&in->lock);
+    while (!in->started) { pthread_cond_wait(&in->open, &in->lock); }
+    pthread_mutex_unlock(&in->lock);
+
+    size_t begin = in->amount * job->id / in->threads;
+    size_t end = in->amount * (job->id + 1) / in->threads;
+
+    /* erzwungene Paare: Kacheln mit genau einem freien Nachbarn
+     */
+    for (unsigned int round = 0; round < INIT_ROUNDS; round++)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            tile_t * t = &tiles[i];
+            unsigned char d = 0;
+            if (!t->edge)
+            {
+                d += t->north && !t->north->edge;
+                d += t->east && !t->east->edge;
+                d += t->south && !t->south->edge;
+                d += t->west && !t->west->edge;
+            }
+            in->degree[i] = d;
+        }
+        pthread_barrier_wait(&in->barrier);
+        for (size_t i = begin; i < end; i++)
+        {
+            in->proposal[i] = INIT_NONE;
+            if (in->degree[i] != 1) { continue; }
+            tile_t * t = &tiles[i];
+            tile_t * next[4] = { t->north, t->east, t->south, t->west };
+            for (int d = 0; d < 4; d++)
+            {
+                if (next[d] && !next[d]->edge) { in->proposal[i] = (size_t) (next[d] - tiles); }
+            }
+        }
+        pthread_barrier_wait(&in->barrier);
+        size_t matched = 0;
+        for (size_t n = begin; n < end; n++)
+        {
+            if (!in->degree[n]) { continue; }
+            tile_t * t = &tiles[n];
+            tile_t * next[4] = { t->north, t->east, t->south, t->west };
+            size_t best = INIT_NONE;
+            for (int d = 0; d < 4; d++)
+            {
+                if (!next[d]) { continue; }
+                size_t j = (size_t) (next[d] - tiles);
+                if (in->proposal[j] == n && j < best) { best = j; }
+            }
+            // wer selbst vorschlaegt, nimmt nur den eigenen Partner, und bei
+            // gegenseitigem Vorschlag schreibt nur die kleinere Kachel
+            if (best == INIT_NONE) { continue; }
+            if (in->proposal[n] != INIT_NONE && (in->proposal[n] != best || best < n)) { continue; }
+            tiles[n].edge = &tiles[best];
+            tiles[best].edge = &tiles[n];
+            matched++;
+        }
+        in->matched[job->id] = matched;
+        if (pthread_barrier_wait(&in->barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+        {
+            size_t total = 0;
+            for (unsigned int t = 0; t < in->threads; t++) { total += in->matched[t]; }
+            in->forcedDone = !total;
+        }
+        pthread_barrier_wait(&in->barrier);
+        if (in->forcedDone) { break; }
+    }
+
+    /* gierig wie linkTiles(), aber nur innerhalb des eigenen Bereichs
+     */
+    for (size_t i = begin; i < end; i++)
+    {
+        tile_t * t = &tiles[i];
+        if (t->edge) { continue; }
+        tile_t * next[2] = { t->north, t->east };
+        for (int d = 0; d < 2; d++)
+        {
+            if (!next[d] || next[d]->edge || (size_t) (next[d] - tiles) >= end) { continue; }
+            t->edge = next[d];
+            next[d]->edge = t;
+            break;
+        }
+    }
+    pthread_barrier_wait(&in->barrier);
+
+    for (unsigned int round = 0; round < INIT_ROUNDS; round++)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            tile_t * t = &tiles[i];
+            unsigned char d = 0;
+            if (!t->edge)
+            {
+                d += t->north && !t->north->edge;
+                d += t->east && !t->east->edge;
+                d += t->south && !t->south->edge;
+                d += t->west && !t->west->edge;
+            }
+            in->degree[i] = d;
+        }
+        pthread_barrier_wait(&in->barrier);
+
+        for (size_t i = begin; i < end; i++)
+        {
+            in->proposal[i] = INIT_NONE;
+            if (!in->degree[i]) { continue; }
+            tile_t * t = &tiles[i];
+            tile_t * next[4] = { t->north, t->east, t->south, t->west };
+            uint64_t best = UINT64_MAX;
+            for (int d = 0; d < 4; d++)
+            {
+                if (!next[d] || next[d]->edge) { continue; }
+                size_t n = (size_t) (next[d] - tiles);
+                uint64_t key = (uint64_t) in->degree[n] << 32 | priority(n, round);
+                if (key < best)
+                {
+                    best = key;
+                    in->proposal[i] = n;
+                }
+            }
+        }
+        pthread_barrier_wait(&in->barrier);
+
+        size_t matched = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            size_t n = in->proposal[i];
+            if (n == INIT_NONE || n < i || in->proposal[n] != i) { continue; }
+            tiles[i].edge = &tiles[n];
+            tiles[n].edge = &tiles[i];
+            matched++;
+        }
+        in->matched[job->id] = matched;
+        if (pthread_barrier_wait(&in->barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+        {
+            size_t total = 0;
+            for (unsigned int t = 0; t < in->threads; t++) { total += in->matched[t]; }
+            in->rounds = round + 1;
+            in->done = !total;
+        }
+        pthread_barrier_wait(&in->barrier);
+        if (in->done) { break; }
+    }
+    return NULL;
+}
+
+/* freie Kacheln nach der gierigen Zuordnung von linkTiles(), nur auf
+ * den Markierungen in taken (amount Bytes)
+ */
+static size_t greedyFree(const tile_t * tiles, size_t amount, unsigned char * taken)
+{
+    size_t amountFree = amount;
+    for (size_t i = 0; i < amount; i++) { taken[i] = 0; }
+    for (size_t i = 0; i < amount; i++)
+    {
+        const tile_t * next[2] = { tiles[i].north, tiles[i].east };
+        for (int d = 0; d < 2 && !taken[i]; d++)
+        {
+            if (!next[d] || taken[next[d] - tiles]) { continue; }
+            taken[i] = 1;
+            taken[next[d] - tiles] = 1;
+            amountFree -= 2;
+        }
+    }
+    return amountFree;
+}
+
+static size_t countFree(const allTiles_t * allTiles)
+{
+    size_t amountFree = 0;
+    for (size_t i = 0; i < allTiles->amount; i++) { amountFree += !allTiles->tiles[i].edge; }
+    return amountFree;
+}
+
+int initMatching(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    for (size_t i = 0; i < allTiles->amount; i++) { allTiles->tiles[i].edge = NULL; }
+
+    init_t in;
+    in.tiles = allTiles->tiles;
+    in.amount = allTiles->amount;
+    in.threads = ctx->threads;
+    if (!in.threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        in.threads = online > 0 ? (unsigned int) online : 1;
+        if (in.threads > INIT_MAX_THREADS) { in.threads = INIT_MAX_THREADS; }
+    }
+    if (in.amount < INIT_MIN_TILES) { in.threads = 1; }
+    in.rounds = 0;
+    in.forcedDone = 0;
+    in.done = 0;
+    in.proposal = (size_t *) memAlloc(ctx, in.amount * sizeof(size_t));
+    in.degree = (unsigned char *) memAlloc(ctx, in.amount);
+    in.matched = (size_t *) memCalloc(ctx, in.threads, sizeof(size_t));
+    initJob_t * jobs = (initJob_t *) memCalloc(ctx, in.threads, sizeof(initJob_t));
+    pthread_t * ids = (pthread_t *) memCalloc(ctx, in.threads, sizeof(pthread_t));
+    int status = -1;
+    if (!in.proposal || !in.degree || !in.matched || !jobs || !ids)
+    {
+        ctx->error = TILING_EXCEED_MEM;
+        goto err0;
+    }
+    ctx->initGreedyFree = greedyFree(in.tiles, in.amount, in.degree);
+
+    /* erst wenn feststeht, wie viele Threads laufen, wird die Barriere
+     * angelegt und das Tor geoeffnet; die Bereiche haengen davon ab
+     */
+    pthread_mutex_init(&in.lock, NULL);
+    pthread_cond_init(&in.open, NULL);
+    in.started = 0;
+    unsigned int started = 1;
+    for (; started < in.threads; started++)
+    {
+        jobs[started].init = &in;
+        jobs[started].id = started;
+        if (pthread_create(&ids[started], NULL, initWorker, &jobs[started])) { break; }
+    }
+    pthread_barrier_init(&in.barrier, NULL, started);
+    pthread_mutex_lock(&in.lock);
+    in.threads = started;
+    in.started = 1;
+    pthread_cond_broadcast(&in.open);
+    pthread_mutex_unlock(&in.lock);
+
+    jobs[0].init = &in;
+    jobs[0].id = 0;
+    initWorker(&jobs[0]);
+    for (unsigned int t = 1; t < started; t++) { pthread_join(ids[t], NULL); }
+    pthread_barrier_destroy(&in.barrier);
+    pthread_cond_destroy(&in.open);
+    pthread_mutex_destroy(&in.lock);
+
+    ctx->initFree = countFree(allTiles);
+    ctx->initRounds = in.rounds;
+    ctx->initThreads = in.threads;
+    status = 0;
+
+err0:
+    memFree(ctx, in.proposal);
+    memFree(ctx, in.degree);
+    memFree(ctx, in.matched);
+    memFree(ctx, jobs);
+    memFree(ctx, ids);
+    return status;
+}
@@ -0,0 +1,153 @@
+/* Speicherbuchhaltung je Kontext (--stats, --memory-budget)
+ *
+ * Alle Puffer des Loesers laufen ueber memAlloc()/memRealloc()/memFree().
+ * Vor jedem Block liegt ein Kopf mit seiner Groesse, so dass auch free()
+ * ohne Groessenangabe abgerechnet werden kann. Gezaehlt werden die aktuell
+ * belegten Bytes, das Maximum insgesamt und das Maximum je Phase (Phasen
+ * wie in probe.c, tilingPhase() schaltet beide weiter). Die Zaehler sind
+ * atomar, weil --init-match und --count in Threads anlegen.
+ *
+ * Mit Budget schlaegt eine Anforderung fehl, die es ueberschreiten wuerde;
+ * der Aufrufer meldet dann wie bisher TILING_EXCEED_MEM. Damit das nicht
+ * erst spaet passiert, richtet sich der Planer (planner.c) vorher nach
+ * memFits() und reserviert die Suchpuffer gleich nach dem Sortieren.
+ *
+ * Eingeblendete Dateien (--external, Cache) sind kein Heap und zaehlen
+ * nicht mit.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "loesung.h"
+
+typedef union memHead_u{
+    size_t bytes;
+    max_align_t align;
+} memHead_t;
+
+static void raisePeak(atomic_size_t * peak, size_t value)
+{
+    size_t old = atomic_load(peak);
+    while (old < value && !atomic_compare_exchange_weak(peak, &old, value)) { }
+}
+
+/* Zuwachs um grow Bytes anmelden, -1 falls das Budget nicht reicht
+ */
+static int charge(memory_t * mem, size_t grow)
+{
+    size_t now = atomic_fetch_add(&mem->current, grow) + grow;
+    if (mem->budget && now > mem->budget)
+    {
+        atomic_fetch_sub(&mem->current, grow);
+        return -1;
+    }
+    raisePeak(&mem->peak, now);
+    raisePeak(&mem->phasePeak[mem->phase], now);
+    return 0;
+}
+
+void * memAlloc(tiling_t * ctx, size_t bytes)
+{
+    if (bytes > SIZE_MAX - sizeof(memHead_t)) { return NULL; }
+    if (charge(&ctx->mem, bytes)) { return NULL; }
+    memHead_t * head = (memHead_t *) malloc(sizeof(memHead_t) + bytes);
+    if (!head)
+    {
+        atomic_fetch_sub(&ctx->mem.current, bytes);
+        return NULL;
+    }
+    head->bytes = bytes;
+    return head + 1;
+}
+
+void * memCalloc(tiling_t * ctx, size_t amount, size_t size)
+{
+    if (size && amount > SIZE_MAX / size) { return NULL; }
+    size_t bytes = amount * size;
+    if (bytes > SIZE_MAX - sizeof(memHead_t)) { return NULL; }
+    if (charge(&ctx->mem, bytes)) { return NULL; }
+    memHead_t * head = (memHead_t *) calloc(1, sizeof(memHead_t) + bytes);
+    if (!head)
+    {
+        atomic_fetch_sub(&ctx->mem.current, bytes);
+        return NULL;
+    }
+    head->bytes = bytes;
+    return head + 1;
+}
+
+void * memRealloc(tiling_t * ctx, void * p, size_t bytes)
+{
+    if (!p) { return memAlloc(ctx, bytes); }
+    if (bytes > SIZE_MAX - sizeof(memHead_t)) { return NULL; }
+    memHead_t * head = (memHead_t *) p - 1;
+    size_t old = head->bytes;
+    if (bytes > old && charge(&ctx->mem, bytes - old)) { return NULL; }
+    memHead_t * temp = (memHead_t *) realloc(head, sizeof(memHead_t) + bytes);
+    if (!temp)
+    {
+        if (bytes > old) { atomic_fetch_sub(&ctx->mem.current, bytes - old); }
+        return NULL;
+    }
+    if (bytes < old) { atomic_fetch_sub(&ctx->mem.current, old - bytes); }
+    temp->bytes = bytes;
+    return temp + 1;
+}
+
+void memFree(tiling_t * ctx, void * p)
+{
+    if (!p) { return; }
+    memHead_t * head = (memHead_t *) p - 1;
+    atomic_fetch_sub(&ctx->mem.current, head->bytes);
+    free(head);
+    return;
+}
+
+/* Passen weitere bytes noch ins Budget (ohne Budget immer)?
+ */
+int memFits(const tiling_t * ctx, size_t bytes)
+{
+    if (!ctx->mem.budget) { return 1; }
+    size_t now = atomic_load(&ctx->mem.current);
+    return now <= ctx->mem.budget && bytes <= ctx->mem.budget - now;
+}
+
+void tilingPhase(tiling_t * ctx, phase_t phase)
+{
+    memory_t * mem = &ctx->mem;
+    if (phase < PHASES)
+    {
+        mem->used[phase] = 1;
+        mem->phase = phase;
+        raisePeak(&mem->phasePeak[phase], atomic_load(&mem->current));
+    }
+    probePhase(ctx->probe, phase);
+    return;
+}
+
+void tilingSetMemoryBudget(tiling_t * ctx, size_t bytes)
+{
+    ctx->mem.budget = bytes;
+}
+
+size_t tilingMemoryPeak(const tiling_t * ctx)
+{
+    return atomic_load(&ctx->mem.peak);
+}
+
+void tilingPrintMemory(const tiling_t * ctx, FILE * out)
+{
+    const memory_t * mem = &ctx->mem;
+    fprintf(out, "memory: %zu bytes peak, %zu bytes at end", (size_t) atomic_load(&mem->peak),
+            (size_t) atomic_load(&mem->current));
+    if (mem->budget) { fprintf(out, ", budget %zu", mem->budget); }
+    fprintf(out, "\n");
+    for (int p = 0; p < PHASES; p++)
+    {
+        if (!mem->used[p]) { continue; }
+        fprintf(out, "memory: %-5s %zu bytes peak\n", phaseNames[p], (size_t) atomic_load(&mem->phasePeak[p]));
+    }
+    return;
+}
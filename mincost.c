@@ -0,0 +1,564 @@
+/* Parkettierung minimaler Kosten (TILING_ENGINE_MINCOST)
+ *
+ * Jedes Domino kostet je nach Lage horizontal bzw. vertikal (tilingSetCost(),
+ * Voreinstellung 0), einzelne Dominos legt eine Gewichtsdatei fest
+ * (tilingLoadWeights()). Gesucht ist die Parkettierung mit kleinster Summe,
+ * also eine perfekte Zuordnung minimaler Kosten zwischen schwarzen (x+y
+ * gerade) und weissen Kacheln.
+ *
+ * Nacheinander kuerzeste augmentierende Wege mit Potentialen pot: im
+ * Restgraphen fuehren freie Kanten von schwarz nach weiss mit Kosten c,
+ * Kanten der Zuordnung von weiss zurueck mit -c. Die reduzierten Kosten
+ * c + pot[von] - pot[nach] sind nie negativ, auf der Zuordnung 0, so dass
+ * Dijkstra ueber das verbundene Feld laeuft:
+ *
+ *   Start: pot[weiss] = billigste Kante, pot[schwarz] so, dass jede
+ *   schwarze Kachel eine Kante mit reduzierten Kosten 0 hat; auf diesen
+ *   Kanten gierig zuordnen (wie linkTiles(), erst Nord, dann Ost)
+ *
+ *   je freier schwarzer Kachel: Dijkstra bis zur ersten freien weissen
+ *   Kachel in Entfernung D, Weg umlegen, pot[v] += dist[v] - D fuer alle
+ *   fertigen Kacheln naeher als D
+ *
+ * Die Suche endet an der naechsten freien Kachel, bei lokalen Abweichungen
+ * von der gierigen Zuordnung bleibt sie klein; dist gilt nur mit dem
+ * Stempel der laufenden Suche, es wird also nie das ganze Feld geloescht.
+ * Am Ende ist jede Kante nicht negativ und jede zugeordnete 0, die
+ * Zuordnung damit minimal. Erreicht eine Suche keine freie weisse Kachel,
+ * gibt es keine Parkettierung.
+ *
+ * Kosten werden um ihr Minimum verschoben, negative Gewichte gehen also
+ * auch; die Summe in tilingCost() ist die der angegebenen Kosten.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+#include "loesung.h"
+
+typedef struct heapEntry_s{
+    long long dist;
+    size_t tile;
+} heapEntry_t;
+
+typedef struct mincost_s{
+    tiling_t * ctx;
+    tile_t * tiles;
+    size_t amount;
+    long long horizontal;       // um das Minimum verschoben
+    long long vertical;
+    long long * east;           // Kosten zum Ostnachbarn, NULL = horizontal
+    long long * north;          // Kosten zum Nordnachbarn, NULL = vertical
+    long long * pot;
+    long long * dist;
+    unsigned int * stamp;       // 2*search: vorlaeufig, 2*search+1: fertig
+    unsigned int search;
+    size_t * done;              // fertige Kacheln der laufenden Suche
+    heapEntry_t * heap;
+    size_t heapSize;
+    size_t capHeap;
+} mincost_t;
+
+static int isBlack(const tile_t * t)
+{
+    return !((t->p.x + t->p.y) & 1);
+}
+
+/* Nachbarn in der Reihenfolge der gierigen Zuordnung
+ */
+static tile_t * neighbour(const tile_t * t, int dir)
+{
+    switch (dir)
+    {
+        case 0:  return t->north;
+        case 1:  return t->east;
+        case 2:  return t->south;
+        default: return t->west;
+    }
+}
+
+/* verschobene Kosten des Dominos aus t und seinem Nachbarn in Richtung dir
+ */
+static long long edgeCost(const mincost_t * m, const tile_t * t, int dir)
+{
+    switch (dir)
+    {
+        case 0:  return m->north ? m->north[t - m->tiles] : m->vertical;
+        case 1:  return m->east ? m->east[t - m->tiles] : m->horizontal;
+        case 2:  return m->north ? m->north[t->south - m->tiles] : m->vertical;
+        default: return m->east ? m->east[t->west - m->tiles] : m->horizontal;
+    }
+}
+
+static tile_t * findTile(const mincost_t * m, point_t p)
+{
+    size_t lo = 0;
+    size_t hi = m->amount;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        point_t q = m->tiles[mid].p;
+        if (q.x < p.x || (q.x == p.x && q.y < p.y)) { lo = mid + 1; } else { hi = mid; }
+    }
+    if (lo < m->amount && m->tiles[lo].p.x == p.x && m->tiles[lo].p.y == p.y) { return &m->tiles[lo]; }
+    return NULL;
+}
+
+/* Kosten je Kante aus Lage und Gewichten, danach um das Minimum verschieben
+ *
+ * shift: abgezogener Betrag je Domino
+ */
+static int setupCosts(mincost_t * m, long long * shift)
+{
+    tiling_t * ctx = m->ctx;
+    long long low = ctx->costHorizontal < ctx->costVertical ? ctx->costHorizontal : ctx->costVertical;
+    m->horizontal = ctx->costHorizontal;
+    m->vertical = ctx->costVertical;
+    if (ctx->amountWeights)
+    {
+        m->east = (long long *) memAlloc(ctx, m->amount * sizeof(long long));
+        m->north = (long long *) memAlloc(ctx, m->amount * sizeof(long long));
+        if (!m->east || !m->north) { return -1; }
+        for (size_t i = 0; i < m->amount; i++)
+        {
+            m->east[i] = m->horizontal;
+            m->north[i] = m->vertical;
+        }
+        // spaetere Zeilen ueberschreiben fruehere, fehlende Kacheln zaehlen nicht
+        for (size_t w = 0; w < ctx->amountWeights; w++)
+        {
+            const weight_t * weight = &ctx->weights[w];
+            tile_t * a = findTile(m, weight->a);
+            if (!a) { continue; }
+            if (a->east && a->east->p.x == weight->b.x && a->east->p.y == weight->b.y)
+            {
+                m->east[a - m->tiles] = weight->cost;
+            } else if (a->north && a->north->p.x == weight->b.x && a->north->p.y == weight->b.y) {
+                m->north[a - m->tiles] = weight->cost;
+            } else {
+                continue;
+            }
+            if (weight->cost < low) { low = weight->cost; }
+        }
+        for (size_t i = 0; i < m->amount; i++)
+        {
+            m->east[i] -= low;
+            m->north[i] -= low;
+        }
+    }
+    m->horizontal -= low;
+    m->vertical -= low;
+    *shift = low;
+    return 0;
+}
+
+static int heapPush(mincost_t * m, long long dist, size_t tile)
+{
+    if (m->heapSize == m->capHeap)
+    {
+        size_t cap = m->capHeap ? m->capHeap * 2 : 1024;
+        heapEntry_t * temp = (heapEntry_t *) memRealloc(m->ctx, m->heap, cap * sizeof(heapEntry_t));
+        if (!temp) { return -1; }
+        m->heap = temp;
+        m->capHeap = cap;
+    }
+    size_t i = m->heapSize++;
+    while (i > 0 && m->heap[(i - 1) / 2].dist > dist)
+    {
+        m->heap[i] = m->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    m->heap[i].dist = dist;
+    m->heap[i].tile = tile;
+    return 0;
+}
+
+static heapEntry_t heapPop(mincost_t * m)
+{
+    heapEntry_t top = m->heap[0];
+    heapEntry_t last = m->heap[--m->heapSize];
+    size_t i = 0;
+    for (;;)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= m->heapSize) { break; }
+        if (child + 1 < m->heapSize && m->heap[child + 1].dist < m->heap[child].dist) { child++; }
+        if (m->heap[child].dist >= last.dist) { break; }
+        m->heap[i] = m->heap[child];
+        i = child;
+    }
+    if (m->heapSize) { m->heap[i] = last; }
+    return top;
+}
+
+/* Entfernung von to verbessern, from ist bei weissen Kacheln der Vorgaenger
+ */
+static int relax(mincost_t * m, tile_t * from, tile_t * to, long long dist)
+{
+    size_t i = (size_t) (to - m->tiles);
+    unsigned int open = 2 * m->search;
+    if (m->stamp[i] == open + 1) { return 0; }
+    if (m->stamp[i] == open && m->dist[i] <= dist) { return 0; }
+    m->stamp[i] = open;
+    m->dist[i] = dist;
+    to->parent = from;
+    return heapPush(m, dist, i);
+}
+
+/* Dijkstra von der freien schwarzen Kachel start, Weg umlegen, Potentiale
+ * nachziehen
+ *
+ * 0: umgelegt, 1: keine freie weisse Kachel erreichbar, -1: kein Speicher
+ */
+static int augment(mincost_t * m, tile_t * start, size_t * visited)
+{
+    if (++m->search > UINT_MAX / 2 - 1)
+    {
+        memset(m->stamp, 0, m->amount * sizeof(unsigned int));
+        m->search = 1;
+    }
+    unsigned int fixed = 2 * m->search + 1;
+    m->heapSize = 0;
+    size_t amountDone = 0;
+    tile_t * end = NULL;
+    long long reach = 0;
+    if (relax(m, NULL, start, 0)) { return -1; }
+    while (m->heapSize)
+    {
+        heapEntry_t top = heapPop(m);
+        size_t i = top.tile;
+        if (m->stamp[i] == fixed || m->dist[i] != top.dist) { continue; }
+        m->stamp[i] = fixed;
+        m->done[amountDone++] = i;
+        tile_t * t = &m->tiles[i];
+        if (!isBlack(t))
+        {
+            if (!t->edge)
+            {
+                end = t;
+                reach = top.dist;
+                break;
+            }
+            // Kante der Zuordnung, reduzierte Kosten 0
+            if (relax(m, t, t->edge, top.dist)) { return -1; }
+            continue;
+        }
+        for (int dir = 0; dir < 4; dir++)
+        {
+            tile_t * w = neighbour(t, dir);
+            if (!w || w == t->edge) { continue; }
+            size_t j = (size_t) (w - m->tiles);
+            if (relax(m, t, w, top.dist + edgeCost(m, t, dir) + m->pot[i] - m->pot[j])) { return -1; }
+        }
+    }
+    *visited += amountDone;
+    if (!end) { return 1; }
+
+    for (size_t k = 0; k < amountDone; k++)
+    {
+        size_t i = m->done[k];
+        if (m->dist[i] < reach) { m->pot[i] += m->dist[i] - reach; }
+    }
+    tile_t * w = end;
+    for (;;)
+    {
+        tile_t * b = w->parent;
+        tile_t * next = b->edge;
+        b->edge = w;
+        w->edge = b;
+        if (b == start) { break; }
+        w = next;
+    }
+    return 0;
+}
+
+/* Nachbar in Richtung dir, falls frei und die Kante reduziert 0 kostet
+ */
+static tile_t * tightFree(const mincost_t * m, const tile_t * t, int dir)
+{
+    tile_t * u = neighbour(t, dir);
+    if (!u || u->edge) { return NULL; }
+    long long r = isBlack(t) ? m->pot[t - m->tiles] - m->pot[u - m->tiles] : m->pot[u - m->tiles] - m->pot[t - m->tiles];
+    return edgeCost(m, t, dir) + r == 0 ? u : NULL;
+}
+
+/* Potentiale mit reduzierten Kosten >= 0 und je Kachel mindestens einer
+ * Kante mit 0, darauf zuordnen: erst Kacheln mit nur einer solchen Kante
+ * (wie die erzwungenen Paare in matchinit.c, so findet etwa ein einzelnes
+ * billiges Domino gleich zusammen), dann gierig nach Nord und Ost
+ *
+ * degree und queue sind Puffer mit je einem Platz pro Kachel
+ */
+static void initialMatching(mincost_t * m, unsigned int * degree, size_t * queue)
+{
+    tile_t * tiles = m->tiles;
+    for (size_t i = 0; i < m->amount; i++)
+    {
+        tiles[i].edge = NULL;
+        m->pot[i] = 0;
+    }
+    for (size_t i = 0; i < m->amount; i++)
+    {
+        tile_t * t = &tiles[i];
+        if (!isBlack(t)) { continue; }
+        for (int dir = 0; dir < 4; dir++)
+        {
+            tile_t * w = neighbour(t, dir);
+            if (!w) { continue; }
+            size_t j = (size_t) (w - tiles);
+            long long c = edgeCost(m, t, dir);
+            if (!w->parent || c < m->pot[j])
+            {
+                m->pot[j] = c;
+                w->parent = t;      // nur als Marke "schon gesehen"
+            }
+        }
+    }
+    for (size_t i = 0; i < m->amount; i++)
+    {
+        tile_t * t = &tiles[i];
+        if (!isBlack(t)) { continue; }
+        long long best = LLONG_MAX;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            tile_t * w = neighbour(t, dir);
+            if (!w) { continue; }
+            long long r = edgeCost(m, t, dir) - m->pot[w - tiles];
+            if (r < best) { best = r; }
+        }
+        if (best != LLONG_MAX) { m->pot[i] = -best; }
+    }
+
+    size_t head = 0;
+    size_t tail = 0;
+    for (size_t i = 0; i < m->amount; i++)
+    {
+        degree[i] = 0;
+        for (int dir = 0; dir < 4; dir++) { degree[i] += tightFree(m, &tiles[i], dir) != NULL; }
+        if (degree[i] == 1) { queue[tail++] = i; }
+    }
+    while (head < tail)
+    {
+        tile_t * t = &tiles[queue[head++]];
+        tile_t * u = NULL;
+        for (int dir = 0; dir < 4 && !u; dir++) { u = tightFree(m, t, dir); }
+        if (t->edge || !u) { continue; }
+        t->edge = u;
+        u->edge = t;
+        // freie Nachbarn verlieren eine Kante, jede Kachel kommt hoechstens
+        // einmal mit Grad 1 in die Schlange
+        tile_t * pair[2] = { t, u };
+        for (int k = 0; k < 2; k++)
+        {
+            for (int dir = 0; dir < 4; dir++)
+            {
+                tile_t * v = tightFree(m, pair[k], dir);
+                if (v && --degree[v - tiles] == 1) { queue[tail++] = (size_t) (v - tiles); }
+            }
+        }
+    }
+
+    // wie linkTiles() in sortierter Reihenfolge, bei gleichen Kosten also
+    // dieselbe Zuordnung
+    for (size_t i = 0; i < m->amount; i++)
+    {
+        tile_t * t = &tiles[i];
+        for (int dir = 0; dir < 2 && !t->edge; dir++)
+        {
+            tile_t * u = tightFree(m, t, dir);
+            if (!u) { continue; }
+            t->edge = u;
+            u->edge = t;
+        }
+    }
+}
+
+int mincostSolve(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    ctx->costTotal = 0;
+    ctx->costPaths = 0;
+    ctx->costVisited = 0;
+
+    mincost_t m;
+    memset(&m, 0, sizeof(m));
+    m.ctx = ctx;
+    m.tiles = allTiles->tiles;
+    m.amount = allTiles->amount;
+
+    int status = -1;
+    long long shift = 0;
+    size_t black = 0;
+    for (size_t i = 0; i < m.amount; i++)
+    {
+        black += isBlack(&m.tiles[i]);
+        m.tiles[i].parent = NULL;
+    }
+    if (2 * black != m.amount)
+    {
+        status = 1;
+        goto end;
+    }
+    m.pot = (long long *) memAlloc(ctx, m.amount * sizeof(long long));
+    m.dist = (long long *) memAlloc(ctx, m.amount * sizeof(long long));
+    m.stamp = (unsigned int *) memCalloc(ctx, m.amount, sizeof(unsigned int));
+    m.done = (size_t *) memAlloc(ctx, m.amount * sizeof(size_t));
+    if (!m.pot || !m.dist || !m.stamp || !m.done || setupCosts(&m, &shift)) { goto mem; }
+
+    initialMatching(&m, m.stamp, m.done);
+    memset(m.stamp, 0, m.amount * sizeof(unsigned int));
+    for (size_t i = 0; i < m.amount; i++)
+    {
+        tile_t * t = &m.tiles[i];
+        if (!isBlack(t) || t->edge) { continue; }
+        int found = augment(&m, t, &ctx->costVisited);
+        if (found < 0) { goto mem; }
+        ctx->costPaths++;
+        if (found)
+        {
+            status = 1;
+            goto end;
+        }
+    }
+
+    long long total = 0;
+    for (size_t i = 0; i < m.amount; i++)
+    {
+        tile_t * t = &m.tiles[i];
+        if (!isBlack(t)) { continue; }
+        for (int dir = 0; dir < 4; dir++)
+        {
+            if (neighbour(t, dir) == t->edge) { total += edgeCost(&m, t, dir) + shift; }
+        }
+    }
+    ctx->costTotal = total;
+    status = 0;
+    goto end;
+
+mem:
+    ctx->error = TILING_EXCEED_MEM;
+end:
+    memFree(ctx, m.east);
+    memFree(ctx, m.north);
+    memFree(ctx, m.pot);
+    memFree(ctx, m.dist);
+    memFree(ctx, m.stamp);
+    memFree(ctx, m.done);
+    memFree(ctx, m.heap);
+    return status;
+}
+
+void tilingSetCost(tiling_t * ctx, int horizontal, int vertical)
+{
+    ctx->costHorizontal = horizontal;
+    ctx->costVertical = vertical;
+    ctx->engine = TILING_ENGINE_MINCOST;
+}
+
+long long tilingCost(const tiling_t * ctx)
+{
+    return ctx->costTotal;
+}
+
+/* naechste Zahl nach Leerzeichen, 0: gelesen, -1: keine
+ */
+static int readNumber(const char ** s, long long low, long long high, long long * value)
+{
+    while (**s == ' ' || **s == '\t') { (*s)++; }
+    if (!isdigit((unsigned char) **s) && !(low < 0 && **s == '-' && isdigit((unsigned char) (*s)[1]))) { return -1; }
+    char * end;
+    long long v = strtoll(*s, &end, 10);
+    if (v < low || v > high) { return -1; }
+    *s = end;
+    *value = v;
+    return 0;
+}
+
+/* Zeile "x1 y1;x2 y2 kosten", 0: Gewicht, 1: leer, -1: Fehler
+ */
+static int parseWeight(const char * s, weight_t * weight)
+{
+    const char * rest = s + strspn(s, " \t\r\n");
+    if (!*rest) { return 1; }
+    long long v[5];
+    for (int k = 0; k < 5; k++)
+    {
+        if (k == 2)
+        {
+            while (*s == ' ' || *s == '\t') { s++; }
+            if (*s++ != ';') { return -1; }
+        }
+        if (readNumber(&s, k < 4 ? 0 : INT_MIN, k < 4 ? UINT_MAX : INT_MAX, &v[k])) { return -1; }
+    }
+    if (s[strspn(s, " \t\r\n")]) { return -1; }
+
+    point_t a = { (unsigned int) v[0], (unsigned int) v[1] };
+    point_t b = { (unsigned int) v[2], (unsigned int) v[3] };
+    if (b.x < a.x || (b.x == a.x && b.y < a.y))
+    {
+        point_t swap = a;
+        a = b;
+        b = swap;
+    }
+    // nur Nachbarn: Nord (x, y+1) oder Ost (x+1, y)
+    if (!((b.x == a.x && b.y - a.y == 1) || (b.y == a.y && b.x - a.x == 1))) { return -1; }
+    weight->a = a;
+    weight->b = b;
+    weight->cost = (int) v[4];
+    return 0;
+}
+
+int tilingLoadWeights(tiling_t * ctx, const char * path)
+{
+    FILE * in = fopen(path, "r");
+    if (!in)
+    {
+        ctx->error = TILING_WEIGHT_FILE;
+        ctx->errData.s = (char *) path;
+        return -1;
+    }
+    ctx->amountWeights = 0;
+    ctx->engine = TILING_ENGINE_MINCOST;
+    int status = -1;
+    size_t line = 0;
+    char text[128];
+    while (fgets(text, sizeof(text), in))
+    {
+        line++;
+        weight_t weight;
+        int parsed = !strchr(text, '\n') && !feof(in) ? -1 : parseWeight(text, &weight);
+        if (parsed < 0)
+        {
+            ctx->error = TILING_WEIGHT;
+            ctx->errData.i = line;
+            goto err0;
+        }
+        if (parsed) { continue; }
+        if (ctx->amountWeights == ctx->capWeights)
+        {
+            size_t cap = ctx->capWeights ? ctx->capWeights * 2 : 64;
+            weight_t * temp = (weight_t *) memRealloc(ctx, ctx->weights, cap * sizeof(weight_t));
+            if (!temp)
+            {
+                ctx->error = TILING_EXCEED_MEM;
+                goto err0;
+            }
+            ctx->weights = temp;
+            ctx->capWeights = cap;
+        }
+        ctx->weights[ctx->amountWeights++] = weight;
+    }
+    if (ferror(in))
+    {
+        ctx->error = TILING_WEIGHT_FILE;
+        ctx->errData.s = (char *) path;
+        goto err0;
+    }
+    status = 0;
+
+err0:
+    fclose(in);
+    return status;
+}
@@ -0,0 +1,372 @@
+/* Paralleles Einlesen grosser Eingaben
+ *
+ * Die ganze Eingabe liegt im Speicher: eine regulaere Datei wird per mmap
+ * eingeblendet, alles andere in grossen Bloecken gelesen. Der Puffer wird
+ * in gleich grosse Stuecke geteilt, deren Grenzen jeweils hinter das
+ * naechste '\n' rutschen, und jedes Stueck wird von einem eigenen Thread
+ * in einen eigenen Punktpuffer zerlegt. Die Regeln sind genau die von
+ * readLine() (tiling.c), das Ende des Puffers zaehlt als EOF; eine Zeile
+ * liegt nie in zwei Stuecken, weil "\r\n" und einzelnes '\r' vor dem
+ * '\n' enden.
+ *
+ * Jeder Thread zaehlt seine Zeilen. Die Praefixsumme dieser Zahlen ergibt
+ * die Zeilennummer des ersten Fehlers (gemeldet wird der Fehler aus dem
+ * vordersten Stueck, wie beim Lesen am Stueck) und den Platz jedes Stuecks
+ * im Kachelfeld, das die Threads danach parallel fuellen; sort() bekommt
+ * das Feld wie von tilingLoad().
+ *
+ * Unter PARSE_MIN_SLICE Bytes je Thread laufen weniger Threads, kleine
+ * Eingaben (etwa im Dienst) also in einem Durchlauf ohne Thread.
+ *
+ * Beginnt die Eingabe mit der Kennung von gzip oder zstd, wird sie nicht
+ * gesammelt, sondern von decompress.c entpackt; dort landet jeder Block
+ * ueber parseAppend() im Kachelfeld.
+ *
+ * Mit Budget darf der gesammelte Text hoechstens ein PARSE_BUDGET_SHARE-tel
+ * des Budgets belegen (die Kacheln daraus sind einige Male groesser), der
+ * erste Block schrumpft notfalls bis PARSE_MIN_READ. Passt der Puffer nicht
+ * mehr, wird stueckweise weitergelesen: die vollstaendigen Zeilen gehen
+ * gleich per parseAppend() ins Kachelfeld, der Rest rueckt an den Anfang.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "loesung.h"
+
+#define PARSE_MIN_SLICE (1 << 20)
+#define PARSE_READ (1 << 20)        // Blockgroesse ohne mmap
+#define PARSE_MIN_READ (1 << 12)    // kleinster erster Block mit Budget
+#define PARSE_BUDGET_SHARE 4
+#define PARSE_THREADS 256
+
+typedef struct slice_s{
+    tiling_t * ctx;
+    const char * begin;
+    const char * end;
+
+    point_t * points;
+    size_t amount;
+    size_t cap;
+    size_t lines;
+    size_t offset;                  // erster Platz im Kachelfeld
+
+    tilingErr_t error;              // erster Fehler im Stueck
+    union errData_u errData;        // Zeile relativ zum Stueck
+} slice_t;
+
+#define PARSE_EOF (-1)
+
+static int next(const char ** p, const char * end)
+{
+    return *p < end ? (unsigned char) *(*p)++ : PARSE_EOF;
+}
+
+static int fail(slice_t * slice, tilingErr_t error, int c)
+{
+    slice->error = error;
+    if (error == TILING_WRONG_CHAR)
+    {
+        slice->errData.c = (char) c;
+    } else {
+        slice->errData.i = slice->lines;
+    }
+    return -1;
+}
+
+/* Zahl ab c (erste Ziffer), danach steht c auf dem Zeichen dahinter
+ */
+static int number(slice_t * slice, const char ** p, int * c, unsigned long * v)
+{
+    if (*c < '0' || *c > '9') { return fail(slice, TILING_WRONG_CHAR, *c); }
+    *v = 0;
+    do
+    {
+        *v = *v * 10 + (unsigned long) *c - 48;
+        if (*v >= 4294967296) { return fail(slice, TILING_EXCEED_MAX, *c); }
+    } while ((*c = next(p, slice->end)) >= '0' && *c <= '9');
+    return 0;
+}
+
+/* Eine Zeile wie readLine()
+ *
+ * 1: Punkt gelesen, 0: Ende des Stuecks, -1: Fehler (im Stueck)
+ */
+static int parseLine(slice_t * slice, const char ** p, point_t * point)
+{
+    const char * end = slice->end;
+    int c = next(p, end);
+    if (c == PARSE_EOF) { return 0; }
+    slice->lines++;
+
+    while (c == ' ' || c == '\t') { c = next(p, end); }
+    if (c == '\n' || c == '\r') { return fail(slice, TILING_WRONG_COOR, c); }
+    unsigned long a;
+    if (number(slice, p, &c, &a)) { return -1; }
+
+    if (c == '\n' || c == '\r' || c == PARSE_EOF) { return fail(slice, TILING_WRONG_COOR, c); }
+    if (c != ' ' && c != '\t') { return fail(slice, TILING_WRONG_CHAR, c); }
+    do { c = next(p, end); } while (c == ' ' || c == '\t');
+
+    if (c == '\n' || c == '\r' || c == PARSE_EOF) { return fail(slice, TILING_WRONG_COOR, c); }
+    unsigned long b;
+    if (number(slice, p, &c, &b)) { return -1; }
+
+    while (c == ' ' || c == '\t') { c = next(p, end); }
+    // "\r\n" zaehlt als ein Zeilenende, sonst gehoert das Zeichen zur naechsten Zeile
+    if (c == '\r')
+    {
+        if (*p < end && **p == '\n') { (*p)++; }
+        c = '\n';
+    }
+    if (c != '\n' && c != PARSE_EOF) { return fail(slice, TILING_WRONG_COOR, c); }
+
+    point->x = (unsigned int) a;
+    point->y = (unsigned int) b;
+    return 1;
+}
+
+static void * parseSlice(void * arg)
+{
+    slice_t * slice = (slice_t *) arg;
+    const char * p = slice->begin;
+    point_t point;
+    int status;
+    while ((status = parseLine(slice, &p, &point)) > 0)
+    {
+        if (slice->amount == slice->cap)
+        {
+            // Schaetzung aus den bisher gelesenen Bytes, dann verdoppeln
+            size_t cap = slice->cap ? slice->cap * 2 : (size_t) (slice->end - slice->begin) / 8 + 16;
+            point_t * temp = (point_t *) memRealloc(slice->ctx, slice->points, cap * sizeof(point_t));
+            if (!temp)
+            {
+                slice->error = TILING_EXCEED_MEM;
+                break;
+            }
+            slice->points = temp;
+            slice->cap = cap;
+        }
+        slice->points[slice->amount++] = point;
+    }
+    return NULL;
+}
+
+static void * fillSlice(void * arg)
+{
+    slice_t * slice = (slice_t *) arg;
+    tile_t * tiles = slice->ctx->allTiles.tiles + slice->offset;
+    for (size_t i = 0; i < slice->amount; i++)
+    {
+        tile_t * tile = &tiles[i];
+        tile->p = slice->points[i];
+        tile->edge = NULL;
+        tile->parent = NULL;
+        tile->north = NULL;
+        tile->south = NULL;
+        tile->west = NULL;
+        tile->east = NULL;
+    }
+    return NULL;
+}
+
+/* job auf allen Stuecken ausfuehren, Stueck 0 im eigenen Thread
+ */
+static void runSlices(slice_t * slices, unsigned int amount, void * (*job)(void *))
+{
+    pthread_t ids[PARSE_THREADS];
+    int started[PARSE_THREADS];
+    for (unsigned int t = 1; t < amount; t++)
+    {
+        started[t] = !pthread_create(&ids[t], NULL, job, &slices[t]);
+        if (!started[t]) { job(&slices[t]); }
+    }
+    job(&slices[0]);
+    for (unsigned int t = 1; t < amount; t++)
+    {
+        if (started[t]) { pthread_join(ids[t], NULL); }
+    }
+}
+
+/* Text an die geladenen Kacheln anhaengen, *lines Zeilen liegen schon davor
+ *
+ * text endet hinter einem '\n' oder am Ende der Eingabe.
+ */
+int parseAppend(tiling_t * ctx, const char * text, size_t len, unsigned int threads, size_t * lines)
+{
+    if (!threads)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned int) online : 1;
+    }
+    if (threads > len / PARSE_MIN_SLICE) { threads = (unsigned int) (len / PARSE_MIN_SLICE); }
+    if (threads < 1) { threads = 1; }
+    if (threads > PARSE_THREADS) { threads = PARSE_THREADS; }
+
+    slice_t slices[PARSE_THREADS];
+    memset(slices, 0, sizeof(slices));
+    const char * end = text + len;
+    const char * begin = text;
+    unsigned int amount = 0;
+    for (unsigned int t = 0; t < threads && begin < end; t++)
+    {
+        const char * cut = t + 1 == threads ? end : text + len / threads * (t + 1);
+        if (cut < begin) { cut = begin; }
+        const char * newline = cut < end ? memchr(cut, '\n', (size_t) (end - cut)) : NULL;
+        cut = newline ? newline + 1 : end;
+        slices[amount].ctx = ctx;
+        slices[amount].begin = begin;
+        slices[amount].end = cut;
+        amount++;
+        begin = cut;
+    }
+    if (!amount) { return 0; }
+    runSlices(slices, amount, parseSlice);
+
+    /* Praefixsummen: Zeilennummern und Plaetze im Kachelfeld
+     */
+    int status = 0;
+    size_t total = ctx->allTiles.amount;
+    for (unsigned int t = 0; t < amount; t++)
+    {
+        slice_t * slice = &slices[t];
+        if (slice->error)
+        {
+            ctx->error = slice->error;
+            ctx->errData = slice->errData;
+            if (slice->error != TILING_WRONG_CHAR) { ctx->errData.i += *lines; }
+            status = -1;
+            goto end;
+        }
+        slice->offset = total;
+        total += slice->amount;
+        *lines += slice->lines;
+    }
+
+    if (ctx->capTiles < total)
+    {
+        // beim Anhaengen verdoppeln, sonst genau passend
+        size_t cap = ctx->allTiles.amount && total < ctx->capTiles * 2 ? ctx->capTiles * 2 : total;
+        tile_t * temp = (tile_t *) memRealloc(ctx, ctx->allTiles.tiles, cap * sizeof(tile_t));
+        if (!temp)
+        {
+            ctx->error = TILING_EXCEED_MEM;
+            status = -1;
+            goto end;
+        }
+        ctx->allTiles.tiles = temp;
+        ctx->capTiles = cap;
+    }
+    runSlices(slices, amount, fillSlice);
+    ctx->allTiles.amount = total;
+
+end:
+    for (unsigned int t = 0; t < amount; t++) { memFree(ctx, slices[t].points); }
+    return status;
+}
+
+int tilingLoadBuffer(tiling_t * ctx, const char * text, size_t len, unsigned int threads)
+{
+    tilingLoadPoints(ctx, NULL, 0);     // vorige Instanz verwerfen
+    size_t lines = 0;
+    return parseAppend(ctx, text, len, threads, &lines);
+}
+
+/* Passt ein Textpuffer von size Bytes (grow davon neu) in seinen Anteil am Budget?
+ */
+static int textFits(const tiling_t * ctx, size_t size, size_t grow)
+{
+    if (!ctx->mem.budget) { return 1; }
+    return size <= ctx->mem.budget / PARSE_BUDGET_SHARE && memFits(ctx, grow);
+}
+
+int tilingLoadParallel(tiling_t * ctx, FILE * in, unsigned int threads)
+{
+    tilingPhase(ctx, PHASE_PARSE);
+    int fd = fileno(in);
+    struct stat st;
+    off_t at = fd >= 0 ? lseek(fd, 0, SEEK_CUR) : -1;
+    if (fd >= 0 && !fstat(fd, &st) && S_ISREG(st.st_mode) && at >= 0 && at < st.st_size)
+    {
+        codec_t codec = fileCodec(fd);
+        if (codec != CODEC_NONE) { return loadCompressed(ctx, in, NULL, 0, codec, threads); }
+
+        size_t bytes = (size_t) st.st_size;
+        void * map = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            posix_madvise(map, bytes, POSIX_MADV_SEQUENTIAL);
+            int status = tilingLoadBuffer(ctx, (const char *) map + at, bytes - (size_t) at, threads);
+            munmap(map, bytes);
+            return status;
+        }
+    }
+
+    /* Pipe oder nicht einblendbar: alles in grossen Bloecken lesen, mit
+     * Budget notfalls stueckweise
+     */
+    size_t cap = 4 * PARSE_READ;
+    while (cap > PARSE_MIN_READ && !textFits(ctx, cap, cap)) { cap /= 2; }
+    char * text = (char *) memAlloc(ctx, cap);
+    if (!text) { goto mem; }
+    tilingLoadPoints(ctx, NULL, 0);     // vorige Instanz verwerfen
+    size_t len = 0;
+    size_t lines = 0;
+    int chunked = 0;
+    int first = 1;
+    int status = 0;
+    while (1)
+    {
+        if (cap - len < PARSE_READ && !chunked)
+        {
+            char * temp = textFits(ctx, 2 * cap, cap) ? (char *) memRealloc(ctx, text, 2 * cap) : NULL;
+            if (temp)
+            {
+                text = temp;
+                cap *= 2;
+            } else {
+                chunked = 1;
+            }
+        }
+        if (chunked && len == cap)
+        {
+            // vollstaendige Zeilen anhaengen, den Rest nach vorne
+            size_t done = len;
+            while (done && text[done - 1] != '\n') { done--; }
+            if (!done) { done = len; }     // keine ganze Zeile, readLine()-Regeln melden den Fehler
+            status = parseAppend(ctx, text, done, threads, &lines);
+            if (status) { goto end; }
+            memmove(text, text + done, len - done);
+            len -= done;
+        }
+        size_t got = fread(text + len, 1, cap - len, in);
+        if (first && got)
+        {
+            // erster Block: komprimiert geht es ohne Sammeln weiter
+            codec_t codec = detectCodec((const unsigned char *) text, got);
+            if (codec != CODEC_NONE)
+            {
+                status = loadCompressed(ctx, in, text, got, codec, threads);
+                goto end;
+            }
+        }
+        first = 0;
+        len += got;
+        if (!got) { break; }
+    }
+    status = parseAppend(ctx, text, len, threads, &lines);
+end:
+    memFree(ctx, text);
+    return status;
+
+mem:
+    tilingLoadPoints(ctx, NULL, 0);
+    ctx->error = TILING_EXCEED_MEM;
+    return -1;
+}
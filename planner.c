@@ -0,0 +1,250 @@
+/* Planer (--engine auto)
+ *
+ * Waehlt nach sort() aus billigen Kennzahlen Darstellung und Loeser:
+ *
+ *   Anzahl, Bounding Box, Dichte    ein Durchlauf ueber das sortierte Feld
+ *   ungerade Spaltenlaeufe          Laeufe aufeinanderfolgender y in einer Spalte
+ *   Breite                          groesste Ausdehnung in y
+ *   Faerbung                        schwarze minus weisse Kacheln
+ *   Komponenten                     nur wenn noetig, nach linkTiles()
+ *
+ * Entscheidungen, in dieser Reihenfolge:
+ *
+ *   ungleiche Faerbung   -> "None" ohne Verbinden und Suchen
+ *   keine ungeraden Laeufe -> allgemein: linkTiles() legt dann senkrechte
+ *                           Dominos, findCoverage() hat nichts mehr zu tun
+ *   viele Komponenten    -> Formen (shapes.c): bei Wiederholungen viel
+ *                           schneller, sonst etwa gleich schnell
+ *   sonst                -> allgemein
+ *
+ * Bitboard-Instanzen (tiny.c) erkennt tilingSolve() schon vor sort(). Die
+ * parallele Startzuordnung wird nie automatisch gewaehlt, weil die gierige
+ * Zuordnung in linkTiles() nichts extra kostet und auf den Messdaten kaum
+ * mehr freie Kacheln laesst. --stream und --external entscheiden sich vor
+ * dem Einlesen und bleiben Schalter; die Breite wird nur berichtet.
+ *
+ * Mit --memory-budget liest tilingPlanInput() grosse Dateien extern ein, und
+ * Formen und Umordnen entfallen, wenn ihre Puffer nicht mehr passen.
+ *
+ * Kalibriert auf den Messdaten (Sekunden, allgemein -> gewaehlt):
+ *
+ *   22500 gleiche Bloecke, 2.1 Mio. Kacheln     3.54 -> 3.06 (Formen)
+ *   22500 verschiedene Inseln, 0.95 Mio.        0.90 -> 0.92 (Formen)
+ *   700x700 mit 10% Loechern, ungleich gefaerbt 0.35 -> 0.11 (Faerbung)
+ *   560x560 voll                                0.18 -> 0.18 (allgemein)
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "loesung.h"
+
+#define PLAN_MIN_COMPONENTS 64      // ab hier lohnt sich shapes.c
+
+/* Bytes je Kachel (hoechstens), um unter --memory-budget zu planen
+ */
+#define PLAN_SHAPES_BYTES (2 * sizeof(size_t) + sizeof(component_t) / 2 + 2 * sizeof(size_t))
+#define PLAN_LAYOUT_BYTES (sizeof(tile_t) + sizeof(size_t) + 2 * (sizeof(uint64_t) + sizeof(size_t)))
+#define PLAN_LINE_BYTES 8           // typische Zeile "1234 567\n"
+#define PLAN_SAMPLE_BYTES 4096      // Anfang der Datei fuer die Zeilenlaenge
+#define PLAN_TILE_BYTES (2 * sizeof(tile_t) + sizeof(point_t) + 2 * sizeof(tile_t *))
+#define PLAN_RUN_BYTES (2 * sizeof(uint64_t))
+#define PLAN_SEARCH_BYTES (2 * sizeof(tile_t *))
+
+static const char * const engineNames[TILING_ENGINES] = {
+    [TILING_ENGINE_AUTO]    = "auto",
+    [TILING_ENGINE_GENERAL] = "general",
+    [TILING_ENGINE_TINY]    = "tiny",
+    [TILING_ENGINE_SHAPES]  = "shapes",
+    [TILING_ENGINE_INIT]    = "init",
+    [TILING_ENGINE_PARITY]  = "parity",
+    [TILING_ENGINE_MINCOST] = "mincost",
+};
+
+const char * tilingEngineName(tilingEngine_t engine)
+{
+    return engine < TILING_ENGINES ? engineNames[engine] : "?";
+}
+
+int tilingEngineByName(const char * name, tilingEngine_t * engine)
+{
+    for (int e = 0; e < TILING_ENGINES; e++)
+    {
+        // "parity" ist nur ein Ergebnis des Planers
+        if (e != TILING_ENGINE_PARITY && !strcmp(name, engineNames[e]))
+        {
+            *engine = (tilingEngine_t) e;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Kennzahlen ueber das sortierte Feld, Entscheidung ohne Komponenten
+ *
+ * Liefert TILING_ENGINE_AUTO, wenn erst die Komponenten entscheiden.
+ */
+tilingEngine_t planSorted(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    const tile_t * tiles = allTiles->tiles;
+    plan_t * plan = &ctx->plan;
+
+    plan->amount = allTiles->amount;
+    plan->oddRuns = 0;
+    plan->components = 0;
+    unsigned int minY = tiles[0].p.y;
+    unsigned int maxY = minY;
+    long long balance = 0;
+    size_t run = 1;
+    for (size_t i = 0; i < allTiles->amount; i++)
+    {
+        point_t p = tiles[i].p;
+        if (p.y < minY) { minY = p.y; }
+        if (p.y > maxY) { maxY = p.y; }
+        balance += (p.x + p.y) % 2 ? 1 : -1;
+        if (i + 1 < allTiles->amount && tiles[i + 1].p.x == p.x && tiles[i + 1].p.y == p.y + 1)
+        {
+            run++;
+            continue;
+        }
+        plan->oddRuns += run % 2;
+        run = 1;
+    }
+    plan->width = maxY - minY + 1;
+    plan->density = (double) allTiles->amount
+                  / ((double) (tiles[allTiles->amount - 1].p.x - tiles[0].p.x + 1) * (double) plan->width);
+    plan->balance = balance;
+
+    if (balance) { return TILING_ENGINE_PARITY; }
+    if (!plan->oddRuns) { return TILING_ENGINE_GENERAL; }
+    return TILING_ENGINE_AUTO;
+}
+
+/* Entscheidung nach linkTiles() ueber die Anzahl der Komponenten
+ *
+ * Kleine Instanzen koennen nicht genug gerade Komponenten haben.
+ */
+tilingEngine_t planLinked(tiling_t * ctx)
+{
+    plan_t * plan = &ctx->plan;
+    size_t amount = ctx->allTiles.amount;
+    if (ctx->shapesOff || amount < 2 * PLAN_MIN_COMPONENTS) { return TILING_ENGINE_GENERAL; }
+    if (!memFits(ctx, amount * PLAN_SHAPES_BYTES))
+    {
+        plan->budgetBound = 1;
+        return TILING_ENGINE_GENERAL;
+    }
+    size_t * rank = (size_t *) memAlloc(ctx, amount * sizeof(size_t));
+    size_t * member = (size_t *) memAlloc(ctx, amount * sizeof(size_t));
+    component_t * comps = NULL;
+    size_t amountComps = 0;
+    if (rank && member && !findComponents(ctx, rank, member, &comps, &amountComps))
+    {
+        plan->components = amountComps;
+    }
+    ctx->error = TILING_OK;     // ohne Speicher fuer die Zaehlung: allgemein
+
+    // shapeSolve() rechnet mit denselben Komponenten weiter
+    if (plan->components >= PLAN_MIN_COMPONENTS)
+    {
+        ctx->compRank = rank;
+        ctx->compMember = member;
+        ctx->comps = comps;
+        ctx->amountComps = amountComps;
+        return TILING_ENGINE_SHAPES;
+    }
+    memFree(ctx, rank);
+    memFree(ctx, member);
+    memFree(ctx, comps);
+    return TILING_ENGINE_GENERAL;
+}
+
+/* Umordnen nur, wenn die Kopie ins Budget passt
+ */
+int planLayout(tiling_t * ctx)
+{
+    if (memFits(ctx, ctx->allTiles.amount * PLAN_LAYOUT_BYTES)) { return 1; }
+    ctx->plan.budgetBound = 1;
+    return 0;
+}
+
+/* Kacheln im Rest der Datei ab der aktuellen Position, mit der
+ * Zeilenlaenge aus den ersten PLAN_SAMPLE_BYTES (sonst PLAN_LINE_BYTES)
+ */
+static unsigned long long estimateTiles(int fd, off_t size)
+{
+    char sample[PLAN_SAMPLE_BYTES];
+    off_t at = lseek(fd, 0, SEEK_CUR);
+    if (at < 0 || at > size) { at = 0; }
+    unsigned long long bytes = (unsigned long long) (size - at);
+    ssize_t got = pread(fd, sample, sizeof(sample), at);
+    size_t lines = 0;
+    for (ssize_t i = 0; i < got; i++) { lines += sample[i] == '\n'; }
+    if (got < (ssize_t) sizeof(sample) || lines < 16) { return bytes / PLAN_LINE_BYTES; }
+    return bytes * lines / (unsigned long long) got;
+}
+
+/* Vor dem Einlesen: passt das Kachelfeld fuer die Eingabe nicht ins
+ * Budget, wird extern eingelesen (1), mit Laeufen, die hoechstens ein
+ * Viertel des Budgets belegen
+ *
+ * Geschaetzt wird mit der Zeilenlaenge am Anfang der Datei und dem
+ * Kachelfeld samt Verdopplung beim Wachsen, Sortierpuffer und Suchpuffern.
+ * Extern bleiben die Suchpuffer (reserveSearch() in tiling.c) und die
+ * Puffer zum Mischen (externalBytes()); passen auch die nicht, wird die
+ * Eingabe gar nicht erst gelesen (-1). Pipes und komprimierte Dateien haben
+ * keine bekannte Groesse, komprimierte kann ohnehin nur
+ * tilingLoadParallel() lesen.
+ */
+int tilingPlanInput(tiling_t * ctx, FILE * in, size_t * runSize)
+{
+    size_t budget = ctx->mem.budget;
+    if (!budget) { return 0; }
+    size_t keys = budget / 4 / PLAN_RUN_BYTES;
+    if (*runSize > keys) { *runSize = keys; }
+
+    struct stat st;
+    int fd = fileno(in);
+    if (fd < 0 || fstat(fd, &st) || !S_ISREG(st.st_mode) || fileCodec(fd) != CODEC_NONE) { return 0; }
+    unsigned long long tiles = estimateTiles(fd, st.st_size);
+    if (tiles <= budget / PLAN_TILE_BYTES) { return 0; }
+    if (tiles > SIZE_MAX / PLAN_SEARCH_BYTES
+        || tiles * PLAN_SEARCH_BYTES + externalBytes(ctx, (size_t) tiles, *runSize) > budget)
+    {
+        ctx->error = TILING_NO_BUDGET;
+        ctx->errData.i = (size_t) tiles;
+        return -1;
+    }
+    return 1;
+}
+
+void tilingPrintPlan(const tiling_t * ctx, FILE * out)
+{
+    const plan_t * plan = &ctx->plan;
+    if (ctx->ringSlots)
+    {
+        fprintf(out, "plan: compressed input, ring of %zu blocks x %zu bytes = %zu bytes\n",
+                ctx->ringSlots, ctx->ringBlock, ctx->ringSlots * ctx->ringBlock);
+    }
+    if (plan->engine == TILING_ENGINE_TINY)
+    {
+        fprintf(out, "plan: %zu tiles within 8x8 -> tiny\n", plan->amount);
+        return;
+    }
+    fprintf(out, "plan: %zu tiles, density %.3f, %zu odd runs, width %u, balance %lld, ",
+            plan->amount, plan->density, plan->oddRuns, plan->width, plan->balance);
+    if (plan->components)
+    {
+        fprintf(out, "%zu components", plan->components);
+    } else {
+        fprintf(out, "components not counted");
+    }
+    if (plan->budgetBound) { fprintf(out, ", limited by memory budget"); }
+    fprintf(out, " -> %s\n", tilingEngineName(plan->engine));
+}
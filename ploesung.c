@@ -309,6 +309,7 @@ tile_t* search(allTiles_t * allTiles, unsigned int index, unsigned int findX, un
 void link(allTiles_t* allTiles)
 {
     unsigned int i = 0;
+    unsigned int k = 0;     // Suche nach Ost ab k, (cx+1, cy) steigt mit i
     while ( i < allTiles->amount-1 )
     {
         tile_t * current = &allTiles->tiles[i];
@@ -326,7 +327,11 @@ void link(allTiles_t* allTiles)
                 north->edge = current;
             }
         }
-        tile_t * east = search(allTiles, i, cx + 1, cy);
+        if (cx + 1 == 0) { i++; continue; }
+        if (k < i) { k = i; }
+        while (k < allTiles->amount && (allTiles->tiles[k].p.x < cx + 1
+               || (allTiles->tiles[k].p.x == cx + 1 && allTiles->tiles[k].p.y < cy))) { k++; }
+        tile_t * east = search(allTiles, k, cx + 1, cy);
         if (east)
         {
             current->east = east;
@@ -418,6 +423,7 @@ void readStdIn(allTiles_t* allTiles)
 {
     char c;
     int i = 0;
+    unsigned int cap = 1;       // main legt 1 Kachel an, dann verdoppeln
     // File
     while ( (c = getchar()) != EOF)
     {
@@ -504,11 +510,16 @@ void readStdIn(allTiles_t* allTiles)
         while (c == ' ' || c == '\t') { c = getchar(); }
 
         allTiles->amount++;
-        tile_t* temp = (tile_t*) realloc(allTiles->tiles, allTiles->amount*sizeof(tile_t));
-        if (!temp)
+        tile_t* temp = allTiles->tiles;
+        if (allTiles->amount > cap)
         {
-            errMsg = (err) exceedMem;
-            return;
+            cap *= 2;
+            temp = (tile_t*) realloc(allTiles->tiles, cap*sizeof(tile_t));
+            if (!temp)
+            {
+                errMsg = (err) exceedMem;
+                return;
+            }
         }
 
         temp[allTiles->amount-1].p.x = (unsigned int) a;
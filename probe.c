@@ -0,0 +1,224 @@
+/* Zaehler je Phase (--counters text|json)
+ *
+ * Beim Anlegen werden ueber perf_event_open() Hardware-Zaehler (Takte,
+ * Befehle, Cache-Zugriffe und -Fehlzugriffe, Spruenge und falsch
+ * vorhergesagte Spruenge) und die Seitenfehler fuer diesen Prozess
+ * geoeffnet, mit inherit, damit auch Threads von --init-match und --count
+ * mitgezaehlt werden (sie sind am Ende ihrer Phase schon beendet).
+ *
+ * probePhase() liest an jeder Phasengrenze alle Zaehler und rechnet die
+ * Differenz der vorigen Phase zu. Teilt der Kern Zaehler im Wechsel, wird
+ * mit enabled/running hochgerechnet. Zaehler, die sich nicht oeffnen
+ * lassen (kein PMU in der VM, perf_event_paranoid), fehlen in der Ausgabe
+ * ("-" bzw. null); die Zeit je Phase gibt es immer.
+ */
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "loesung.h"
+
+typedef enum counter_e{
+    COUNTER_CYCLES = 0,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_REFS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_BRANCHES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_PAGE_FAULTS,
+    COUNTERS
+} counter_t;
+
+static const struct{
+    const char * name;
+    uint32_t type;
+    uint64_t config;
+} counters[COUNTERS] = {
+    [COUNTER_CYCLES]        = { "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [COUNTER_INSTRUCTIONS]  = { "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [COUNTER_CACHE_REFS]    = { "cache-refs",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+    [COUNTER_CACHE_MISSES]  = { "cache-misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    [COUNTER_BRANCHES]      = { "branches",      PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+    [COUNTER_BRANCH_MISSES] = { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    [COUNTER_PAGE_FAULTS]   = { "page-faults",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+};
+
+const char * const phaseNames[PHASES] = {
+    [PHASE_PARSE] = "parse",
+    [PHASE_SORT]  = "sort",
+    [PHASE_LINK]  = "link",
+    [PHASE_MATCH] = "match",
+    [PHASE_COUNT] = "count",
+    [PHASE_PRINT] = "print",
+};
+
+struct probe_s{
+    int fd[COUNTERS];                   // -1: nicht verfuegbar
+    double start[COUNTERS];             // Stand zu Beginn der laufenden Phase
+    struct timespec startTime;
+    phase_t current;                    // PHASES: keine Phase laeuft
+
+    int used[PHASES];
+    double seconds[PHASES];
+    double values[PHASES][COUNTERS];
+};
+
+static int openCounter(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* Zaehlerstand, bei geteilten Zaehlern auf die ganze Laufzeit hochgerechnet
+ */
+static double readCounter(int fd)
+{
+    uint64_t v[3];      // Wert, enabled, running
+    if (read(fd, v, sizeof(v)) != (ssize_t) sizeof(v) || !v[2]) { return 0.0; }
+    return v[2] < v[1] ? (double) v[0] * (double) v[1] / (double) v[2] : (double) v[0];
+}
+
+probe_t * probeCreate(void)
+{
+    probe_t * probe = (probe_t *) calloc(1, sizeof(probe_t));
+    if (!probe) { return NULL; }
+    probe->current = PHASES;
+    for (int c = 0; c < COUNTERS; c++)
+    {
+        probe->fd[c] = openCounter(counters[c].type, counters[c].config);
+        if (probe->fd[c] >= 0) { ioctl(probe->fd[c], PERF_EVENT_IOC_ENABLE, 0); }
+    }
+    return probe;
+}
+
+void probeFree(probe_t * probe)
+{
+    if (!probe) { return; }
+    for (int c = 0; c < COUNTERS; c++)
+    {
+        if (probe->fd[c] >= 0) { close(probe->fd[c]); }
+    }
+    free(probe);
+    return;
+}
+
+/* Laufende Phase abschliessen und phase beginnen (PHASES: nur abschliessen)
+ *
+ * Eine Phase kann mehrfach laufen, die Werte werden addiert.
+ */
+void probePhase(probe_t * probe, phase_t phase)
+{
+    if (!probe) { return; }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double values[COUNTERS];
+    for (int c = 0; c < COUNTERS; c++) { values[c] = probe->fd[c] >= 0 ? readCounter(probe->fd[c]) : 0.0; }
+
+    if (probe->current < PHASES)
+    {
+        phase_t p = probe->current;
+        probe->used[p] = 1;
+        probe->seconds[p] += (double) (now.tv_sec - probe->startTime.tv_sec)
+                           + (double) (now.tv_nsec - probe->startTime.tv_nsec) * 1e-9;
+        for (int c = 0; c < COUNTERS; c++) { probe->values[p][c] += values[c] - probe->start[c]; }
+    }
+    probe->current = phase;
+    probe->startTime = now;
+    memcpy(probe->start, values, sizeof(values));
+    return;
+}
+
+void probePrint(const probe_t * probe, FILE * out, int json)
+{
+    if (!probe) { return; }
+    int first = 1;
+    if (json)
+    {
+        fprintf(out, "{\"phases\": [");
+    } else {
+        fprintf(out, "%-6s %10s", "phase", "seconds");
+        for (int c = 0; c < COUNTERS; c++) { fprintf(out, " %14s", counters[c].name); }
+        fprintf(out, " %6s\n", "IPC");
+    }
+    for (int p = 0; p < PHASES; p++)
+    {
+        if (!probe->used[p]) { continue; }
+        const double * v = probe->values[p];
+        int ipc = probe->fd[COUNTER_CYCLES] >= 0 && probe->fd[COUNTER_INSTRUCTIONS] >= 0 && v[COUNTER_CYCLES] > 0;
+        if (json)
+        {
+            fprintf(out, "%s\n  {\"name\": \"%s\", \"seconds\": %.6f", first ? "" : ",", phaseNames[p], probe->seconds[p]);
+            for (int c = 0; c < COUNTERS; c++)
+            {
+                if (probe->fd[c] >= 0)
+                {
+                    fprintf(out, ", \"%s\": %.0f", counters[c].name, v[c]);
+                } else {
+                    fprintf(out, ", \"%s\": null", counters[c].name);
+                }
+            }
+            if (ipc)
+            {
+                fprintf(out, ", \"ipc\": %.3f}", v[COUNTER_INSTRUCTIONS] / v[COUNTER_CYCLES]);
+            } else {
+                fprintf(out, ", \"ipc\": null}");
+            }
+        } else {
+            fprintf(out, "%-6s %10.6f", phaseNames[p], probe->seconds[p]);
+            for (int c = 0; c < COUNTERS; c++)
+            {
+                if (probe->fd[c] >= 0)
+                {
+                    fprintf(out, " %14.0f", v[c]);
+                } else {
+                    fprintf(out, " %14s", "-");
+                }
+            }
+            if (ipc)
+            {
+                fprintf(out, " %6.3f\n", v[COUNTER_INSTRUCTIONS] / v[COUNTER_CYCLES]);
+            } else {
+                fprintf(out, " %6s\n", "-");
+            }
+        }
+        first = 0;
+    }
+    if (json) { fprintf(out, "\n]}\n"); }
+    return;
+}
+
+int tilingSetCounters(tiling_t * ctx)
+{
+    if (ctx->probe) { return 0; }
+    ctx->probe = probeCreate();
+    if (!ctx->probe)
+    {
+        ctx->error = TILING_EXCEED_MEM;
+        return -1;
+    }
+    return 0;
+}
+
+void tilingPrintCounters(tiling_t * ctx, FILE * out, int json)
+{
+    tilingPhase(ctx, PHASES);
+    probePrint(ctx->probe, out, json);
+    return;
+}
@@ -0,0 +1,232 @@
+/* Fortlaufende Ausgabe (--progressive)
+ *
+ * Statt erst nach findCoverage() alles auszugeben, werden die Komponenten
+ * (shapes.c) der Reihe nach augmentiert und ihre Dominos sofort in eine
+ * beschraenkte Ausgabeschlange gelegt, die ein eigener Thread schreibt.
+ * Ist der Schreiber untaetig, geht jede fertige Komponente sofort hinaus,
+ * sonst wird bis PROGRESSIVE_CHUNK Bytes gesammelt.
+ *
+ * Reihenfolge: ohne --sorted-output kommen die Dominos je Komponente (in
+ * sich sortiert). Mit --sorted-output bleibt die globale Sortierung der
+ * normalen Ausgabe: die Komponenten sind nach ihrer ersten Kachel geordnet,
+ * also ist nach Komponente c jede Kachel vor der ersten Kachel von c+1
+ * fertig und kann ausgegeben werden.
+ *
+ * Abschluss: die letzte Zeile ist "OK" bei vollstaendiger Parkettierung und
+ * "None", falls eine Komponente keine hat; alle Zeilen davor sind dann
+ * ungueltig. Ungerade oder ungleich gefaerbte Komponenten werden vor der
+ * ersten Ausgabe erkannt, dann ist "None" die einzige Zeile.
+ *
+ * Es laeuft immer die allgemeine Suche je Komponente in sortierter
+ * Reihenfolge, ohne Cache; --engine, --layout und --cache weist loesung.c
+ * zusammen mit --progressive ab, statt sie stillschweigend zu uebergehen.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "loesung.h"
+
+#define PROGRESSIVE_SLOTS 8
+#define PROGRESSIVE_CHUNK (1 << 16)
+
+typedef struct chunk_s{
+    char * out;
+    size_t len;
+    size_t cap;
+} chunk_t;
+
+typedef struct writer_s{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+
+    chunk_t chunks[PROGRESSIVE_SLOTS];
+    size_t produced;        // uebergebene Stuecke
+    size_t written;
+    int finished;
+
+    FILE * out;
+    int failed;             // errno des Schreibfehlers, 0 = keiner
+} writer_t;
+
+static void * writeChunks(void * arg)
+{
+    writer_t * w = (writer_t *) arg;
+    pthread_mutex_lock(&w->lock);
+    while (1)
+    {
+        while (w->written == w->produced && !w->finished) { pthread_cond_wait(&w->changed, &w->lock); }
+        if (w->written == w->produced) { break; }
+        chunk_t * chunk = &w->chunks[w->written % PROGRESSIVE_SLOTS];
+        pthread_mutex_unlock(&w->lock);
+
+        if (fwrite(chunk->out, 1, chunk->len, w->out) != chunk->len || fflush(w->out)) { w->failed = errno ? errno : EIO; }
+
+        pthread_mutex_lock(&w->lock);
+        w->written++;
+        pthread_cond_broadcast(&w->changed);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+/* Stueck uebergeben, wenn es gross genug oder der Schreiber untaetig ist
+ *
+ * Danach gehoert dem Loeser wieder ein leeres Stueck.
+ */
+static chunk_t * hand(writer_t * w, chunk_t * chunk, int force)
+{
+    pthread_mutex_lock(&w->lock);
+    if (!chunk->len || (!force && chunk->len < PROGRESSIVE_CHUNK && w->written != w->produced))
+    {
+        pthread_mutex_unlock(&w->lock);
+        return chunk;
+    }
+    w->produced++;
+    pthread_cond_broadcast(&w->changed);
+    while (w->produced - w->written == PROGRESSIVE_SLOTS) { pthread_cond_wait(&w->changed, &w->lock); }
+    pthread_mutex_unlock(&w->lock);
+
+    chunk = &w->chunks[w->produced % PROGRESSIVE_SLOTS];
+    chunk->len = 0;
+    return chunk;
+}
+
+/* Komponente vollstaendig augmentieren
+ *
+ * 0: zugeordnet, 1: keine Parkettierung, -1: Fehler
+ */
+static int solveComponent(tiling_t * ctx, const size_t * member, const component_t * comp)
+{
+    tile_t * tiles = ctx->allTiles.tiles;
+    for (size_t k = 0; k < comp->amount; k++)
+    {
+        tile_t * t = &tiles[member[comp->begin + k]];
+        if (t->edge) { continue; }
+        int result = findAugmentedPath(ctx, ctx->allTiles.amount, t);
+        if (!result) { flipPath(ctx->path); }
+        resetTree(ctx->tree);
+        if (result) { return result; }
+    }
+    return 0;
+}
+
+void tilingProgressive(tiling_t * ctx, FILE * out, int sorted)
+{
+    if (ctx->error) { return; }
+    tilingPhase(ctx, PHASE_MATCH);
+    allTiles_t * allTiles = &ctx->allTiles;
+    tile_t * tiles = allTiles->tiles;
+    size_t amount = allTiles->amount;
+
+    size_t * rank = NULL;
+    size_t * member = NULL;
+    component_t * comps = NULL;
+    size_t amountComps = 0;
+    int result = 0;
+
+    if (amount)
+    {
+        if (sortTiles(ctx)) { return; }
+        linkTiles(allTiles);
+        rank = (size_t *) memAlloc(ctx, amount * sizeof(size_t));
+        member = (size_t *) memAlloc(ctx, amount * sizeof(size_t));
+        if (!rank || !member)
+        {
+            ctx->error = TILING_EXCEED_MEM;
+            goto err0;
+        }
+        if (findComponents(ctx, rank, member, &comps, &amountComps)) { goto err0; }
+    }
+
+    // Faerbung je Komponente pruefen, bevor etwas ausgegeben ist
+    for (size_t c = 0; c < amountComps && !result; c++)
+    {
+        long balance = 0;
+        for (size_t k = 0; k < comps[c].amount; k++)
+        {
+            point_t p = tiles[member[comps[c].begin + k]].p;
+            balance += (p.x + p.y) % 2 ? 1 : -1;
+        }
+        if (balance) { result = 1; }
+    }
+    if (result)
+    {
+        fprintf(out, none);
+        goto err0;
+    }
+
+    writer_t w;
+    memset(&w, 0, sizeof(w));
+    w.out = out;
+    pthread_mutex_init(&w.lock, NULL);
+    pthread_cond_init(&w.changed, NULL);
+    pthread_t id;
+    int threaded = !pthread_create(&id, NULL, writeChunks, &w);
+
+    chunk_t * chunk = &w.chunks[0];
+    size_t cursor = 0;
+    for (size_t c = 0; c < amountComps; c++)
+    {
+        result = solveComponent(ctx, member, &comps[c]);
+        if (result) { break; }
+
+        if (sorted)
+        {
+            size_t limit = c + 1 < amountComps ? member[comps[c + 1].begin] : amount;
+            for (; cursor < limit; cursor++)
+            {
+                tile_t * t = &tiles[cursor];
+                if (t < t->edge && formatDomino(t->p, t->edge->p, &chunk->out, &chunk->len, &chunk->cap)) { goto mem; }
+            }
+        } else {
+            for (size_t k = 0; k < comps[c].amount; k++)
+            {
+                tile_t * t = &tiles[member[comps[c].begin + k]];
+                if (t < t->edge && formatDomino(t->p, t->edge->p, &chunk->out, &chunk->len, &chunk->cap)) { goto mem; }
+            }
+        }
+        if (threaded) { chunk = hand(&w, chunk, 0); }
+    }
+    if (result < 0 && !ctx->error) { ctx->error = TILING_EXCEED_MEM; }
+    if (result >= 0)
+    {
+        const char * trailer = result ? none : "OK\n";
+        if (appendBytes(&chunk->out, &chunk->len, &chunk->cap, trailer, strlen(trailer))) { goto mem; }
+    }
+    goto end;
+
+mem:
+    ctx->error = TILING_EXCEED_MEM;
+    result = -1;
+end:
+    // ohne Schreiber (oder beim letzten Stueck) direkt bzw. erzwungen
+    if (threaded)
+    {
+        if (!ctx->error) { hand(&w, chunk, 1); }
+        pthread_mutex_lock(&w.lock);
+        w.finished = 1;
+        pthread_cond_broadcast(&w.changed);
+        pthread_mutex_unlock(&w.lock);
+        pthread_join(id, NULL);
+    } else if (!ctx->error) {
+        fwrite(chunk->out, 1, chunk->len, out);
+    }
+    if (w.failed && !ctx->error)
+    {
+        ctx->error = TILING_IO;
+        ctx->errData.s = strerror(w.failed);
+    }
+    ctx->tileable = !result;
+    for (size_t s = 0; s < PROGRESSIVE_SLOTS; s++) { free(w.chunks[s].out); }
+    pthread_cond_destroy(&w.changed);
+    pthread_mutex_destroy(&w.lock);
+
+err0:
+    memFree(ctx, rank);
+    memFree(ctx, member);
+    memFree(ctx, comps);
+    return;
+}
@@ -0,0 +1,239 @@
+/* scaling: Wachstum jeder Phase ueber die Eingabegroesse
+ *
+ *     scaling [--min N] [--max N] [--repeat R] [--seed S] [--verbose]
+ *
+ * Fuer jede Familie von Formen werden Instanzen mit N, 2N, 4N ... Kacheln
+ * bis --max (Standard 2^15 bis 2^20) erzeugt und in zufaelliger Reihenfolge
+ * als Text abgelegt. Jede Phase wird einzeln gemessen (bestes von R
+ * Laeufen, Standard 3): Einlesen (tilingLoadBuffer auf einem Kern),
+ * sortTiles(), linkTiles(), findCoverage(), printResult() nach /dev/null
+ * und die visited_by-Suche aus der Gegenprobe (crosscheck.c).
+ *
+ * Aus den Zeiten ueber 0.1 ms wird per kleinster Quadrate die Steigung von
+ * log(Zeit) ueber log(N) geschaetzt. Sobald das Kachelfeld nicht mehr in den
+ * Cache passt, steigen auch lineare Phasen: gemessen (1 Kern, 2^15 bis 2^20)
+ * link 1.15 bis 1.23 bei 6.4 ns je Kachel mit 32k und 12.9 ns mit 1M
+ * Kacheln, von 2M auf 4M wieder genau linear. Deshalb laeuft je Groesse
+ * eine Referenz mit: ein Durchgang ueber das Feld, der jede Kachel liest und
+ * schreibt ("sweep"). Ihr Exponent minus 1 ist der Anteil des Speichers und
+ * wird von jeder Phase abgezogen ("corrected").
+ *
+ * Jede Phase hat ein erklaertes Budget; liegt der bereinigte Exponent mehr
+ * als SCALING_SLACK darueber, endet das Programm mit 1. So faellt etwa ein
+ * quadratisches Verbinden (lineare Suche je Kachel), ein Neustart der Suche
+ * nach freien Kacheln bei Index 0 oder schon ein n^1.2 in einer linearen
+ * Phase auf, bevor es grosse Eingaben trifft.
+ *
+ * Familien nach Kachelzahl aus instances.c: volles Quadrat, Streifen der
+ * Breite 2 (lange Spalten), Quadrat ohne ausgerichtete waagrechte Dominos
+ * (parkettierbar, aber die gierige Zuordnung laesst freie Kacheln fuer die
+ * augmentierenden Wege).
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "loesung.h"
+#include "instances.h"
+
+#define SCALING_SLACK 0.15      // Rauschen nach Abzug der Referenz
+#define SCALING_FLOOR 1e-4      // kuerzere Zeiten sind Rauschen
+#define SCALING_SIZES 32
+#define SCALING_SWEEPS 8        // Referenz ueber SCALING_FLOOR heben
+
+typedef enum stage_e{
+    STAGE_PARSE = 0,
+    STAGE_SORT,
+    STAGE_LINK,
+    STAGE_MATCH,
+    STAGE_PRINT,
+    STAGE_VISITED,
+    STAGE_SWEEP,            // Referenz, wird nicht bewertet
+    STAGES
+} stage_t;
+
+static const struct{
+    const char * name;
+    double budget;          // erklaerter Exponent
+} stages[STAGES] = {
+    [STAGE_PARSE]   = { "parse",   1.0 },
+    [STAGE_SORT]    = { "sort",    1.1 },   // n log n
+    [STAGE_LINK]    = { "link",    1.0 },
+    [STAGE_MATCH]   = { "match",   1.5 },   // augmentierende Wege je freier Kachel
+    [STAGE_PRINT]   = { "print",   1.0 },
+    [STAGE_VISITED] = { "visited", 1.5 },
+    [STAGE_SWEEP]   = { "sweep",   1.0 },
+};
+
+/* Referenz: jede Kachel einmal lesen und schreiben, in sortierter
+ * Reihenfolge wie linkTiles()
+ */
+static void sweep(allTiles_t * allTiles)
+{
+    tile_t * tiles = allTiles->tiles;
+    for (size_t i = 0; i + 1 < allTiles->amount; i++)
+    {
+        tiles[i].depth = (size_t) tiles[i].p.x + tiles[i + 1].p.y;
+    }
+}
+
+/* Alle Phasen einmal, Zeiten in seconds
+ */
+static int measure(tiling_t * ctx, const char * text, size_t len, FILE * sink, double * seconds)
+{
+    double t0 = wallClock();
+    if (tilingLoadBuffer(ctx, text, len, 1)) { return -1; }
+    double t1 = wallClock();
+    if (sortTiles(ctx)) { return -1; }
+    double t2 = wallClock();
+    linkTiles(&ctx->allTiles);
+    double t3 = wallClock();
+    int result = findCoverage(ctx);
+    if (result < 0) { return -1; }
+    double t4 = wallClock();
+    ctx->tileable = !result;
+    tilingRewind(ctx);
+    printResult(ctx, sink);
+    fflush(sink);
+    double t5 = wallClock();
+    seconds[STAGE_PARSE] = t1 - t0;
+    seconds[STAGE_SORT] = t2 - t1;
+    seconds[STAGE_LINK] = t3 - t2;
+    seconds[STAGE_MATCH] = t4 - t3;
+    seconds[STAGE_PRINT] = t5 - t4;
+    for (int pass = 0; pass < SCALING_SWEEPS; pass++) { sweep(&ctx->allTiles); }
+    seconds[STAGE_SWEEP] = wallClock() - t5;
+
+    tilingCross_t report;
+    if (tilingLoadBuffer(ctx, text, len, 1) || tilingCrossCheck(ctx, &report) < 0) { return -1; }
+    seconds[STAGE_VISITED] = report.seconds[1];
+    return 0;
+}
+
+/* Steigung von log(t) ueber log(n), NAN bei weniger als 3 brauchbaren Punkten
+ */
+static double slope(const double * n, const double * t, int amount)
+{
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    int used = 0;
+    for (int i = 0; i < amount; i++)
+    {
+        if (t[i] < SCALING_FLOOR) { continue; }
+        double x = log(n[i]);
+        double y = log(t[i]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        used++;
+    }
+    if (used < 3) { return NAN; }
+    return (used * sxy - sx * sy) / (used * sxx - sx * sx);
+}
+
+int main(int argc, char** argv)
+{
+    size_t minSize = (size_t) 1 << 15;
+    size_t maxSize = (size_t) 1 << 20;
+    int repeat = 3;
+    unsigned long long seed = 1;
+    int verbose = 0;
+    for (int a = 1; a < argc; a++)
+    {
+        if (!strcmp(argv[a], "--min") && a+1 < argc) { minSize = strtoull(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--max") && a+1 < argc) { maxSize = strtoull(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--repeat") && a+1 < argc) { repeat = atoi(argv[++a]); continue; }
+        if (!strcmp(argv[a], "--seed") && a+1 < argc) { seed = strtoull(argv[++a], NULL, 10); continue; }
+        if (!strcmp(argv[a], "--verbose")) { verbose = 1; continue; }
+        fprintf(stderr, "Unknown or incomplete option '%s'!\n", argv[a]);
+        return 2;
+    }
+    if (minSize < 16) { minSize = 16; }
+    if (repeat < 1) { repeat = 1; }
+    random_t rng;
+    randomSeed(&rng, seed);
+
+    int status = 2;
+    tiling_t * ctx = tilingCreate();
+    point_t * points = (point_t *) malloc(maxSize * sizeof(point_t));
+    FILE * sink = fopen("/dev/null", "w");
+    if (!ctx || !points || !sink)
+    {
+        fprintf(stderr, "Not enough memory available!\n");
+        goto err0;
+    }
+
+    status = 0;
+    printf("%-7s %-7s %9s %9s %7s  %s\n", "family", "phase", "exponent", "corrected", "budget", "result");
+    for (int f = 0; f < FAMILY_SCALING; f++)
+    {
+        double sizes[SCALING_SIZES];
+        double best[STAGES][SCALING_SIZES];
+        int amount = 0;
+        for (size_t n = minSize; n <= maxSize && amount < SCALING_SIZES; n *= 2)
+        {
+            size_t tiles = makeFamily(points, (family_t) f, n, &rng);
+            size_t len;
+            char * text = pointsText(points, tiles, &len);
+            if (!text)
+            {
+                fprintf(stderr, "Not enough memory available!\n");
+                status = 2;
+                goto err0;
+            }
+            for (int s = 0; s < STAGES; s++) { best[s][amount] = INFINITY; }
+            for (int r = 0; r < repeat; r++)
+            {
+                double seconds[STAGES];
+                if (measure(ctx, text, len, sink, seconds))
+                {
+                    tilingPrintError(ctx, stderr);
+                    free(text);
+                    status = 2;
+                    goto err0;
+                }
+                for (int s = 0; s < STAGES; s++)
+                {
+                    if (seconds[s] < best[s][amount]) { best[s][amount] = seconds[s]; }
+                }
+            }
+            free(text);
+            sizes[amount] = (double) tiles;
+            if (verbose)
+            {
+                fprintf(stderr, "%-7s %9zu tiles:", familyNames[f], tiles);
+                for (int s = 0; s < STAGES; s++) { fprintf(stderr, " %s %.6f", stages[s].name, best[s][amount]); }
+                fprintf(stderr, "\n");
+            }
+            amount++;
+        }
+
+        double memory = slope(sizes, best[STAGE_SWEEP], amount) - 1.0;
+        if (isnan(memory) || memory < 0.0) { memory = 0.0; }
+        for (int s = 0; s < STAGES; s++)
+        {
+            double e = slope(sizes, best[s], amount);
+            double limit = stages[s].budget + SCALING_SLACK;
+            if (isnan(e))
+            {
+                printf("%-7s %-7s %9s %9s %7.2f  too fast to fit\n", familyNames[f], stages[s].name, "-", "-", stages[s].budget);
+                continue;
+            }
+            if (s == STAGE_SWEEP)
+            {
+                printf("%-7s %-7s %9.2f %9s %7s  reference\n", familyNames[f], stages[s].name, e, "-", "-");
+                continue;
+            }
+            int fail = e - memory > limit;
+            printf("%-7s %-7s %9.2f %9.2f %7.2f  %s\n", familyNames[f], stages[s].name, e, e - memory, stages[s].budget, fail ? "FAIL" : "ok");
+            if (fail) { status = 1; }
+        }
+    }
+
+err0:
+    if (sink) { fclose(sink); }
+    free(points);
+    tilingFree(ctx);
+    return status;
+}
@@ -0,0 +1,204 @@
+/* Komponenten und wiederkehrende Formen (--shapes)
+ *
+ * Nach linkTiles() werden die Zusammenhangskomponenten bestimmt und ihre
+ * Kacheln in sortierter Reihenfolge gruppiert (das nutzt auch
+ * --progressive). Um den kleinsten x- und y-Wert verschoben ergibt jede
+ * Komponente eine kanonische Form; gleiche Formen haben dann dieselbe Folge
+ * verschobener Koordinaten. Eine
+ * Hash-Tabelle ordnet jeder Komponente die erste mit gleicher Form zu.
+ *
+ * Nur diese Vertreter laufen durch die augmentierenden Suchen, jede weitere
+ * Komponente uebernimmt die Zuordnung ihres Vertreters ueber den Rang der
+ * Kacheln innerhalb der Komponente. Einlesen, sort() und linkTiles() bleiben
+ * linear in den Kacheln, die Suchen skalieren mit den verschiedenen Formen.
+ * Scheitert ein Vertreter, gibt es keine Parkettierung ("None").
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "loesung.h"
+
+static uint64_t mixShape(uint64_t h, uint64_t v)
+{
+    h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h * 0xff51afd7ed558ccdull;
+}
+
+static int sameShape(const tile_t * tiles, const size_t * member, const component_t * a, const component_t * b)
+{
+    if (a->amount != b->amount || a->hash != b->hash) { return 0; }
+    for (size_t k = 0; k < a->amount; k++)
+    {
+        point_t p = tiles[member[a->begin + k]].p;
+        point_t q = tiles[member[b->begin + k]].p;
+        if (p.x - a->minX != q.x - b->minX || p.y - a->minY != q.y - b->minY) { return 0; }
+    }
+    return 1;
+}
+
+int findComponents(tiling_t * ctx, size_t * rank, size_t * member, component_t ** compsOut, size_t * amountOut)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    tile_t * tiles = allTiles->tiles;
+    size_t amount = allTiles->amount;
+    size_t * compOf = rank;
+    size_t * queue = member;        // Warteschlange, bevor gruppiert wird
+    component_t * comps = NULL;
+
+    /* Komponenten per Breitensuche ueber die Nachbarzeiger
+     */
+    size_t amountComps = 0;
+    for (size_t i = 0; i < amount; i++) { compOf[i] = SIZE_MAX; }
+    for (size_t i = 0; i < amount; i++)
+    {
+        if (compOf[i] != SIZE_MAX) { continue; }
+        size_t head = 0;
+        size_t tail = 0;
+        queue[tail++] = i;
+        compOf[i] = amountComps;
+        while (head < tail)
+        {
+            tile_t * t = &tiles[queue[head++]];
+            tile_t * next[4] = { t->north, t->east, t->south, t->west };
+            for (int d = 0; d < 4; d++)
+            {
+                if (!next[d]) { continue; }
+                size_t n = (size_t) (next[d] - tiles);
+                if (compOf[n] != SIZE_MAX) { continue; }
+                compOf[n] = amountComps;
+                queue[tail++] = n;
+            }
+        }
+        amountComps++;
+    }
+
+    /* stabil nach Komponente gruppieren, innerhalb bleibt die Sortierung
+     */
+    comps = (component_t *) memCalloc(ctx, amountComps ? amountComps : 1, sizeof(component_t));
+    if (!comps)
+    {
+        ctx->error = TILING_EXCEED_MEM;
+        return -1;
+    }
+    for (size_t i = 0; i < amount; i++) { comps[compOf[i]].amount++; }
+    for (size_t c = 0, begin = 0; c < amountComps; c++)
+    {
+        comps[c].begin = begin;
+        begin += comps[c].amount;
+        comps[c].amount = 0;
+        comps[c].minY = UINT32_MAX;
+    }
+    for (size_t i = 0; i < amount; i++)
+    {
+        component_t * c = &comps[compOf[i]];
+        if (!c->amount) { c->minX = tiles[i].p.x; }
+        if (tiles[i].p.y < c->minY) { c->minY = tiles[i].p.y; }
+        compOf[i] = c->amount;
+        member[c->begin + c->amount++] = i;
+    }
+    *compsOut = comps;
+    *amountOut = amountComps;
+    return 0;
+}
+
+int shapeSolve(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    tile_t * tiles = allTiles->tiles;
+    size_t amount = allTiles->amount;
+    int result = -1;
+
+    size_t * rank = ctx->compRank;
+    size_t * member = ctx->compMember;
+    component_t * comps = ctx->comps;
+    size_t amountComps = ctx->amountComps;
+    size_t * table = NULL;
+    ctx->compRank = NULL;
+    ctx->compMember = NULL;
+    ctx->comps = NULL;
+    ctx->amountComps = 0;
+    if (!comps)
+    {
+        // ohne Planer (--engine shapes) selbst suchen
+        rank = (size_t *) memAlloc(ctx, amount * sizeof(size_t));
+        member = (size_t *) memAlloc(ctx, amount * sizeof(size_t));
+        if (!rank || !member) { goto mem; }
+        if (findComponents(ctx, rank, member, &comps, &amountComps)) { goto end; }
+    }
+
+    /* Formen: Hash der verschobenen Koordinaten, offene Adressierung
+     */
+    size_t capTable = 16;
+    while (capTable < 2 * amountComps) { capTable *= 2; }
+    table = (size_t *) memAlloc(ctx, capTable * sizeof(size_t));
+    if (!table) { goto mem; }
+    for (size_t s = 0; s < capTable; s++) { table[s] = SIZE_MAX; }
+
+    size_t amountShapes = 0;
+    for (size_t c = 0; c < amountComps; c++)
+    {
+        component_t * comp = &comps[c];
+        uint64_t h = comp->amount;
+        for (size_t k = 0; k < comp->amount; k++)
+        {
+            point_t p = tiles[member[comp->begin + k]].p;
+            h = mixShape(h, (uint64_t) (p.x - comp->minX) << 32 | (p.y - comp->minY));
+        }
+        comp->hash = h;
+
+        size_t s = (size_t) h & (capTable - 1);
+        while (table[s] != SIZE_MAX && !sameShape(tiles, member, &comps[table[s]], comp))
+        {
+            s = (s + 1) & (capTable - 1);
+        }
+        if (table[s] == SIZE_MAX)
+        {
+            table[s] = c;
+            amountShapes++;
+        }
+        comp->shape = table[s];
+    }
+    ctx->amountComponents = amountComps;
+    ctx->amountShapes = amountShapes;
+
+    /* Vertreter augmentieren, Kopien uebernehmen deren Zuordnung
+     */
+    result = 0;
+    for (size_t c = 0; c < amountComps && !result; c++)
+    {
+        component_t * comp = &comps[c];
+        if (comp->shape == c)
+        {
+            if (comp->amount % 2) { result = 1; break; }
+            for (size_t k = 0; k < comp->amount && !result; k++)
+            {
+                tile_t * t = &tiles[member[comp->begin + k]];
+                if (t->edge) { continue; }
+                result = findAugmentedPath(ctx, amount, t);
+                if (!result) { flipPath(ctx->path); }
+                resetTree(ctx->tree);
+            }
+            continue;
+        }
+
+        const component_t * shape = &comps[comp->shape];
+        for (size_t k = 0; k < comp->amount; k++)
+        {
+            tile_t * partner = tiles[member[shape->begin + k]].edge;
+            size_t j = rank[partner - tiles];
+            tiles[member[comp->begin + k]].edge = &tiles[member[comp->begin + j]];
+        }
+    }
+    if (result < 0 && !ctx->error) { ctx->error = TILING_EXCEED_MEM; }
+    goto end;
+
+mem:
+    ctx->error = TILING_EXCEED_MEM;
+end:
+    memFree(ctx, rank);
+    memFree(ctx, member);
+    memFree(ctx, comps);
+    memFree(ctx, table);
+    return result;
+}
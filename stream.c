@@ -0,0 +1,494 @@
+/* Streaming-Loeser fuer schmale Baender
+ *
+ * Die Eingabe wird spaltenweise in aufsteigender x Reihenfolge gelesen. Jede
+ * Spalte ist eine Bitmaske (hoechstens 32 Zellen ab ihrem kleinsten y). Die
+ * Profile sind die Zellen der naechsten Spalte, die schon von waagerechten
+ * Dominos der aktuellen Spalte belegt sind. Gespeichert werden nur die
+ * erreichbaren Profile, nie der ganze Graph. advance() geht die Spalte
+ * Zelle fuer Zelle durch (gebrochenes Profil), die Zeit je Spalte ist
+ * Hoehe mal Groesse der Profilmenge; die Menge selbst kann bei vollen
+ * Baendern bis 2^Hoehe wachsen.
+ *
+ * Rekonstruktion: alle STREAM_SEGMENT Spalten merkt sich der Vorwaertslauf
+ * den Byte-Offset und die Profilmenge. Rueckwaerts wird jedes Segment neu
+ * gelesen, um das Profil an seinem Anfang festzulegen; ein letzter
+ * Vorwaertslauf gibt die Dominos Segment fuer Segment aus. Dafuer muss die
+ * Eingabe seekbar sein (Datei, keine Pipe).
+ *
+ * Speicher: die Checkpoints belegen (Laenge / STREAM_SEGMENT) mal die
+ * Groesse einer Profilmenge, die Rekonstruktion haelt dazu die
+ * STREAM_SEGMENT + 1 Profilmengen eines Segments.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "loesung.h"
+
+#define STREAM_WIDTH 32
+#ifndef STREAM_SEGMENT
+#define STREAM_SEGMENT 4096
+#endif
+
+
+typedef struct column_s{
+    unsigned int x;
+    unsigned int base;          // kleinstes y der Spalte
+    uint32_t mask;              // Bit i: Kachel (x, base+i)
+    unsigned long long offset;  // Byte-Offset der ersten Zeile
+    size_t line;
+} column_t;
+
+typedef struct profiles_s{
+    uint32_t * p;
+    size_t len;
+    size_t cap;
+} profiles_t;
+
+typedef struct reader_s{
+    tiling_t * ctx;
+    input_t input;
+    point_t pending;
+    unsigned long long pendingOffset;
+    size_t pendingLine;
+    int hasPending;
+    int done;
+    profiles_t work[3];         // Zwischenpuffer fuer advance()
+} reader_t;
+
+typedef struct checkpoint_s{
+    column_t first;
+    profiles_t in;
+} checkpoint_t;
+
+static int pushProfile(profiles_t * set, uint32_t p)
+{
+    if (set->len == set->cap)
+    {
+        size_t cap = set->cap ? set->cap * 2 : 8;
+        uint32_t * temp = (uint32_t *) realloc(set->p, cap * sizeof(uint32_t));
+        if (!temp) { return -1; }
+        set->p = temp;
+        set->cap = cap;
+    }
+    set->p[set->len++] = p;
+    return 0;
+}
+
+/* Maske aus dem Rahmen "from" in den Rahmen "to" verschieben,
+ * herausfallende Bits gehen verloren
+ */
+static uint32_t shiftFrame(uint32_t mask, unsigned int from, unsigned int to)
+{
+    uint64_t m = mask;
+    if (from >= to)
+    {
+        return (from - to) >= STREAM_WIDTH ? 0 : (uint32_t) (m << (from - to));
+    }
+    return (to - from) >= STREAM_WIDTH ? 0 : (uint32_t) (m >> (to - from));
+}
+
+/* rem besteht nur aus senkrechten Paaren
+ */
+static int verticalOnly(uint32_t rem)
+{
+    while (rem)
+    {
+        uint32_t low = rem & -rem;
+        if (!(rem & (low << 1))) { return 0; }
+        rem &= ~(low | (low << 1));
+    }
+    return 1;
+}
+
+/* Spalte lesen: alle Kacheln mit gleichem x
+ *
+ * 1: Spalte gelesen, 0: Ende, -1: Fehler
+ */
+static int readColumn(reader_t * r, column_t * col)
+{
+    if (!r->hasPending)
+    {
+        if (r->done) { return 0; }
+        r->pendingOffset = r->input.offset;
+        int status = readLine(r->ctx, &r->input, &r->pending);
+        if (status <= 0) { r->done = 1; return status; }
+        r->pendingLine = r->input.line;
+        r->hasPending = 1;
+    }
+
+    unsigned int ys[STREAM_WIDTH];
+    unsigned int amount = 0;
+    col->x = r->pending.x;
+    col->offset = r->pendingOffset;
+    col->line = r->pendingLine;
+
+    while (r->hasPending && r->pending.x == col->x)
+    {
+        if (amount == STREAM_WIDTH)
+        {
+            r->ctx->error = TILING_TOO_WIDE;
+            r->ctx->errData.i = r->pendingLine;
+            return -1;
+        }
+        ys[amount++] = r->pending.y;
+
+        r->pendingOffset = r->input.offset;
+        int status = readLine(r->ctx, &r->input, &r->pending);
+        if (status < 0) { return -1; }
+        if (status == 0)
+        {
+            r->hasPending = 0;
+            r->done = 1;
+            break;
+        }
+        r->pendingLine = r->input.line;
+        if (r->pending.x < col->x)
+        {
+            r->ctx->error = TILING_UNSORTED;
+            r->ctx->errData.i = r->pendingLine;
+            return -1;
+        }
+    }
+
+    unsigned int base = ys[0];
+    for (unsigned int i = 1; i < amount; i++)
+    {
+        if (ys[i] < base) { base = ys[i]; }
+    }
+    col->base = base;
+    col->mask = 0;
+    for (unsigned int i = 0; i < amount; i++)
+    {
+        if (ys[i] - base >= STREAM_WIDTH)
+        {
+            r->ctx->error = TILING_TOO_WIDE;
+            r->ctx->errData.i = col->line;
+            return -1;
+        }
+        uint32_t bit = (uint32_t) 1 << (ys[i] - base);
+        if (col->mask & bit)
+        {
+            r->ctx->error = TILING_DOUBLE_LINE;
+            return -1;
+        }
+        col->mask |= bit;
+    }
+    return 1;
+}
+
+static int seekReader(reader_t * r, const column_t * col)
+{
+    if (fseek(r->input.in, (long) col->offset, SEEK_SET)) { return -1; }
+    r->input.offset = col->offset;
+    r->input.line = col->line - 1;
+    r->hasPending = 0;
+    r->done = 0;
+    return 0;
+}
+
+/* Drei sortierte Mengen ohne Doppelte nach out mischen
+ */
+static int mergeProfiles(const profiles_t * a, const profiles_t * b, const profiles_t * c, profiles_t * out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t k = 0;
+    out->len = 0;
+    while (i < a->len || j < b->len || k < c->len)
+    {
+        uint32_t p = UINT32_MAX;
+        if (i < a->len && a->p[i] < p) { p = a->p[i]; }
+        if (j < b->len && b->p[j] < p) { p = b->p[j]; }
+        if (k < c->len && c->p[k] < p) { p = c->p[k]; }
+        if (i < a->len && a->p[i] == p) { i++; }
+        if (j < b->len && b->p[j] == p) { j++; }
+        if (k < c->len && c->p[k] == p) { k++; }
+        if (pushProfile(out, p)) { return -1; }
+    }
+    return 0;
+}
+
+/* Profile hinter col, next ist die folgende Spalte oder NULL
+ *
+ * Gebrochenes Profil: die Spalte wird Zelle fuer Zelle abgearbeitet. Im
+ * Zustand sind die Bits unter der aktuellen Zelle schon das Profil fuer die
+ * naechste Spalte (waagerechte Dominos), die ab der Zelle die belegten Zellen
+ * der aktuellen Spalte (eingehendes Profil oder senkrechtes Domino von unten).
+ * Aus einer sortierten Zustandsmenge entstehen je Zelle drei sortierte
+ * Teilmengen (Zelle war belegt, waagerecht, senkrecht), die ohne Doppelte
+ * zusammengemischt werden. Die Arbeit je Spalte ist also Hoehe mal Zahl
+ * der Zustaende statt aller Belegungen je eingehendem Profil. work sind
+ * drei Zwischenpuffer des Aufrufers.
+ */
+static int advance(const column_t * col, const column_t * next, const profiles_t * in, profiles_t * out, profiles_t * work)
+{
+    uint32_t allowed = 0;
+    unsigned int to = col->base;
+    if (next && next->x == col->x + 1)
+    {
+        allowed = col->mask & shiftFrame(next->mask, next->base, col->base);
+        to = next->base;
+    }
+    out->len = 0;
+    for (size_t i = 0; i < in->len; i++)
+    {
+        if (pushProfile(out, in->p[i])) { return -1; }
+    }
+    profiles_t * taken = &work[0];
+    profiles_t * horizontal = &work[1];
+    profiles_t * vertical = &work[2];
+    for (uint32_t rest = col->mask; rest && out->len; rest &= rest - 1)
+    {
+        uint32_t low = rest & -rest;
+        uint32_t above = col->mask & (low << 1);
+        taken->len = horizontal->len = vertical->len = 0;
+        for (size_t i = 0; i < out->len; i++)
+        {
+            uint32_t state = out->p[i];
+            if (state & low)
+            {
+                if (pushProfile(taken, state & ~low)) { return -1; }
+                continue;
+            }
+            if ((allowed & low) && pushProfile(horizontal, state | low)) { return -1; }
+            if (above && !(state & above) && pushProfile(vertical, state | above)) { return -1; }
+        }
+        if (mergeProfiles(taken, horizontal, vertical, out)) { return -1; }
+    }
+    // die Bits liegen alle in allowed, fallen also nicht heraus, und die Reihenfolge bleibt
+    for (size_t i = 0; i < out->len; i++) { out->p[i] = shiftFrame(out->p[i], col->base, to); }
+    return 0;
+}
+
+/* Vorgaenger: ein Profil aus in, von dem col nach "out" fuehrt
+ */
+static int predecessor(const column_t * col, const column_t * next, const profiles_t * in, uint32_t out, uint32_t * found)
+{
+    uint32_t allowed = 0;
+    uint32_t h = 0;
+    if (next && next->x == col->x + 1)
+    {
+        allowed = col->mask & shiftFrame(next->mask, next->base, col->base);
+        h = shiftFrame(out, next->base, col->base);
+        if (shiftFrame(h, col->base, next->base) != out) { return 0; }
+    } else if (out) {
+        return 0;
+    }
+    if (h & ~allowed) { return 0; }
+
+    for (size_t i = 0; i < in->len; i++)
+    {
+        uint32_t free = col->mask & ~in->p[i];
+        if ((h & ~free) || !verticalOnly(free & ~h)) { continue; }
+        *found = in->p[i];
+        return 1;
+    }
+    return 0;
+}
+
+static void printColumn(const column_t * col, uint32_t in, uint32_t h)
+{
+    uint32_t free = col->mask & ~in;
+    while (free)
+    {
+        uint32_t low = free & -free;
+        unsigned int y = col->base;
+        for (uint32_t b = low; b > 1; b >>= 1) { y++; }
+        if (h & low)
+        {
+            fprintf(stdout, "%u %u;%u %u\n", col->x, y, col->x + 1, y);
+            free &= ~low;
+        } else {
+            fprintf(stdout, "%u %u;%u %u\n", col->x, y, col->x, y + 1);
+            free &= ~(low | (low << 1));
+        }
+    }
+}
+
+/* Ein Segment ab seiner ersten Spalte neu lesen und alle Profilmengen
+ * speichern. cols[amount] ist die Spalte nach dem Segment (falls vorhanden).
+ */
+static int replaySegment(reader_t * r, const checkpoint_t * cp, const profiles_t * start, column_t * cols, profiles_t * sets, unsigned int * amount, int * hasNext)
+{
+    if (seekReader(r, &cp->first)) { r->ctx->error = TILING_NO_SEEK; return -1; }
+
+    unsigned int k = 0;
+    int status = readColumn(r, &cols[0]);
+    if (status <= 0)
+    {
+        if (!status) { r->ctx->error = TILING_CHANGED; }
+        return -1;
+    }
+    sets[0].len = 0;
+    for (size_t i = 0; i < start->len; i++)
+    {
+        if (pushProfile(&sets[0], start->p[i])) { r->ctx->error = TILING_EXCEED_MEM; return -1; }
+    }
+    while (1)
+    {
+        status = readColumn(r, &cols[k+1]);
+        if (status < 0) { return -1; }
+        if (k+1 == STREAM_SEGMENT || !status) { break; }
+        if (advance(&cols[k], &cols[k+1], &sets[k], &sets[k+1], r->work)) { r->ctx->error = TILING_EXCEED_MEM; return -1; }
+        k++;
+    }
+    *hasNext = status;
+    *amount = k+1;
+    return 0;
+}
+
+void tilingStream(tiling_t * ctx, FILE * in)
+{
+    reader_t r;
+    r.ctx = ctx;
+    r.input.in = in;
+    r.input.line = 0;
+    r.input.offset = 0;
+    r.hasPending = 0;
+    r.done = 0;
+    for (int w = 0; w < 3; w++)
+    {
+        r.work[w].p = NULL;
+        r.work[w].len = r.work[w].cap = 0;
+    }
+
+    int seekable = ftell(in) >= 0;
+    checkpoint_t * checkpoints = NULL;
+    size_t amountCp = 0;
+    size_t capCp = 0;
+    uint32_t * boundary = NULL;
+    uint32_t * outs = NULL;
+    column_t * cols = NULL;
+    profiles_t * sets = NULL;
+    profiles_t cur = { NULL, 0, 0 };
+    profiles_t nxt = { NULL, 0, 0 };
+    column_t col;
+    column_t next;
+    int tileable = 1;
+
+    // Vorwaertslauf: entscheiden, Checkpoints merken
+    int status = readColumn(&r, &col);
+    if (status <= 0) { goto end; }
+    if (pushProfile(&cur, 0)) { goto mem; }
+    unsigned long long index = 0;
+    while (1)
+    {
+        if (seekable && index % STREAM_SEGMENT == 0)
+        {
+            if (amountCp == capCp)
+            {
+                capCp = capCp ? capCp * 2 : 16;
+                checkpoint_t * temp = (checkpoint_t *) realloc(checkpoints, capCp * sizeof(checkpoint_t));
+                if (!temp) { goto mem; }
+                checkpoints = temp;
+            }
+            checkpoint_t * cp = &checkpoints[amountCp++];
+            cp->first = col;
+            cp->in.p = NULL;
+            cp->in.len = cp->in.cap = 0;
+            for (size_t i = 0; i < cur.len; i++)
+            {
+                if (pushProfile(&cp->in, cur.p[i])) { goto mem; }
+            }
+        }
+
+        status = readColumn(&r, &next);
+        if (status < 0) { goto end; }
+        if (advance(&col, status ? &next : NULL, &cur, &nxt, r.work)) { goto mem; }
+        profiles_t swap = cur;
+        cur = nxt;
+        nxt = swap;
+        index++;
+
+        if (!cur.len) { tileable = 0; break; }
+        if (!status) { break; }
+        col = next;
+    }
+
+    if (!tileable)
+    {
+        fprintf(stdout, none);
+        goto end;
+    }
+    if (!seekable)
+    {
+        ctx->error = TILING_NO_SEEK;
+        goto end;
+    }
+
+    // Rueckwaerts: Profil am Anfang jedes Segments festlegen
+    boundary = (uint32_t *) malloc((amountCp + 1) * sizeof(uint32_t));
+    outs = (uint32_t *) malloc(STREAM_SEGMENT * sizeof(uint32_t));
+    cols = (column_t *) malloc((STREAM_SEGMENT + 1) * sizeof(column_t));
+    sets = (profiles_t *) calloc(STREAM_SEGMENT + 1, sizeof(profiles_t));
+    if (!boundary || !outs || !cols || !sets) { goto mem; }
+    boundary[amountCp] = 0;
+
+    for (size_t s = amountCp; s-- > 0; )
+    {
+        unsigned int amount;
+        int hasNext;
+        if (replaySegment(&r, &checkpoints[s], &checkpoints[s].in, cols, sets, &amount, &hasNext)) { goto end; }
+
+        uint32_t target = boundary[s+1];
+        for (unsigned int k = amount; k-- > 0; )
+        {
+            column_t * after = (k+1 < amount || hasNext) ? &cols[k+1] : NULL;
+            if (!predecessor(&cols[k], after, &sets[k], target, &target))
+            {
+                ctx->error = TILING_CHANGED;
+                goto end;
+            }
+        }
+        boundary[s] = target;
+    }
+
+    // Vorwaerts: Dominos ausgeben
+    for (size_t s = 0; s < amountCp; s++)
+    {
+        profiles_t start = { &boundary[s], 1, 1 };
+        unsigned int amount;
+        int hasNext;
+        if (replaySegment(&r, &checkpoints[s], &start, cols, sets, &amount, &hasNext)) { goto end; }
+
+        // Profile rueckwaerts festlegen, dann in Leserichtung drucken
+        uint32_t target = boundary[s+1];
+        for (unsigned int k = amount; k-- > 0; )
+        {
+            column_t * after = (k+1 < amount || hasNext) ? &cols[k+1] : NULL;
+            outs[k] = after ? shiftFrame(target, after->base, cols[k].base) : 0;
+            if (!predecessor(&cols[k], after, &sets[k], target, &target))
+            {
+                ctx->error = TILING_CHANGED;
+                goto end;
+            }
+            sets[k].p[0] = target;
+        }
+        for (unsigned int k = 0; k < amount; k++)
+        {
+            printColumn(&cols[k], sets[k].p[0], outs[k]);
+        }
+    }
+    goto end;
+
+mem:
+    ctx->error = TILING_EXCEED_MEM;
+end:
+    for (size_t s = 0; s < amountCp; s++) { free(checkpoints[s].in.p); }
+    if (sets)
+    {
+        for (unsigned int k = 0; k <= STREAM_SEGMENT; k++) { free(sets[k].p); }
+    }
+    free(sets);
+    free(cols);
+    free(outs);
+    free(boundary);
+    free(checkpoints);
+    free(cur.p);
+    free(nxt.p);
+    for (int w = 0; w < 3; w++) { free(r.work[w].p); }
+    return;
+}
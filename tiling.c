@@ -0,0 +1,938 @@
+/* libtiling: Kontext, Laden, Loesen, Ausgabe
+ *
+ * Die Pipeline ist Einlesen -> sort() -> linkTiles() -> findCoverage(),
+ * nach sort() waehlt planner.c den Loeser, falls keiner festgelegt ist.
+ * Alle Puffer haengen am Kontext und wachsen nur, so dass weitere Instanzen
+ * im selben Kontext ohne neue Allokationen auskommen, solange sie nicht
+ * groesser sind.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "loesung.h"
+
+const char none[]       = "None\n";
+
+static const char * const messages[TILING_ERRORS] = {
+    [TILING_OK]          = "",
+    [TILING_WRONG_CHAR]  = "'%c' is an unallowed character!\n",
+    [TILING_EXCEED_MAX]  = "At least 1 coordinate is >2^32!\n",
+    [TILING_WRONG_COOR]  = "Line %zu does not contain exact 2 arguments!\n",
+    [TILING_DOUBLE_LINE] = "At least 2 lines containing the same tile!\n",
+    [TILING_EXCEED_MEM]  = "Not enough memory available!\n",
+    [TILING_UNSORTED]    = "Line %zu: input for --stream is not sorted by x!\n",
+    [TILING_TOO_WIDE]    = "Line %zu: column is wider than 32 tiles!\n",
+    [TILING_NO_SEEK]     = "--stream needs a seekable input to print the tiling!\n",
+    [TILING_CHANGED]     = "Input changed while reading it again!\n",
+    [TILING_TEMP_FILE]   = "Cannot create temporary file in '%s'!\n",
+    [TILING_IO]          = "Input/output error: %s!\n",
+    [TILING_NO_TILE]     = "Line %zu: tile does not exist!\n",
+    [TILING_SOCKET]      = "Cannot listen on socket '%s'!\n",
+    [TILING_NO_CODEC]    = "Input is %s-compressed, but this build cannot decompress it!\n",
+    [TILING_CORRUPT]     = "Compressed input is corrupt or truncated!\n",
+    [TILING_WEIGHT]      = "Weight file line %zu is not \"x1 y1;x2 y2 cost\" for a domino!\n",
+    [TILING_WEIGHT_FILE] = "Cannot read weight file '%s'!\n",
+    [TILING_NO_BUDGET]   = "Memory budget is too small for about %zu tiles!\n",
+};
+
+tiling_t * tilingCreate(void)
+{
+    tiling_t * ctx = (tiling_t *) calloc(1, sizeof(tiling_t));
+    if (!ctx) { return NULL; }
+    ctx->mapFd = -1;
+    return ctx;
+}
+
+/* Vorige Instanz verwerfen, Puffer behalten
+ */
+static void resetInstance(tiling_t * ctx)
+{
+    if (ctx->mapFd >= 0) { releaseExternal(ctx); }
+    ctx->allTiles.amount = 0;
+    ctx->sorted = 0;
+    ctx->tileable = 0;
+    ctx->cursor = 0;
+    ctx->amountComponents = 0;
+    ctx->amountShapes = 0;
+    ctx->ringSlots = 0;
+    ctx->ringBlock = 0;
+    ctx->error = TILING_OK;
+}
+
+void tilingFree(tiling_t * ctx)
+{
+    if (!ctx) { return; }
+    if (ctx->mapFd >= 0)
+    {
+        releaseExternal(ctx);
+    } else {
+        memFree(ctx, ctx->allTiles.tiles);
+    }
+    memFree(ctx, ctx->holder);
+    memFree(ctx, ctx->tree);
+    memFree(ctx, ctx->path);
+    memFree(ctx, ctx->tinyMemo);
+    memFree(ctx, ctx->layoutTiles);
+    memFree(ctx, ctx->layoutOrder);
+    memFree(ctx, ctx->weights);
+    memFree(ctx, ctx->compRank);
+    memFree(ctx, ctx->compMember);
+    memFree(ctx, ctx->comps);
+    probeFree(ctx->probe);
+    free(ctx);
+    return;
+}
+
+static tile_t * appendTile(tiling_t * ctx, point_t p)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    if (allTiles->amount == ctx->capTiles)
+    {
+        size_t cap = ctx->capTiles ? ctx->capTiles * 2 : 64;
+        tile_t * temp = (tile_t *) memRealloc(ctx, allTiles->tiles, cap * sizeof(tile_t));
+        if (!temp)
+        {
+            ctx->error = TILING_EXCEED_MEM;
+            return NULL;
+        }
+        allTiles->tiles = temp;
+        ctx->capTiles = cap;
+    }
+
+    tile_t * tile = &allTiles->tiles[allTiles->amount++];
+    tile->p = p;
+    tile->edge = NULL;
+    tile->parent = NULL;
+    tile->north = NULL;
+    tile->south = NULL;
+    tile->west = NULL;
+    tile->east = NULL;
+    return tile;
+}
+
+int tilingLoad(tiling_t * ctx, FILE * in)
+{
+    resetInstance(ctx);
+
+    input_t input;
+    input.in = in;
+    input.line = 0;
+    input.offset = 0;
+
+    point_t p;
+    int status;
+    while ( (status = readLine(ctx, &input, &p)) > 0 )
+    {
+        if (!appendTile(ctx, p)) { return -1; }
+    }
+    return status;
+}
+
+int tilingLoadPoints(tiling_t * ctx, const point_t * points, size_t amount)
+{
+    resetInstance(ctx);
+    for (size_t i = 0; i < amount; i++)
+    {
+        if (!appendTile(ctx, points[i])) { return -1; }
+    }
+    return 0;
+}
+
+size_t tilingAmount(const tiling_t * ctx)
+{
+    return ctx->allTiles.amount;
+}
+
+int sortTiles(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    if (ctx->sorted || !allTiles->amount) { return 0; }
+    if (ctx->capHolder < allTiles->amount)
+    {
+        point_t * temp = (point_t *) memRealloc(ctx, ctx->holder, allTiles->amount * sizeof(point_t));
+        if (!temp)
+        {
+            ctx->error = TILING_EXCEED_MEM;
+            return -1;
+        }
+        ctx->holder = temp;
+        ctx->capHolder = allTiles->amount;
+    }
+    sort(ctx, 0, allTiles->amount-1);
+    if (ctx->error) { return -1; }
+    ctx->sorted = 1;
+    return 0;
+}
+
+/* Suchbaum und Pfad gleich in voller Groesse (mit Budget), damit ein zu
+ * kleines Budget vor linkTiles() auffaellt
+ */
+static int reserveSearch(tiling_t * ctx)
+{
+    size_t length = ctx->allTiles.amount + 1;
+    if (length < 8) { length = 8; }
+    if (ctx->capTree < length)
+    {
+        tile_t ** tree = (tile_t **) memRealloc(ctx, ctx->tree, length * sizeof(tile_t*));
+        if (!tree) { goto mem; }
+        ctx->tree = tree;
+        ctx->capTree = length;
+    }
+    if (ctx->capPath < length)
+    {
+        tile_t ** path = (tile_t **) memRealloc(ctx, ctx->path, length * sizeof(tile_t*));
+        if (!path) { goto mem; }
+        ctx->path = path;
+        ctx->capPath = length;
+    }
+    return 0;
+
+mem:
+    ctx->error = TILING_EXCEED_MEM;
+    return -1;
+}
+
+int tilingSolve(tiling_t * ctx)
+{
+    if (ctx->error) { return -1; }
+    allTiles_t * allTiles = &ctx->allTiles;
+    ctx->tileable = 0;
+    ctx->cursor = 0;
+
+    plan_t * plan = &ctx->plan;
+    memset(plan, 0, sizeof(*plan));
+    plan->amount = allTiles->amount;
+    tilingEngine_t engine = ctx->engine;
+
+    /* leere Eingabe: nichts zu tun, der Planer haette den Bitboard-Loeser
+     * gewaehlt
+     */
+    if (allTiles->amount == 0)
+    {
+        plan->engine = engine == TILING_ENGINE_AUTO ? TILING_ENGINE_TINY : engine;
+        ctx->costTotal = 0;
+        ctx->costPaths = 0;
+        ctx->costVisited = 0;
+        ctx->tileable = 1;
+        return 0;
+    }
+
+    /* kleine Instanzen (Bounding Box bis 8x8) loest der Bitboard-Loeser
+     */
+    if ((engine == TILING_ENGINE_AUTO || engine == TILING_ENGINE_TINY) && tinyFits(ctx))
+    {
+        tilingPhase(ctx, PHASE_MATCH);
+        plan->engine = TILING_ENGINE_TINY;
+        int result = tinySolve(ctx);
+        if (result >= 0) { ctx->tileable = !result; }
+        return result;
+    }
+    if (engine == TILING_ENGINE_TINY) { engine = TILING_ENGINE_GENERAL; }
+
+    /* Sort input and build structure
+     *
+     * Fehler 2 Gleiche Zeilen
+     */
+    tilingPhase(ctx, PHASE_SORT);
+    if (sortTiles(ctx)) { return -1; }
+    if (ctx->mem.budget && reserveSearch(ctx)) { return -1; }
+    tilingEngine_t planned = planSorted(ctx);
+    if (engine == TILING_ENGINE_AUTO) { engine = planned; }
+    plan->engine = engine;
+    if (engine == TILING_ENGINE_PARITY) { return 1; }
+
+    /* Cache: ein Treffer ueberspringt Verbinden und Augmentieren; der
+     * Schluessel kennt keine Kosten, minimale Kosten gehen am Cache vorbei
+     */
+    tilingPhase(ctx, PHASE_LINK);
+    int cache = ctx->cacheDir && engine != TILING_ENGINE_MINCOST;
+    if (cache)
+    {
+        int cached = cacheLookup(ctx);
+        if (cached >= 0)
+        {
+            ctx->tileable = !cached;
+            return cached;
+        }
+    }
+    // die parallele Startzuordnung ersetzt die gierige, also nur verbinden
+    if (engine == TILING_ENGINE_INIT)
+    {
+        linkNeighbours(allTiles);
+    } else {
+        linkTiles(allTiles);
+    }
+    if (engine == TILING_ENGINE_AUTO) { plan->engine = engine = planLinked(ctx); }
+    if (ctx->layout != TILING_LAYOUT_SORTED && engine != TILING_ENGINE_SHAPES && engine != TILING_ENGINE_MINCOST && planLayout(ctx) && layoutTiles(ctx)) { return -1; }
+    int result = -1;
+    tilingPhase(ctx, PHASE_MATCH);
+    if (engine == TILING_ENGINE_INIT && initMatching(ctx)) { goto end; }
+
+    /* Check for augmented paths
+     */
+    result = engine == TILING_ENGINE_SHAPES ? shapeSolve(ctx)
+           : engine == TILING_ENGINE_MINCOST ? mincostSolve(ctx) : findCoverage(ctx);    // returns 1 if there are unconnectable knotes
+end:
+    layoutRestore(ctx);
+    if (ctx->error) { return -1; }
+    ctx->tileable = !result;
+    if (cache) { cacheStore(ctx, result); }
+    return result;
+}
+
+void tilingSetEngine(tiling_t * ctx, tilingEngine_t engine, unsigned int threads)
+{
+    ctx->engine = engine < TILING_ENGINES && engine != TILING_ENGINE_PARITY ? engine : TILING_ENGINE_AUTO;
+    ctx->threads = threads;
+}
+
+tilingEngine_t tilingEngine(const tiling_t * ctx)
+{
+    return ctx->plan.engine;
+}
+
+void tilingSetLayout(tiling_t * ctx, tilingLayout_t layout)
+{
+    ctx->layout = layout;
+}
+
+void tilingSetInitMatch(tiling_t * ctx, int on, unsigned int threads)
+{
+    tilingSetEngine(ctx, on ? TILING_ENGINE_INIT : TILING_ENGINE_AUTO, threads);
+}
+
+void tilingSetShapes(tiling_t * ctx, int on)
+{
+    ctx->shapesOff = !on;
+    if (on || ctx->engine == TILING_ENGINE_SHAPES) { ctx->engine = on ? TILING_ENGINE_SHAPES : TILING_ENGINE_AUTO; }
+}
+
+void tilingSetCache(tiling_t * ctx, const char * dir, int verify)
+{
+    ctx->cacheDir = dir;
+    ctx->cacheVerify = verify;
+}
+
+void tilingRewind(tiling_t * ctx)
+{
+    ctx->cursor = 0;
+}
+
+int tilingNext(tiling_t * ctx, point_t * a, point_t * b)
+{
+    if (!ctx->tileable) { return 0; }
+    while (ctx->cursor < ctx->allTiles.amount)
+    {
+        tile_t * current = &ctx->allTiles.tiles[ctx->cursor++];
+        // jedes Domino einmal, bei der kleineren Kachel (das Feld ist sortiert)
+        if (current < current->edge)
+        {
+            *a = current->p;
+            *b = current->edge->p;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+tilingErr_t tilingError(const tiling_t * ctx)
+{
+    return ctx->error;
+}
+
+void tilingClearError(tiling_t * ctx)
+{
+    ctx->error = TILING_OK;
+}
+
+void printError(FILE * out, tilingErr_t error, union errData_u errData)
+{
+    if (error <= TILING_OK || error >= TILING_ERRORS) { return; }
+    const char * msg = messages[error];
+    switch (error)
+    {
+        case TILING_WRONG_CHAR: fprintf(out, msg, errData.c); break;
+        case TILING_TEMP_FILE:
+        case TILING_IO:
+        case TILING_SOCKET:
+        case TILING_WEIGHT_FILE:
+        case TILING_NO_CODEC:   fprintf(out, msg, errData.s); break;
+        default:                fprintf(out, msg, errData.i); break;
+    }
+    return;
+}
+
+void tilingPrintError(const tiling_t * ctx, FILE * out)
+{
+    printError(out, ctx->error, ctx->errData);
+    return;
+}
+
+void printResult(tiling_t * ctx, FILE * out)
+{
+    point_t a;
+    point_t b;
+    tilingRewind(ctx);
+    while (tilingNext(ctx, &a, &b))
+    {
+        fprintf(out, "%u %u;%u %u\n", a.x, a.y, b.x, b.y);
+    }
+    return;
+}
+
+void tilingPrint(tiling_t * ctx, int result, FILE * out)
+{
+    tilingPhase(ctx, PHASE_PRINT);
+    if (result)
+    {
+        fprintf(out, none);
+    } else {
+        printResult(ctx, out);
+    }
+    return;
+}
+
+void tilingStats(const tiling_t * ctx, tilingStats_t * stats)
+{
+    stats->initGreedyFree = ctx->initGreedyFree;
+    stats->initFree = ctx->initFree;
+    stats->initRounds = ctx->initRounds;
+    stats->initThreads = ctx->initThreads;
+    stats->components = ctx->amountComponents;
+    stats->shapes = ctx->amountShapes;
+    stats->costPaths = ctx->costPaths;
+    stats->costVisited = ctx->costVisited;
+    return;
+}
+
+int appendBytes(char ** out, size_t * len, size_t * cap, const char * bytes, size_t amount)
+{
+    if (*len + amount > *cap)
+    {
+        size_t size = *cap ? *cap : 256;
+        while (size < *len + amount) { size *= 2; }
+        char * temp = (char *) realloc(*out, size);
+        if (!temp) { return -1; }
+        *out = temp;
+        *cap = size;
+    }
+    memcpy(*out + *len, bytes, amount);
+    *len += amount;
+    return 0;
+}
+
+static char * appendUnsigned(char * dst, unsigned int v)
+{
+    char digits[10];
+    unsigned int n = 0;
+    do
+    {
+        digits[n++] = (char) ('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) { *dst++ = digits[--n]; }
+    return dst;
+}
+
+int formatDomino(point_t a, point_t b, char ** out, size_t * len, size_t * cap)
+{
+    char line[4 * 10 + 4];
+    char * dst = line;
+    dst = appendUnsigned(dst, a.x);
+    *dst++ = ' ';
+    dst = appendUnsigned(dst, a.y);
+    *dst++ = ';';
+    dst = appendUnsigned(dst, b.x);
+    *dst++ = ' ';
+    dst = appendUnsigned(dst, b.y);
+    *dst++ = '\n';
+    return appendBytes(out, len, cap, line, (size_t) (dst - line));
+}
+
+int formatResult(tiling_t * ctx, int result, char ** out, size_t * len, size_t * cap)
+{
+    if (result) { return appendBytes(out, len, cap, none, strlen(none)); }
+
+    point_t a;
+    point_t b;
+    tilingRewind(ctx);
+    while (tilingNext(ctx, &a, &b))
+    {
+        if (formatDomino(a, b, out, len, cap)) { return -1; }
+    }
+    return 0;
+}
+
+void flipPath(tile_t** path)
+{
+    for (size_t i =  0; path[i]; i = i + 2)
+    {
+        path[i]->edge = path[i+1];
+        path[i+1]->edge = path[i];
+    }
+    return;
+}
+
+void resetTree(tile_t** tree)
+{
+    for (size_t i = 0; tree[i]; i++)
+    {
+        tree[i]->parent = NULL;
+    }
+    return;
+}
+
+void addNeighbours(tile_t* middle, tile_t** tree, size_t* index)
+{
+    if (middle->north)
+    {
+        if (!middle->north->parent)
+        {
+            tree[*index] = middle->north;
+            tree[*index]->depth = middle->depth +1;
+            tree[(*index)++]->parent = middle;
+        }
+    }
+    if (middle->west)
+    {
+        if (!middle->west->parent)
+        {
+            tree[*index] = middle->west;
+            tree[*index]->depth = middle->depth +1;
+            tree[(*index)++]->parent = middle;
+        }
+    }
+    if (middle->south)
+    {
+        if (!middle->south->parent)
+        {
+            tree[*index] = middle->south;
+            tree[*index]->depth = middle->depth +1;
+            tree[(*index)++]->parent = middle;
+        }
+    }
+    if (middle->east)
+    {
+        if (!middle->east->parent)
+        {
+            tree[*index] = middle->east;
+            tree[*index]->depth = middle->depth +1;
+            tree[(*index)++]->parent = middle;
+        }
+    }
+    return;
+}
+
+int findAugmentedPath(tiling_t * ctx, size_t amount, tile_t* begin)
+{   
+    // -1 Error
+    // 0 Found Path
+    // 1 No Path
+    size_t length = ctx->capTree;
+    tile_t ** tree = ctx->tree;
+    if (length < 8)
+    {
+        length = 8;
+        tree = (tile_t**) memRealloc(ctx, ctx->tree, length * sizeof(tile_t*));
+        if (!tree) { ctx->error = TILING_EXCEED_MEM; return -1; }
+        ctx->tree = tree;
+        ctx->capTree = length;
+    }
+
+    size_t i = 0;
+    size_t j = 1;
+    int error = 1;
+    tree[0] = begin;
+    tree[0]->depth = 0;
+    addNeighbours(tree[0], tree, &j);
+    i++;
+    do
+    {
+        if ( i >= j ) { error = 1; break; }
+        if ( j >= length -4 )
+        {
+            size_t grow = length *2;
+            if (grow > amount +1) { grow = amount +1; }
+            if (grow > length)
+            {
+                tile_t ** temp1 = memRealloc(ctx, tree, grow * sizeof(tile_t*));
+                if (!temp1) { error = -1; break; }
+                ctx->tree = tree = temp1;
+                ctx->capTree = length = grow;
+            }
+        }
+        if (!tree[i]->edge)
+        {
+            error = 0;
+            break;
+        } else {
+            if ( tree[i]->parent != tree[i]->edge )
+            {
+                tree[j] = tree[i]->edge;
+                tree[j]->depth = tree[i]->depth +1;
+                tree[j++]->parent = tree[i];
+                i++;
+                continue;
+            }
+        }
+        addNeighbours(tree[i], tree, &j);
+        i++;
+    } while ( i < amount );
+    
+    tile_t** path = ctx->path;
+    if (!error && ctx->capPath < tree[i]->depth+2)
+    {
+        path = (tile_t**) memRealloc(ctx, ctx->path, (tree[i]->depth+2) * sizeof(tile_t*));
+        if (path)
+        {
+            ctx->path = path;
+            ctx->capPath = tree[i]->depth+2;
+        }
+    }
+    if (!error)
+    {
+        if ( !path )
+        { 
+            error = -1;
+            ctx->error = TILING_EXCEED_MEM;
+            tree[j] = NULL;
+        } else{
+    
+            path[0] = tree[i];
+            size_t copyindex = 0;
+            do
+            {
+                path[copyindex+1] = path[copyindex]->parent;
+            } while (path[++copyindex]->parent);
+            path[copyindex+1] = NULL;
+            tree[j] = NULL;
+        }
+    } else {
+        if (error == -1) { ctx->error = TILING_EXCEED_MEM; }
+        tree[j] = NULL;     // damit resetTree auch nach erfolgloser Suche geht
+    }
+    return error;
+}
+
+int findCoverage(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    int result = 0;
+    for (size_t i = 0; i < allTiles->amount; i++)
+    {
+        if(allTiles->tiles[i].edge) { continue; }
+
+        // Baum und Pfad gehoeren dem Kontext und bleiben zwischen den Suchen erhalten
+        result = findAugmentedPath(ctx, allTiles->amount, &allTiles->tiles[i]);
+        if( !result )
+        {
+            flipPath(ctx->path); 
+        }
+        resetTree(ctx->tree);
+
+        if (result) { break; }    // ein unverbindbarer Knoten reicht fuer "None"
+    }
+
+    return result;
+}
+
+tile_t* search(allTiles_t * allTiles, size_t index, unsigned int findX, unsigned int findY)
+{
+    while (index < allTiles->amount)
+    {
+        if (allTiles->tiles[index].p.x < findX) { index++; continue; }
+        if (allTiles->tiles[index].p.x == findX)
+        {
+            if (allTiles->tiles[index].p.y < findY) { index++; continue; }
+            if (allTiles->tiles[index].p.y == findY)
+            {
+                return &allTiles->tiles[index];
+            }
+        }
+        break;
+    }
+
+    return NULL;
+}
+
+/* Nord liegt direkt dahinter, Ost eine Spalte weiter: die Suche nach Ost
+ * beginnt bei k, das nur waechst, weil (cx+1, cy) mit i steigt. So bleibt
+ * das Verbinden linear statt Spaltenhoehe mal Kacheln.
+ *
+ * greedy ist an beiden Aufrufstellen konstant, der Compiler erzeugt also
+ * zwei Fassungen ohne Abfrage in der Schleife.
+ */
+static inline void linkAll(allTiles_t* allTiles, int greedy)
+{
+    size_t i = 0;
+    size_t k = 0;
+    while ( i < allTiles->amount-1 )
+    {
+        tile_t * current = &allTiles->tiles[i];
+        unsigned int cx = current->p.x;
+        unsigned int cy = current->p.y;
+
+        tile_t * north = search(allTiles, i, cx, cy + 1);
+        if (north)
+        {
+            current->north = north;
+            north->south = current;
+            if (greedy && !current->edge && !north->edge)
+            {
+                current->edge = north;
+                north->edge = current;
+            }
+        }
+        if (cx == UINT_MAX) { i++; continue; }
+        if (k < i) { k = i; }
+        while (k < allTiles->amount && (allTiles->tiles[k].p.x < cx + 1
+               || (allTiles->tiles[k].p.x == cx + 1 && allTiles->tiles[k].p.y < cy))) { k++; }
+        tile_t * east = search(allTiles, k, cx + 1, cy);
+        if (east)
+        {
+            current->east = east;
+            east->west = current;
+            if (greedy && !current->edge && !east->edge)
+            {
+                current->edge = east;
+                east->edge = current;
+            }
+        }
+        i++;
+    }
+    return; 
+}
+
+void linkTiles(allTiles_t* allTiles)
+{
+    linkAll(allTiles, 1);
+}
+
+void linkNeighbours(allTiles_t* allTiles)
+{
+    linkAll(allTiles, 0);
+}
+
+/* Mergesort, holder ist der Puffer des Kontexts (mindestens amount Punkte)
+ */
+void sort(tiling_t * ctx, size_t begin, size_t end)
+{
+    if ( (end - begin) == 0) { return; }
+
+    size_t mid = begin + (end - begin)/2;
+    sort(ctx, begin, mid);
+    if (ctx->error) { return; }
+    sort(ctx, mid+1, end);
+    if (ctx->error) { return; }
+
+    tile_t * tiles = ctx->allTiles.tiles;
+    point_t * holder = ctx->holder;
+    size_t i = begin;
+    size_t j = mid +1;
+    size_t k = 0;
+
+    while (i <= mid && j <= end)
+    {
+        if (tiles[i].p.x < tiles[j].p.x)
+        {
+            holder[k].x = tiles[i].p.x;
+            holder[k].y = tiles[i].p.y;
+            k++;
+            i++;
+            continue;
+        }
+        if (tiles[i].p.x > tiles[j].p.x)
+        {
+            holder[k].x = tiles[j].p.x;
+            holder[k].y = tiles[j].p.y;
+            k++;
+            j++;
+            continue;
+        }
+        if (tiles[i].p.y < tiles[j].p.y)
+        {
+            holder[k].x = tiles[i].p.x;
+            holder[k].y = tiles[i].p.y;
+            k++;
+            i++;
+            continue;
+        } else 
+        if (tiles[i].p.y > tiles[j].p.y)
+        {
+            holder[k].x = tiles[j].p.x;
+            holder[k].y = tiles[j].p.y;
+            k++;
+            j++;
+            continue;
+        }
+        ctx->error = TILING_DOUBLE_LINE;
+        return;
+    }
+    while ( i <= mid )
+    {
+        holder[k].x = tiles[i].p.x;
+        holder[k].y = tiles[i].p.y;
+        k++;
+        i++;
+    }
+    
+    i = begin;
+    k = 0;
+    while ( i < j )
+    {
+        tiles[i].p.x = holder[k].x;
+        tiles[i].p.y = holder[k].y;
+        i++;
+        k++;
+    }
+    return;
+}
+
+static int nextChar(input_t * input)
+{
+    int c = getc(input->in);
+    if (c != EOF) { input->offset++; }
+    return c;
+}
+
+/* Liest eine Zeile "x y"
+ *
+ * 1: Kachel gelesen, 0: Ende der Eingabe, -1: Fehler (im Kontext)
+ */
+int readLine(tiling_t * ctx, input_t * input, point_t * p)
+{
+    int c = nextChar(input);
+    if (c == EOF) { return 0; }
+    input->line++;
+
+    unsigned long a = 0;
+    unsigned long b = 0;
+
+    // ' '*
+    while ( c == ' ' || c == '\t' ) { c = nextChar(input); }
+
+    if (c == '\n' || c == '\r')
+    {
+        ctx->error = TILING_WRONG_COOR;
+        ctx->errData.i = input->line;
+        return -1;
+    }
+    // 0-9+
+    if (c >= '0' && c <= '9')
+    {
+        do
+        {
+            a = a*10 + (unsigned long) c -48;
+            if ( a >= 4294967296 )
+            {
+                ctx->error = TILING_EXCEED_MAX;
+                return -1;
+            }
+        } while ( (c = nextChar(input)) >= '0' && c <= '9');
+    }
+    else
+    {
+        ctx->error = TILING_WRONG_CHAR;
+        ctx->errData.c = (char) c;
+        return -1;
+    }
+
+    // ' '+
+    if (c == '\n' || c == '\r' || c == EOF)
+    {
+        ctx->error = TILING_WRONG_COOR;
+        ctx->errData.i = input->line;
+        return -1;
+    }
+    if ( c == ' ' || c == '\t')
+    {
+        do { c = nextChar(input); } while( c == ' ' || c == '\t' );
+    }
+    else
+    {
+        ctx->error = TILING_WRONG_CHAR;
+        ctx->errData.c = (char) c;
+        return -1;
+    }
+
+    if (c == '\n' || c == '\r' || c == EOF)
+    {
+        ctx->error = TILING_WRONG_COOR;
+        ctx->errData.i = input->line;
+        return -1;
+    }
+    // 0-9+
+    if (c >= '0' && c <= '9')
+    {
+        do
+        {
+            b = b*10 + (unsigned long) c -48;
+            if ( b >= 4294967296 )
+            {
+                ctx->error = TILING_EXCEED_MAX;
+                return -1;
+            }
+        } while ( (c = nextChar(input)) >= '0' && c <= '9');
+    }
+    else
+    {
+        ctx->error = TILING_WRONG_CHAR;
+        ctx->errData.c = (char) c;
+        return -1;
+    }
+
+    // ' '*
+    while (c == ' ' || c == '\t') { c = nextChar(input); }
+
+    // "\r\n" zaehlt als ein Zeilenende
+    if (c == '\r')
+    {
+        c = nextChar(input);
+        if (c != '\n' && c != EOF)
+        {
+            ungetc(c, input->in);
+            input->offset--;
+        }
+        c = '\n';
+    }
+    if ( c != '\n' && c != EOF)
+    {
+        ctx->error = TILING_WRONG_COOR;
+        ctx->errData.i = input->line;
+        return -1;
+    }
+
+    p->x = (unsigned int) a;
+    p->y = (unsigned int) b;
+    return 1;
+}
+
+/* Leerzeile als Trenner (--edit, --batch)
+ *
+ * 1: Leerzeile gelesen, 0: es folgt eine Zeile mit Inhalt, EOF: Ende der Eingabe
+ */
+int readBlank(input_t * input)
+{
+    int c = getc(input->in);
+    if (c == EOF) { return EOF; }
+    if (c != '\n' && c != '\r')
+    {
+        ungetc(c, input->in);
+        return 0;
+    }
+    input->offset++;
+    if (c == '\r')
+    {
+        int d = getc(input->in);
+        if (d == '\n')
+        {
+            input->offset++;
+        } else if (d != EOF) {
+            ungetc(d, input->in);
+        }
+    }
+    input->line++;
+    return 1;
+}
@@ -0,0 +1,255 @@
+#ifndef TILING_H
+#define TILING_H
+
+/* libtiling
+ *
+ * Domino-Parkettierung als Bibliothek. Ein Kontext besitzt alle Puffer
+ * (Kacheln, Sortierpuffer, Suchbaum) und behaelt sie ueber mehrere
+ * Instanzen, so dass wiederholtes Laden und Loesen nur noch waechst, aber
+ * nicht neu anlegt. Fehler werden als Code im Kontext abgelegt; es gibt
+ * keinen globalen Zustand, verschiedene Kontexte koennen in verschiedenen
+ * Threads laufen.
+ *
+ * Ablauf:
+ *     tiling_t * ctx = tilingCreate();
+ *     tilingLoad(ctx, stdin);            // oder tilingLoadPoints
+ *     if (tilingSolve(ctx) == 0)         // 0 Parkettierung, 1 keine, -1 Fehler
+ *         while (tilingNext(ctx, &a, &b)) ...
+ *     tilingFree(ctx);
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+
+typedef struct point_s{
+    unsigned int x;
+    unsigned int y;
+} point_t;
+
+typedef enum tilingErr_e{
+    TILING_OK = 0,
+    TILING_WRONG_CHAR,      // Zeichen in errData.c
+    TILING_EXCEED_MAX,
+    TILING_WRONG_COOR,      // Zeile in errData.i
+    TILING_DOUBLE_LINE,
+    TILING_EXCEED_MEM,
+    TILING_UNSORTED,        // --stream: Zeile in errData.i
+    TILING_TOO_WIDE,        // --stream: Zeile in errData.i
+    TILING_NO_SEEK,
+    TILING_CHANGED,
+    TILING_TEMP_FILE,       // Verzeichnis in errData.s
+    TILING_IO,              // Ursache (strerror()) in errData.s
+    TILING_NO_TILE,         // --edit: Zeile in errData.i
+    TILING_SOCKET,          // --serve: Pfad in errData.s
+    TILING_NO_CODEC,        // Format in errData.s
+    TILING_CORRUPT,
+    TILING_WEIGHT,          // Gewichtsdatei: Zeile in errData.i
+    TILING_WEIGHT_FILE,     // Gewichtsdatei: Pfad in errData.s
+    TILING_NO_BUDGET,       // --memory-budget: geschaetzte Kacheln in errData.i
+    TILING_ERRORS
+} tilingErr_t;
+
+/* Loeser, TILING_ENGINE_AUTO waehlt nach billigen Kennzahlen (planner.c)
+ */
+typedef enum tilingEngine_e{
+    TILING_ENGINE_AUTO = 0,
+    TILING_ENGINE_GENERAL,      // Kachelfeld, linkTiles() und findCoverage()
+    TILING_ENGINE_TINY,         // Bitboard bis 8x8, sonst allgemein
+    TILING_ENGINE_SHAPES,       // gleiche Komponenten nur einmal loesen
+    TILING_ENGINE_INIT,         // parallele Startzuordnung, dann findCoverage()
+    TILING_ENGINE_PARITY,       // nur als Ergebnis: ungleiche Faerbung, "None"
+    TILING_ENGINE_MINCOST,      // Parkettierung minimaler Kosten (tilingSetCost())
+    TILING_ENGINES
+} tilingEngine_t;
+
+/* Reihenfolge der Kacheln waehrend der Suchen (layout.c), die Ausgabe
+ * bleibt immer sortiert
+ */
+typedef enum tilingLayout_e{
+    TILING_LAYOUT_SORTED = 0,   // nach x, dann y (sort())
+    TILING_LAYOUT_MORTON,
+    TILING_LAYOUT_HILBERT
+} tilingLayout_t;
+
+typedef struct tiling_s tiling_t;
+
+tiling_t * tilingCreate(void);
+void tilingFree(tiling_t * ctx);
+
+/* Laden ersetzt die vorige Instanz, die Puffer bleiben erhalten
+ *
+ * 0: geladen, -1: Fehler
+ */
+int tilingLoad(tiling_t * ctx, FILE * in);
+int tilingLoadPoints(tiling_t * ctx, const point_t * points, size_t amount);
+
+/* Text im Speicher bzw. ganze Datei in Stuecken auf threads Kernen
+ * (0 = alle) zerlegen, Fehler und Zeilennummern wie tilingLoad();
+ * tilingLoadParallel() entpackt gzip und zstd (je nach Build) selbst
+ */
+int tilingLoadBuffer(tiling_t * ctx, const char * text, size_t len, unsigned int threads);
+int tilingLoadParallel(tiling_t * ctx, FILE * in, unsigned int threads);
+size_t tilingAmount(const tiling_t * ctx);
+
+/* Vor dem Einlesen mit Budget (tilingSetMemoryBudget()): runSize auf das
+ * Budget kuerzen und entscheiden, ob die Eingabe extern gelesen werden muss
+ * (nur unkomprimierte Dateien, deren Groesse bekannt ist)
+ *
+ * 1: extern einlesen, 0: im Speicher (oder kein Budget),
+ * -1: passt auch extern nicht ins Budget (TILING_NO_BUDGET)
+ */
+int tilingPlanInput(tiling_t * ctx, FILE * in, size_t * runSize);
+
+/* Einlesen ueber sortierte Laeufe zu je runSize Kacheln in temporaeren
+ * Dateien (extsort.c); das Kachelfeld ist danach eine per mmap eingeblendete
+ * Datei und schon sortiert. stats berichtet Laeufe und Bytes auf stderr.
+ */
+void tilingLoadExternal(tiling_t * ctx, FILE * in, size_t runSize, int stats);
+
+/* Sortieren, Verbinden, Augmentieren
+ *
+ * 0: Parkettierung gefunden, 1: keine ("None"), -1: Fehler
+ */
+int tilingSolve(tiling_t * ctx);
+
+/* Dominos der Loesung in aufsteigender Reihenfolge der ersten Kachel
+ *
+ * 1: Domino in a und b, 0: keine weiteren
+ */
+int tilingNext(tiling_t * ctx, point_t * a, point_t * b);
+void tilingRewind(tiling_t * ctx);
+
+/* Ergebnis von tilingSolve() ausgeben: "None" oder je Domino "x y;x y"
+ */
+void tilingPrint(tiling_t * ctx, int result, FILE * out);
+
+/* Gegenprobe: der eingestellte Loeser (tilingSetEngine(), bei AUTO die Wahl
+ * des Planers, mit tilingSetLayout()) und die visited_by-Suche aus
+ * floesung.c auf denselben Kacheln, Urteil und Zuordnung je Loeser im
+ * Bericht (Index 0 der Loeser, 1 die Suche); danach liefert tilingNext()
+ * die Loesung des eingestellten Loesers
+ *
+ * 0: beide einig und gueltig, 1: Widerspruch, -1: Fehler
+ */
+typedef struct tilingCross_s{
+    int result[2];          // wie tilingSolve(): 0 Parkettierung, 1 keine
+    int valid[2];           // nur Nachbarn, symmetrisch, bei Parkettierung vollstaendig
+    double seconds[2];
+    tilingEngine_t engine;  // tatsaechlich gelaufener Loeser (wie tilingEngine())
+} tilingCross_t;
+
+int tilingCrossCheck(tiling_t * ctx, tilingCross_t * report);
+void tilingPrintCross(const tilingCross_t * report, FILE * out);
+
+/* Ergebnis-Cache im Verzeichnis dir (NULL = aus), verify prueft Treffer
+ *
+ * Ein Treffer setzt nur die Zuordnung, die Kacheln werden nicht verbunden.
+ */
+void tilingSetCache(tiling_t * ctx, const char * dir, int verify);
+
+/* Loeser festlegen (Voreinstellung TILING_ENGINE_AUTO), threads gilt fuer
+ * parallele Abschnitte (0 = alle Kerne)
+ */
+void tilingSetEngine(tiling_t * ctx, tilingEngine_t engine, unsigned int threads);
+tilingEngine_t tilingEngine(const tiling_t * ctx);      // zuletzt benutzter Loeser
+const char * tilingEngineName(tilingEngine_t engine);
+
+/* Loeser nach Namen ("auto", "general", ...), 0: gefunden, -1: unbekannt
+ */
+int tilingEngineByName(const char * name, tilingEngine_t * engine);
+
+/* Kacheln nach linkTiles() entlang einer raumfuellenden Kurve umordnen
+ *
+ * nicht mit TILING_ENGINE_SHAPES, das schon je Komponente arbeitet
+ */
+void tilingSetLayout(tiling_t * ctx, tilingLayout_t layout);
+
+/* Startzuordnung parallel auf threads Kernen (0 = alle) statt gierig
+ *
+ * wie tilingSetEngine() mit TILING_ENGINE_INIT, aus schaltet auf AUTO
+ */
+void tilingSetInitMatch(tiling_t * ctx, int on, unsigned int threads);
+
+/* Komponenten gleicher Form nur einmal loesen und die Zuordnung kopieren
+ *
+ * an wie tilingSetEngine() mit TILING_ENGINE_SHAPES; aus (0) schaltet
+ * SHAPES auf AUTO zurueck, und der Planer waehlt SHAPES dann auch nicht
+ */
+void tilingSetShapes(tiling_t * ctx, int on);
+
+/* Parkettierung minimaler Kosten (mincost.c)
+ *
+ * Jedes horizontale bzw. vertikale Domino kostet horizontal bzw. vertical
+ * (Voreinstellung 0), die Gewichtsdatei legt einzelne Dominos fest, je
+ * Zeile "x1 y1;x2 y2 kosten" wie in der Ausgabe. Kosten duerfen negativ
+ * sein, Dominos mit fehlenden Kacheln zaehlen nicht. Beides schaltet auf
+ * TILING_ENGINE_MINCOST; tilingCost() ist die Summe der letzten Loesung.
+ *
+ * tilingLoadWeights(): 0 geladen, -1 Fehler (TILING_WEIGHT, TILING_WEIGHT_FILE)
+ */
+void tilingSetCost(tiling_t * ctx, int horizontal, int vertical);
+int tilingLoadWeights(tiling_t * ctx, const char * path);
+long long tilingCost(const tiling_t * ctx);
+
+/* Obergrenze fuer den Heap des Kontexts in Bytes (0 = keine)
+ *
+ * Der Planer waehlt danach sparsamere Wege und reserviert die Suchpuffer
+ * gleich nach dem Sortieren, so dass ein zu kleines Budget vor dem Verbinden
+ * auffaellt und nicht erst mitten in der Suche.
+ */
+void tilingSetMemoryBudget(tiling_t * ctx, size_t bytes);
+size_t tilingMemoryPeak(const tiling_t * ctx);
+
+/* Kennzahlen der letzten Loesung, jeweils nur vom passenden Loeser gesetzt
+ */
+typedef struct tilingStats_s{
+    size_t initGreedyFree;      // TILING_ENGINE_INIT: freie Kacheln nach der gierigen Zuordnung
+    size_t initFree;            // und nach der parallelen Startzuordnung
+    unsigned int initRounds;
+    unsigned int initThreads;
+    size_t components;          // TILING_ENGINE_SHAPES
+    size_t shapes;
+    size_t costPaths;           // TILING_ENGINE_MINCOST: Suchen nach der gierigen Zuordnung
+    size_t costVisited;         // fertige Kacheln aller Suchen
+} tilingStats_t;
+
+void tilingStats(const tiling_t * ctx, tilingStats_t * stats);
+
+/* Berichte auf out: Kennzahlen und Wahl des Planers, Heap je Phase
+ */
+void tilingPrintPlan(const tiling_t * ctx, FILE * out);
+void tilingPrintMemory(const tiling_t * ctx, FILE * out);
+
+/* Zeit und Hardware-Zaehler je Phase (probe.c), vor dem Einlesen
+ * einschalten; tilingPrintCounters() schliesst die letzte Phase ab
+ *
+ * tilingSetCounters(): 0 an, -1 kein Speicher (TILING_EXCEED_MEM)
+ */
+int tilingSetCounters(tiling_t * ctx);
+void tilingPrintCounters(tiling_t * ctx, FILE * out, int json);
+
+/* Betriebsarten neben Laden und Loesen, Fehler im Kontext
+ *
+ * tilingCount()        Anzahl der Parkettierungen (mod p und ln) ueber die
+ *                      Kasteleyn-Determinante (count.c), nach tilingSolve()
+ * tilingStream()       spaltenweiser Loeser fuer nach x sortierte Baender
+ *                      bis 32 breit (stream.c)
+ * tilingEdit()         Bearbeitungsskript inkrementell loesen (incremental.c)
+ * tilingProgressive()  nach dem Laden Komponenten einzeln loesen und sofort
+ *                      ausgeben, Abschlusszeile "OK" oder "None" (progressive.c)
+ * tilingBatch()        viele Instanzen (Leerzeile = Ende) auf einem Pool von
+ *                      Threads, Ausgabe in Eingabereihenfolge (batch.c)
+ * tilingServe()        Dienst auf einem Unix-Domain-Socket (daemon.c)
+ */
+void tilingCount(tiling_t * ctx, int hasTiling, unsigned int threads);
+void tilingStream(tiling_t * ctx, FILE * in);
+void tilingEdit(tiling_t * ctx, FILE * in);
+void tilingProgressive(tiling_t * ctx, FILE * out, int sorted);
+void tilingBatch(tiling_t * ctx, FILE * in, unsigned int threads, int stats);
+void tilingServe(tiling_t * ctx, const char * path, unsigned int threads, int stats);
+
+tilingErr_t tilingError(const tiling_t * ctx);
+void tilingClearError(tiling_t * ctx);
+void tilingPrintError(const tiling_t * ctx, FILE * out);
+
+#endif
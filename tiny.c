@@ -0,0 +1,156 @@
+/* Bitboard-Loeser fuer kleine Instanzen
+ *
+ * Passt die Bounding Box in 8x8, wird die Region als uint64_t kodiert:
+ * Bit 8*(x-minX) + (y-minY). Aufsteigende Bits sind damit genau die
+ * Reihenfolge von sort().
+ *
+ * Die Tiefensuche belegt immer die kleinste freie Zelle i, senkrecht mit
+ * Bit i+1 oder waagerecht mit Bit i+8. Alle Bits ab i+8 sind dann noch
+ * unberuehrt, ein Zustand ist also schon durch (i, Bits i..i+7) bestimmt.
+ * Erfolglose Zustaende landen in einer Bitmenge von 64*256 Bits, die dem
+ * Kontext gehoert; geloescht werden danach nur die benutzten Worte.
+ *
+ * Das Ergebnis wird wie von sort(), linkTiles() und findCoverage() in das
+ * Kachelfeld geschrieben (sortiert, verbunden, zugeordnet), so dass
+ * tilingNext() und der Zaehlmodus unveraendert darauf arbeiten.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "loesung.h"
+
+#define TINY_SIDE 8
+#define TINY_BLACK 0xAA55AA55AA55AA55ull   // Bits mit (x+y) gerade
+
+struct tinyMemo_s{
+    uint64_t failed[64 * 256 / 64];
+    uint8_t touched[64 * 256 / 64];
+    unsigned int amountTouched;
+};
+
+static int cover(uint64_t mask, tinyMemo_t * memo, uint8_t * choice, unsigned int depth)
+{
+    if (!mask) { return 1; }
+
+    unsigned int i = (unsigned int) __builtin_ctzll(mask);
+    unsigned int state = i * 256 + (unsigned int) ((mask >> i) & 0xff);
+    if ((memo->failed[state >> 6] >> (state & 63)) & 1) { return 0; }
+
+    uint64_t low = (uint64_t) 1 << i;
+    if ((i & 7) != 7 && (mask & (low << 1)))
+    {
+        choice[depth] = 1;
+        if (cover(mask & ~(low | (low << 1)), memo, choice, depth + 1)) { return 1; }
+    }
+    if (i < 56 && (mask & (low << 8)))
+    {
+        choice[depth] = 8;
+        if (cover(mask & ~(low | (low << 8)), memo, choice, depth + 1)) { return 1; }
+    }
+    if (!memo->failed[state >> 6]) { memo->touched[memo->amountTouched++] = (uint8_t) (state >> 6); }
+    memo->failed[state >> 6] |= (uint64_t) 1 << (state & 63);
+    return 0;
+}
+
+int tinyFits(const tiling_t * ctx)
+{
+    const allTiles_t * allTiles = &ctx->allTiles;
+    if (ctx->sorted || !allTiles->amount || allTiles->amount > TINY_SIDE * TINY_SIDE) { return 0; }
+
+    unsigned int minX = allTiles->tiles[0].p.x, maxX = minX;
+    unsigned int minY = allTiles->tiles[0].p.y, maxY = minY;
+    for (size_t i = 1; i < allTiles->amount; i++)
+    {
+        point_t p = allTiles->tiles[i].p;
+        if (p.x < minX) { minX = p.x; }
+        if (p.x > maxX) { maxX = p.x; }
+        if (p.y < minY) { minY = p.y; }
+        if (p.y > maxY) { maxY = p.y; }
+    }
+    return maxX - minX < TINY_SIDE && maxY - minY < TINY_SIDE;
+}
+
+int tinySolve(tiling_t * ctx)
+{
+    allTiles_t * allTiles = &ctx->allTiles;
+    tile_t * tiles = allTiles->tiles;
+
+    unsigned int minX = tiles[0].p.x;
+    unsigned int minY = tiles[0].p.y;
+    for (size_t i = 1; i < allTiles->amount; i++)
+    {
+        if (tiles[i].p.x < minX) { minX = tiles[i].p.x; }
+        if (tiles[i].p.y < minY) { minY = tiles[i].p.y; }
+    }
+
+    uint64_t mask = 0;
+    for (size_t i = 0; i < allTiles->amount; i++)
+    {
+        uint64_t bit = (uint64_t) 1 << ((tiles[i].p.x - minX) * TINY_SIDE + (tiles[i].p.y - minY));
+        if (mask & bit)
+        {
+            ctx->error = TILING_DOUBLE_LINE;
+            return -1;
+        }
+        mask |= bit;
+    }
+
+    // Kachelfeld sortiert neu schreiben und verbinden (Sued und West liegen schon davor)
+    int8_t index[64];
+    size_t k = 0;
+    for (uint64_t rest = mask; rest; rest &= rest - 1)
+    {
+        unsigned int b = (unsigned int) __builtin_ctzll(rest);
+        index[b] = (int8_t) k;
+        tile_t * tile = &tiles[k++];
+        tile->p.x = minX + b / TINY_SIDE;
+        tile->p.y = minY + b % TINY_SIDE;
+        tile->parent = NULL;
+        tile->edge = NULL;
+        tile->north = NULL;
+        tile->east = NULL;
+        tile->south = NULL;
+        tile->west = NULL;
+        if ((b & 7) && ((mask >> (b - 1)) & 1))
+        {
+            tile->south = &tiles[index[b - 1]];
+            tile->south->north = tile;
+        }
+        if (b >= 8 && ((mask >> (b - 8)) & 1))
+        {
+            tile->west = &tiles[index[b - 8]];
+            tile->west->east = tile;
+        }
+    }
+    ctx->sorted = 1;
+
+    // Faerbung: gleich viele schwarze und weisse Zellen noetig
+    if (__builtin_popcountll(mask & TINY_BLACK) != __builtin_popcountll(mask & ~TINY_BLACK)) { return 1; }
+
+    if (!ctx->tinyMemo)
+    {
+        ctx->tinyMemo = (tinyMemo_t *) memCalloc(ctx, 1, sizeof(tinyMemo_t));
+        if (!ctx->tinyMemo)
+        {
+            ctx->error = TILING_EXCEED_MEM;
+            return -1;
+        }
+    }
+    tinyMemo_t * memo = ctx->tinyMemo;
+    uint8_t choice[32];
+    int found = cover(mask, memo, choice, 0);
+    while (memo->amountTouched) { memo->failed[memo->touched[--memo->amountTouched]] = 0; }
+    if (!found) { return 1; }
+
+    uint64_t rest = mask;
+    for (unsigned int d = 0; rest; d++)
+    {
+        unsigned int b = (unsigned int) __builtin_ctzll(rest);
+        tile_t * a = &tiles[index[b]];
+        tile_t * c = &tiles[index[b + choice[d]]];
+        a->edge = c;
+        c->edge = a;
+        rest &= ~(((uint64_t) 1 << b) | ((uint64_t) 1 << (b + choice[d])));
+    }
+    return 0;
+}